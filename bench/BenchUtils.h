@@ -0,0 +1,164 @@
+#pragma once
+
+#include <Analysis/PECTuples/interface/Electron.h>
+#include <Analysis/PECTuples/interface/Jet.h>
+#include <Analysis/PECTuples/interface/Muon.h>
+
+#include <chrono>
+#include <random>
+
+
+/**
+ * \class Stopwatch
+ * \brief Measures wall-clock time elapsed since construction or the last restart
+ */
+class Stopwatch
+{
+public:
+    /// Constructor; starts the measurement
+    Stopwatch() noexcept;
+    
+public:
+    /// Restarts the measurement
+    void Restart();
+    
+    /// Returns time elapsed since the start of the measurement, in seconds
+    double Elapsed() const;
+    
+private:
+    /// Moment of the start of the measurement
+    std::chrono::steady_clock::time_point start;
+};
+
+
+/**
+ * \class RandomObjects
+ * \brief Fills PEC objects with random but realistic values
+ * 
+ * The values are only meant to exercise setters and to have a realistic compression ratio when
+ * written to a file.
+ */
+class RandomObjects
+{
+public:
+    /// Constructor with a seed for the random number generator
+    RandomObjects(unsigned long seed = 1);
+    
+public:
+    /// Returns a random number of objects uniformly distributed in [0, max]
+    unsigned Multiplicity(unsigned max);
+    
+    /// Sets all properties of the given jet that are filled by PECJetMET
+    void Fill(pec::Jet &jet);
+    
+    /// Sets all properties of the given electron that are filled by PECElectrons
+    void Fill(pec::Electron &electron);
+    
+    /// Sets all properties of the given muon that are filled by PECMuons
+    void Fill(pec::Muon &muon);
+    
+private:
+    /// Sets four-momentum with a falling pt spectrum
+    void FillP4(pec::Candidate &candidate, float mass);
+    
+private:
+    /// Random number generator
+    std::mt19937 engine;
+    
+    /// Uniform distribution in [0, 1)
+    std::uniform_real_distribution<float> uniform;
+    
+    /// Exponential distribution used to generate pt
+    std::exponential_distribution<float> ptSpectrum;
+};
+
+
+inline Stopwatch::Stopwatch() noexcept:
+    start(std::chrono::steady_clock::now())
+{}
+
+
+inline void Stopwatch::Restart()
+{
+    start = std::chrono::steady_clock::now();
+}
+
+
+inline double Stopwatch::Elapsed() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+inline RandomObjects::RandomObjects(unsigned long seed /*= 1*/):
+    engine(seed),
+    uniform(0.f, 1.f),
+    ptSpectrum(1.f / 40.f)
+{}
+
+
+inline unsigned RandomObjects::Multiplicity(unsigned max)
+{
+    return std::uniform_int_distribution<unsigned>(0, max)(engine);
+}
+
+
+inline void RandomObjects::Fill(pec::Jet &jet)
+{
+    jet.Reset();
+    FillP4(jet, 5.f + 10.f * uniform(engine));
+    
+    jet.SetCorrFactor(0.9f + 0.3f * uniform(engine));
+    jet.SetJECUncertainty(0.01f + 0.03f * uniform(engine));
+    jet.SetJERUncertainty(0.02f * uniform(engine));
+    jet.SetBTag(pec::Jet::BTagAlgo::CMVA, 2.f * uniform(engine) - 1.f);
+    
+    float const bb = 0.1f * uniform(engine), b = 0.5f * uniform(engine);
+    float const c = 0.2f * uniform(engine);
+    jet.SetBTagDNN(bb, b, 0.f, c, 1.f - bb - b - c);
+    
+    jet.SetPileUpID(2.f * uniform(engine) - 1.f);
+    jet.SetArea(0.4f + 0.2f * uniform(engine));
+    jet.SetCharge(uniform(engine) - 0.5f);
+    jet.SetFlavour(0, 21, 0);
+    jet.SetBit(0, uniform(engine) < 0.8f);
+    jet.SetBit(1, uniform(engine) < 0.95f);
+}
+
+
+inline void RandomObjects::Fill(pec::Electron &electron)
+{
+    electron.Reset();
+    FillP4(electron, 0.f);
+    
+    electron.SetCharge((uniform(engine) < 0.5f) ? -1 : 1);
+    electron.SetRelIso(0.3f * uniform(engine));
+    electron.SetEtaSC(electron.Eta() + 0.01f * (uniform(engine) - 0.5f));
+    
+    for (unsigned i = 0; i < 4; ++i)
+        electron.SetBooleanID(i, uniform(engine) < 0.8f);
+    
+    electron.SetBit(0, uniform(engine) < 0.9f);
+}
+
+
+inline void RandomObjects::Fill(pec::Muon &muon)
+{
+    muon.Reset();
+    FillP4(muon, 0.f);
+    
+    muon.SetCharge((uniform(engine) < 0.5f) ? -1 : 1);
+    muon.SetRelIso(0.3f * uniform(engine));
+    
+    for (unsigned i = 0; i < 3; ++i)
+        muon.SetBit(i, uniform(engine) < 0.9f);
+}
+
+
+inline void RandomObjects::FillP4(pec::Candidate &candidate, float mass)
+{
+    candidate.SetPt(20.f + ptSpectrum(engine));
+    candidate.SetEta(5.f * (uniform(engine) - 0.5f));
+    candidate.SetPhi(6.2831853f * (uniform(engine) - 0.5f));
+    candidate.SetM(mass);
+}
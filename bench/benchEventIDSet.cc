@@ -0,0 +1,141 @@
+/**
+ * Measures reading and lookup of large lists of event IDs in EventIDFilter
+ * 
+ * A synthetic list of event IDs is written into a text file in the format accepted by
+ * EventIDFilter. It is then read and looked up in two ways: with the approach used previously in
+ * the plugin (std::getline and a regular expression for each line, a sorted vector with a binary
+ * search), and with EventIDSet. The previous implementation used boost::regex; std::regex is used
+ * here instead to avoid a dependency on Boost. Half of the lookups are for events present in the
+ * list. Usage:
+ *   benchEventIDSet [numEvents [outputDirectory]]
+ */
+
+#include "BenchUtils.h"
+#include "../plugins/EventIDSet.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <regex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+
+using namespace std;
+
+
+/// Event ID as stored in the reference implementation
+using ID = tuple<unsigned long, unsigned long, unsigned long long>;
+
+
+/// Prints a line of the results table
+void PrintResult(string const &label, double readTime, double lookupTime,
+  unsigned long numLookups, unsigned long numFound)
+{
+    cout << " " << setw(30) << left << label << right << fixed << setprecision(2) << setw(10) <<
+      readTime << " s" << setprecision(1) << setw(12) << 1e9 * lookupTime / numLookups <<
+      " ns/lookup   (found " << numFound << ")\n";
+}
+
+
+int main(int argc, char **argv)
+{
+    unsigned long const numEvents = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 10000000;
+    string const outputDirectory((argc > 2) ? argv[2] : "/tmp");
+    string const fileName(outputDirectory + "/benchEventIDSet.txt");
+    
+    
+    // Generate a list of events spread over 1000 runs with 500 luminosity blocks each. Event
+    //numbers are large and sparse, as in real data
+    mt19937_64 engine(1);
+    vector<ID> ids;
+    ids.reserve(numEvents);
+    
+    for (unsigned long i = 0; i < numEvents; ++i)
+        ids.emplace_back(297000 + engine() % 1000, 1 + engine() % 500, engine() % 5000000000ULL);
+    
+    {
+        ofstream file(fileName);
+        
+        for (auto const &id: ids)
+            file << get<0>(id) << ':' << get<1>(id) << ':' << get<2>(id) << '\n';
+    }
+    
+    
+    // Queries: half of them are present in the list, the others are random
+    unsigned long const numLookups = numEvents;
+    vector<ID> queries;
+    queries.reserve(numLookups);
+    
+    for (unsigned long i = 0; i < numLookups; ++i)
+    {
+        if (i % 2 == 0)
+            queries.emplace_back(ids[engine() % ids.size()]);
+        else
+            queries.emplace_back(297000 + engine() % 1000, 1 + engine() % 500,
+              engine() % 5000000000ULL);
+    }
+    
+    cout << "Reading and lookup of " << numEvents << " event IDs from " << fileName << "\n";
+    
+    
+    // Reference implementation
+    Stopwatch stopwatch;
+    vector<ID> knownEvents;
+    
+    {
+        ifstream file(fileName);
+        string line;
+        regex const eventIDRegex("^(\\d+):(\\d+):(\\d+)$");
+        smatch matchResults;
+        
+        while (getline(file, line) and not line.empty())
+        {
+            if (not regex_match(line, matchResults, eventIDRegex))
+            {
+                cerr << "Failed to parse line \"" << line << "\"\n";
+                return EXIT_FAILURE;
+            }
+            
+            knownEvents.emplace_back(stoul(matchResults[1]), stoul(matchResults[2]),
+              stoull(matchResults[3]));
+        }
+        
+        sort(knownEvents.begin(), knownEvents.end());
+    }
+    
+    double const referenceReadTime = stopwatch.Elapsed();
+    unsigned long numFound = 0;
+    stopwatch.Restart();
+    
+    for (auto const &q: queries)
+        numFound += binary_search(knownEvents.begin(), knownEvents.end(), q);
+    
+    PrintResult("regex + sorted vector", referenceReadTime, stopwatch.Elapsed(), numLookups,
+      numFound);
+    
+    
+    // EventIDSet
+    stopwatch.Restart();
+    EventIDSet eventIDSet;
+    eventIDSet.ReadTextFile(fileName);
+    eventIDSet.Build();
+    
+    double const readTime = stopwatch.Elapsed();
+    numFound = 0;
+    stopwatch.Restart();
+    
+    for (auto const &q: queries)
+        numFound += eventIDSet.Contains(get<0>(q), get<1>(q), get<2>(q));
+    
+    PrintResult("EventIDSet", readTime, stopwatch.Elapsed(), numLookups, numFound);
+    
+    
+    remove(fileName.c_str());
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,129 @@
+/**
+ * Measures computation of corrected jet momenta for systematic variations
+ * 
+ * Compares a per-jet loop over pec::Jet objects, as typically written in analyses, with the
+ * computation for all variations at once over a structure of arrays with pec::JetColumns and
+ * pec::JetVariations. In both cases the nominal corrected momenta and the JEC and JER variations
+ * are computed, and MET is recomputed for each variation. Usage:
+ *   benchJetVariations [numEvents]
+ */
+
+#include "BenchUtils.h"
+
+#include <Analysis/PECTuples/interface/JetColumns.h>
+#include <Analysis/PECTuples/interface/JetVariations.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+using namespace std;
+
+
+/// Prints a line of the results table
+void PrintResult(string const &label, double time, unsigned long numEvents, double checksum)
+{
+    cout << " " << setw(24) << left << label << right << setw(10) << fixed << setprecision(1) <<
+      1e9 * time / numEvents << " ns/event   (checksum " << setprecision(3) << checksum << ")\n";
+}
+
+
+int main(int argc, char **argv)
+{
+    unsigned long const numEvents = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 1000000;
+    
+    
+    // Generate a pool of events in memory. It is reused cyclically
+    unsigned const poolSize = 1000;
+    RandomObjects random;
+    vector<vector<pec::Jet>> pool(poolSize);
+    
+    for (auto &jets: pool)
+    {
+        jets.resize(random.Multiplicity(20));
+        
+        for (auto &jet: jets)
+            random.Fill(jet);
+    }
+    
+    pec::Candidate nominalMET;
+    nominalMET.SetPt(50.f);
+    nominalMET.SetPhi(1.f);
+    
+    cout << "Jet systematic variations for " << numEvents << " events\n";
+    
+    
+    // Per-jet computation with accessors of pec::Jet
+    double checksum = 0.;
+    Stopwatch stopwatch;
+    
+    for (unsigned long ev = 0; ev < numEvents; ++ev)
+    {
+        auto const &jets = pool[ev % poolSize];
+        
+        for (int shift = 0; shift < 5; ++shift)
+        {
+            double metX = nominalMET.Pt() * cos(nominalMET.Phi());
+            double metY = nominalMET.Pt() * sin(nominalMET.Phi());
+            
+            for (auto const &j: jets)
+            {
+                float const nominalPt = j.Pt() * j.CorrFactor();
+                float factor = 1.f;
+                
+                if (shift == 1 or shift == 2)
+                    factor += (shift == 1 ? 1 : -1) * j.JECUncertainty();
+                else if (shift == 3 or shift == 4)
+                    factor += (shift == 3 ? 1 : -1) * j.JERUncertainty();
+                
+                float const pt = nominalPt * factor;
+                checksum += pt + j.M() * j.CorrFactor() * factor;
+                
+                if (nominalPt > 15.f)
+                {
+                    metX -= (pt - nominalPt) * cos(j.Phi());
+                    metY -= (pt - nominalPt) * sin(j.Phi());
+                }
+            }
+            
+            checksum += hypot(metX, metY);
+        }
+    }
+    
+    PrintResult("per-jet accessors", stopwatch.Elapsed(), numEvents, checksum);
+    
+    
+    // Structure of arrays and all variations in one pass
+    using Variation = pec::JetVariations::Variation;
+    pec::JetColumns columns;
+    pec::JetVariations variations;
+    checksum = 0.;
+    stopwatch.Restart();
+    
+    for (unsigned long ev = 0; ev < numEvents; ++ev)
+    {
+        columns.Fill(pool[ev % poolSize]);
+        variations.Compute(columns);
+        auto const mets = variations.PropagateToMET(nominalMET, columns.Phi());
+        
+        for (unsigned v = 0; v < pec::JetVariations::numVariations; ++v)
+        {
+            float const *pt = variations.Pt(Variation(v));
+            float const *mass = variations.M(Variation(v));
+            
+            for (unsigned i = 0; i < variations.size(); ++i)
+                checksum += pt[i] + mass[i];
+            
+            checksum += mets[v].Pt();
+        }
+    }
+    
+    PrintResult("JetVariations", stopwatch.Elapsed(), numEvents, checksum);
+    
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,227 @@
+/**
+ * Measures throughput of setters, Reset, and getters of PEC classes
+ * 
+ * Objects are filled in the same way as in the PEC plugins: a single object is reset, filled with
+ * setters, and copied into a vector, which is then read back with getters. Usage:
+ *   benchObjects [numIterations]
+ */
+
+#include "BenchUtils.h"
+
+#include <Analysis/PECTuples/interface/GeneratorInfo.h>
+#include <Analysis/PECTuples/interface/PileUpInfo.h>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+using namespace std;
+
+
+/// Prints a line of the results table
+void PrintResult(string const &label, double time, unsigned long numObjects, double checksum)
+{
+    cout << " " << setw(30) << left << label << right << setw(10) << fixed << setprecision(2) <<
+      1e9 * time / numObjects << " ns/object" << setw(12) << setprecision(1) <<
+      numObjects / time * 1e-6 << " M/s   (checksum " << setprecision(3) << checksum << ")\n";
+}
+
+
+/**
+ * \brief Measures filling and reading of a vector of objects of given type
+ * 
+ * Uses the given RandomObjects to generate a pool of reference objects. Filling copies them into
+ * the output vector via setters, as PEC plugins do, and reading sums values returned by getters.
+ */
+template<typename T, typename Setter, typename Getter>
+void BenchCollection(string const &name, unsigned long numIterations, unsigned collectionSize,
+  RandomObjects &random, Setter setter, Getter getter)
+{
+    vector<T> pool(collectionSize);
+    
+    for (auto &object: pool)
+        random.Fill(object);
+    
+    unsigned long const numObjects = numIterations * collectionSize;
+    vector<T> buffer;
+    T storeObject;
+    double checksum = 0.;
+    
+    
+    // Fill the buffer with setters
+    Stopwatch stopwatch;
+    
+    for (unsigned long it = 0; it < numIterations; ++it)
+    {
+        buffer.clear();
+        
+        for (T const &src: pool)
+        {
+            storeObject.Reset();
+            setter(storeObject, src);
+            buffer.emplace_back(storeObject);
+        }
+        
+        checksum += buffer.back().Pt();
+    }
+    
+    PrintResult(name + " Reset+set+copy", stopwatch.Elapsed(), numObjects, checksum);
+    
+    
+    // Reset only
+    checksum = 0.;
+    stopwatch.Restart();
+    
+    for (unsigned long it = 0; it < numIterations; ++it)
+    {
+        for (T &object: buffer)
+            object.Reset();
+        
+        checksum += buffer.front().Pt();
+    }
+    
+    PrintResult(name + " Reset", stopwatch.Elapsed(), numObjects, checksum);
+    
+    
+    // Read back with getters
+    for (unsigned i = 0; i < collectionSize; ++i)
+        setter(buffer[i], pool[i]);
+    
+    checksum = 0.;
+    stopwatch.Restart();
+    
+    for (unsigned long it = 0; it < numIterations; ++it)
+    {
+        for (T const &object: buffer)
+            checksum += getter(object);
+    }
+    
+    PrintResult(name + " get", stopwatch.Elapsed(), numObjects, checksum);
+}
+
+
+int main(int argc, char **argv)
+{
+    unsigned long const numIterations = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 1000000;
+    RandomObjects random;
+    
+    cout << "Throughput of PEC classes, " << numIterations << " iterations\n";
+    
+    
+    // Jets are processed in collections of realistic size
+    BenchCollection<pec::Jet>("Jet", numIterations, 10, random,
+      [](pec::Jet &j, pec::Jet const &src)
+      {
+          j.SetPt(src.Pt());
+          j.SetEta(src.Eta());
+          j.SetPhi(src.Phi());
+          j.SetM(src.M());
+          j.SetCorrFactor(src.CorrFactor());
+          j.SetJECUncertainty(src.JECUncertainty());
+          j.SetJERUncertainty(src.JERUncertainty());
+          j.SetBTag(pec::Jet::BTagAlgo::CMVA, src.BTag(pec::Jet::BTagAlgo::CMVA));
+          
+          using Type = pec::Jet::BTagDNNType;
+          j.SetBTagDNN(src.BTagDNN(Type::BB), src.BTagDNN(Type::B), src.BTagDNN(Type::CC),
+            src.BTagDNN(Type::C), src.BTagDNN(Type::UDSG));
+          
+          j.SetPileUpID(src.PileUpID());
+          j.SetArea(src.Area());
+          j.SetCharge(src.Charge());
+          j.SetFlavour(src.Flavour(pec::Jet::FlavourType::Hadron),
+            src.Flavour(pec::Jet::FlavourType::Parton), src.Flavour(pec::Jet::FlavourType::ME));
+          j.SetBit(0, src.TestBit(0));
+          j.SetBit(1, src.TestBit(1));
+      },
+      [](pec::Jet const &j)
+      {
+          return j.Pt() * j.CorrFactor() + j.Eta() + j.Phi() + j.M() + j.JECUncertainty() +
+            j.BTagDNN(pec::Jet::BTagDNNType::B) + j.PileUpID() + j.Flavour() + j.TestBit(1);
+      });
+    
+    BenchCollection<pec::Electron>("Electron", numIterations, 2, random,
+      [](pec::Electron &e, pec::Electron const &src)
+      {
+          e.SetPt(src.Pt());
+          e.SetEta(src.Eta());
+          e.SetPhi(src.Phi());
+          e.SetCharge(src.Charge());
+          e.SetRelIso(src.RelIso());
+          e.SetEtaSC(src.EtaSC());
+          
+          for (unsigned i = 0; i < 4; ++i)
+              e.SetBooleanID(i, src.BooleanID(i));
+          
+          e.SetBit(0, src.TestBit(0));
+      },
+      [](pec::Electron const &e)
+      {
+          return e.Pt() + e.Eta() + e.Phi() + e.Charge() + e.RelIso() + e.EtaSC() +
+            e.BooleanID(3);
+      });
+    
+    BenchCollection<pec::Muon>("Muon", numIterations, 2, random,
+      [](pec::Muon &m, pec::Muon const &src)
+      {
+          m.SetPt(src.Pt());
+          m.SetEta(src.Eta());
+          m.SetPhi(src.Phi());
+          m.SetCharge(src.Charge());
+          m.SetRelIso(src.RelIso());
+          
+          for (unsigned i = 0; i < 3; ++i)
+              m.SetBit(i, src.TestBit(i));
+      },
+      [](pec::Muon const &m)
+      {
+          return m.Pt() + m.Eta() + m.Phi() + m.Charge() + m.RelIso() + m.TestBit(2);
+      });
+    
+    
+    // Per-event objects
+    pec::GeneratorInfo generatorInfo;
+    double checksum = 0.;
+    Stopwatch stopwatch;
+    
+    for (unsigned long it = 0; it < numIterations; ++it)
+    {
+        generatorInfo.Reset();
+        generatorInfo.SetProcessId(it % 100);
+        generatorInfo.SetNominalWeight(1.f + 1e-6f * it);
+        generatorInfo.SetPdfXs(0.01f, 0.1f);
+        generatorInfo.SetPdfIds(21, 2);
+        generatorInfo.SetPdfQScale(172.5f);
+        
+        checksum += generatorInfo.NominalWeight() * generatorInfo.PdfX(1) +
+          generatorInfo.PdfId(0) + generatorInfo.PdfQScale();
+    }
+    
+    PrintResult("GeneratorInfo Reset+set+get", stopwatch.Elapsed(), numIterations, checksum);
+    
+    
+    pec::PileUpInfo pileUpInfo;
+    checksum = 0.;
+    stopwatch.Restart();
+    
+    for (unsigned long it = 0; it < numIterations; ++it)
+    {
+        pileUpInfo.Reset();
+        pileUpInfo.SetNumPV(it % 60);
+        pileUpInfo.SetRho(20.f + 1e-6f * it);
+        pileUpInfo.SetRhoCentral(18.f);
+        pileUpInfo.SetTrueNumPU(30.5f);
+        pileUpInfo.SetInTimePU(it % 50);
+        pileUpInfo.SetMaxPtHat(15.f);
+        
+        checksum += pileUpInfo.NumPV() + pileUpInfo.Rho() + pileUpInfo.TrueNumPU() +
+          pileUpInfo.InTimePU();
+    }
+    
+    PrintResult("PileUpInfo Reset+set+get", stopwatch.Elapsed(), numIterations, checksum);
+    
+    
+    return EXIT_SUCCESS;
+}
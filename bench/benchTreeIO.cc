@@ -0,0 +1,185 @@
+/**
+ * Measures write and read throughput of trees with collections of PEC objects
+ * 
+ * Events with realistic multiplicities (0-20 jets, 0-4 electrons and muons) are generated in
+ * memory and written into a tree with branches of type std::vector<pec::Jet>, etc. The
+ * measurement is repeated for several split levels and compression settings. For each
+ * configuration the time to write and to read back the tree and the size of the file are
+ * reported. Usage:
+ *   benchTreeIO [numEvents [outputDirectory]]
+ */
+
+#include "BenchUtils.h"
+
+#include <TFile.h>
+#include <TTree.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+using namespace std;
+
+
+/// Content of a single event
+struct Event
+{
+    vector<pec::Jet> jets;
+    vector<pec::Electron> electrons;
+    vector<pec::Muon> muons;
+};
+
+
+/// Results of the measurement for a single configuration
+struct Result
+{
+    /// Time to fill the tree and write the file, s
+    double writeTime;
+    
+    /// Time to read all entries, s
+    double readTime;
+    
+    /// Uncompressed and compressed size of the tree, bytes
+    double totBytes, zipBytes;
+    
+    /// Sum of jet pt computed when reading, to make sure that objects are actually read
+    double checksum;
+};
+
+
+/// Writes given events into a file with the given settings
+void WriteEvents(vector<Event> const &events, string const &fileName, int splitLevel,
+  int compression, Result &result)
+{
+    Stopwatch stopwatch;
+    
+    TFile file(fileName.c_str(), "recreate", "", compression);
+    TTree *tree = new TTree("Events", "Benchmark tree");
+    //^ The tree is owned by the file
+    
+    vector<pec::Jet> jets, *jetsPointer = &jets;
+    vector<pec::Electron> electrons, *electronsPointer = &electrons;
+    vector<pec::Muon> muons, *muonsPointer = &muons;
+    
+    tree->Branch("jets", &jetsPointer, 32000, splitLevel);
+    tree->Branch("electrons", &electronsPointer, 32000, splitLevel);
+    tree->Branch("muons", &muonsPointer, 32000, splitLevel);
+    
+    for (Event const &event: events)
+    {
+        jets = event.jets;
+        electrons = event.electrons;
+        muons = event.muons;
+        tree->Fill();
+    }
+    
+    file.Write();
+    result.totBytes = tree->GetTotBytes();
+    result.zipBytes = tree->GetZipBytes();
+    file.Close();
+    
+    result.writeTime = stopwatch.Elapsed();
+}
+
+
+/// Reads back all entries of a file written by WriteEvents
+void ReadEvents(string const &fileName, Result &result)
+{
+    Stopwatch stopwatch;
+    
+    TFile file(fileName.c_str());
+    TTree *tree = dynamic_cast<TTree *>(file.Get("Events"));
+    
+    vector<pec::Jet> *jetsPointer = nullptr;
+    vector<pec::Electron> *electronsPointer = nullptr;
+    vector<pec::Muon> *muonsPointer = nullptr;
+    
+    tree->SetBranchAddress("jets", &jetsPointer);
+    tree->SetBranchAddress("electrons", &electronsPointer);
+    tree->SetBranchAddress("muons", &muonsPointer);
+    
+    double checksum = 0.;
+    long long const numEntries = tree->GetEntries();
+    
+    for (long long entry = 0; entry < numEntries; ++entry)
+    {
+        tree->GetEntry(entry);
+        
+        for (auto const &jet: *jetsPointer)
+            checksum += jet.Pt();
+        
+        checksum += electronsPointer->size() + muonsPointer->size();
+    }
+    
+    result.readTime = stopwatch.Elapsed();
+    result.checksum = checksum;
+    
+    delete jetsPointer;
+    delete electronsPointer;
+    delete muonsPointer;
+}
+
+
+int main(int argc, char **argv)
+{
+    unsigned long const numEvents = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 100000;
+    string const outputDirectory((argc > 2) ? argv[2] : ".");
+    
+    
+    // Generate events in memory so that generation does not affect the measurement
+    RandomObjects random;
+    vector<Event> events(numEvents);
+    
+    for (Event &event: events)
+    {
+        event.jets.resize(random.Multiplicity(20));
+        event.electrons.resize(random.Multiplicity(4));
+        event.muons.resize(random.Multiplicity(4));
+        
+        for (auto &jet: event.jets)
+            random.Fill(jet);
+        
+        for (auto &electron: event.electrons)
+            random.Fill(electron);
+        
+        for (auto &muon: event.muons)
+            random.Fill(muon);
+    }
+    
+    
+    // Compression settings are given as 100 * algorithm + level. Algorithms are 1 for ZLIB, 2 for
+    //LZMA, 4 for LZ4, and 5 for ZSTD (needs ROOT 6.20 or newer)
+    vector<int> const splitLevels{0, 1, 99};
+    vector<int> const compressionSettings{0, 101, 404, 207, 505};
+    
+    cout << "Tree i/o throughput for " << numEvents << " events\n";
+    cout << setw(7) << "split" << setw(13) << "compression" << setw(12) << "write, s" <<
+      setw(14) << "write, ev/s" << setw(12) << "read, s" << setw(14) << "read, ev/s" <<
+      setw(12) << "size, MB" << setw(9) << "ratio" << '\n';
+    
+    for (int const splitLevel: splitLevels)
+        for (int const compression: compressionSettings)
+        {
+            string const fileName(outputDirectory + "/benchTreeIO_split" +
+              to_string(splitLevel) + "_comp" + to_string(compression) + ".root");
+            Result result;
+            
+            WriteEvents(events, fileName, splitLevel, compression, result);
+            ReadEvents(fileName, result);
+            remove(fileName.c_str());
+            
+            cout << setw(7) << splitLevel << setw(13) << compression << fixed <<
+              setprecision(3) << setw(12) << result.writeTime << setw(14) << setprecision(0) <<
+              numEvents / result.writeTime << setprecision(3) << setw(12) << result.readTime <<
+              setw(14) << setprecision(0) << numEvents / result.readTime << setprecision(2) <<
+              setw(12) << result.zipBytes / (1 << 20) << setw(9) <<
+              result.totBytes / result.zipBytes << '\n';
+        }
+    
+    
+    return EXIT_SUCCESS;
+}
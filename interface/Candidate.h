@@ -9,7 +9,20 @@ namespace pec
  * \class Candidate
  * \brief Stores four-momentum
  * 
- * Components of the four-momentum are compressed using minifloat functions.
+ * Floating-point members of this class and its descendants are stored in ROOT files with a reduced
+ * precision, which is declared for each member with ROOT type Float16_t and a comment in the form
+ * "//[xmin, xmax, nbits]" following the declaration. If xmin and xmax are both zero, the value is
+ * stored as a float with the mantissa truncated to nbits bits, which preserves the relative
+ * precision. Otherwise it is packed into an nbits-bit integer within the given range, and values
+ * outside of it are clamped. The precision is applied by the ROOT streamer when the object is
+ * written, so values in memory are not affected before a write-read cycle.
+ * 
+ * This class and its descendants have no virtual methods and are trivially copyable, which is
+ * checked at compile time. ROOT can therefore stream collections of them without handling
+ * polymorphism, and vectors of them are copied in bulk. Method Reset is not virtual. Each derived
+ * class defines its own version, which calls Reset of its base class, so an object must not be
+ * reset through a pointer or reference to a base class. Versions for ROOT i/o are set explicitly
+ * with ClassDefNV and must be incremented whenever the data members change.
  */
 class Candidate
 {
@@ -30,12 +43,9 @@ public:
     /// Default assignment operator
     Candidate &operator=(Candidate const &) = default;
     
-    /// Default virtual destructor
-    virtual ~Candidate() = default;
-    
 public:
     /// Resets the object to a state right after the default initialisation
-    virtual void Reset();
+    void Reset();
     
     /// Sets transverse momentum (GeV/c)
     void SetPt(float pt);
@@ -71,15 +81,18 @@ public:
     
 private:
     /// Transverse momentum, GeV/c
-    Float_t pt;
+    Float16_t pt;  //[0, 0, 12]
     
     /// Pseudorapidity
-    Float_t eta;
+    Float16_t eta;  //[0, 0, 14]
     
     /// Azimuthal angle, [-pi, pi)
-    Float_t phi;
+    Float16_t phi;  //[-pi, pi, 16]
     
     /// Mass, GeV/c^2
-    Float_t mass;
+    Float16_t mass;  //[0, 0, 12]
+    
+    /// Version of the class for ROOT i/o
+    ClassDefNV(Candidate, 2)
 };
 }  // end of namespace pec
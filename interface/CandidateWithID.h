@@ -20,7 +20,7 @@ public:
     
 public:
     /// Resets the object to a state right after the default initialisation
-    virtual void Reset() override;
+    void Reset();
     
     /**
      * \brief Sets or unsets an ID bit
@@ -39,5 +39,8 @@ public:
 private:
     /// Variable to hold ID flags
     UChar_t id;
+    
+    /// Version of the class for ROOT i/o
+    ClassDefNV(CandidateWithID, 2)
 };
 }  // end of namespace pec
@@ -22,7 +22,7 @@ public:
     
 public:
     /// Resets the object to a state right after the default initialisation
-    virtual void Reset() override;
+    void Reset();
     
     /**
      * \brief Sets a decision of a cut-based ID
@@ -62,7 +62,7 @@ public:
 private:
     
     /// Pseudorapidity of the associated supercluster
-    Float_t etaSC;
+    Float16_t etaSC;  //[0, 0, 14]
     
     /**
      * \brief Encodes flags for boolean ID decisions
@@ -80,6 +80,9 @@ private:
      * 
      * See documentation for the SetContinuousId method.
      */
-    Float_t mvaId[contIdSize];
+    Float16_t mvaId[contIdSize];  //[0, 0, 14]
+    
+    /// Version of the class for ROOT i/o
+    ClassDefNV(Electron, 2)
 };
 }  // end of namespace pec
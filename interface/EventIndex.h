@@ -0,0 +1,164 @@
+#pragma once
+
+#include <TFile.h>
+#include <TTree.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+
+namespace pec
+{
+/**
+ * \class EventIndex
+ * \brief Finds entries of given events in a PEC file
+ * 
+ * Reads the tree "EventIndex" written by plugin PECEventID (or rebuilt by script eventIndex.py
+ * after merging) and keeps it in memory as a sorted array, which takes 24 bytes per event. Entries
+ * of individual events are then found with a binary search. The class is header-only and can be
+ * used from PyROOT in the same way as pec::TupleReader. Usage:
+ * 
+ *   TFile file("pec.root");
+ *   pec::EventIndex index(file);
+ *   long long const entry = index.Find(1, 2, 3);
+ */
+class EventIndex
+{
+public:
+    /**
+     * \brief Constructor from a file
+     * 
+     * Throws an exception if the file does not contain the index or if the index is stale (see
+     * Read).
+     */
+    EventIndex(TFile &file, std::string const &treeName = "pecEventID/EventIndex");
+    
+    /**
+     * \brief Constructor from a tree with the index
+     * 
+     * Throws an exception if the index is stale (see Read).
+     */
+    EventIndex(TTree *tree);
+    
+public:
+    /**
+     * \brief Returns the number of entry for the given event
+     * 
+     * Returns -1 if the event is not found.
+     */
+    long long Find(unsigned long run, unsigned long lumi, unsigned long long event) const;
+    
+    /// Returns the number of indexed events
+    std::size_t size() const;
+    
+private:
+    /// Event ID and the number of the corresponding entry
+    struct Record
+    {
+        UInt_t run, lumi;
+        ULong64_t event;
+        Long64_t entry;
+        
+        /// Comparison by event ID
+        bool operator<(Record const &other) const
+        {
+            return std::tie(run, lumi, event) < std::tie(other.run, other.lumi, other.event);
+        }
+    };
+    
+private:
+    /**
+     * \brief Reads the index from the given tree
+     * 
+     * Checks that entry numbers in the index are a permutation of [0, N), where N is the number
+     * of records, and throws an exception otherwise. This is not the case for an index that has
+     * been merged with hadd without rebuilding, since entry numbers in it are repeated. Comparing
+     * N with the number of entries in the tree with event ID does not detect this.
+     */
+    void Read(TTree *tree);
+    
+private:
+    /// Records sorted by event ID
+    std::vector<Record> records;
+};
+
+
+inline EventIndex::EventIndex(TFile &file, std::string const &treeName)
+{
+    TTree *tree = dynamic_cast<TTree *>(file.Get(treeName.c_str()));
+    
+    if (not tree)
+        throw std::runtime_error("pec::EventIndex::EventIndex: File \"" +
+          std::string(file.GetName()) + "\" does not contain tree \"" + treeName + "\".");
+    
+    Read(tree);
+}
+
+
+inline EventIndex::EventIndex(TTree *tree)
+{
+    Read(tree);
+}
+
+
+inline long long EventIndex::Find(unsigned long run, unsigned long lumi,
+  unsigned long long event) const
+{
+    Record const key{UInt_t(run), UInt_t(lumi), event, -1};
+    auto const res = std::lower_bound(records.begin(), records.end(), key);
+    
+    if (res == records.end() or key < *res)
+        return -1;
+    else
+        return res->entry;
+}
+
+
+inline std::size_t EventIndex::size() const
+{
+    return records.size();
+}
+
+
+inline void EventIndex::Read(TTree *tree)
+{
+    Record record;
+    tree->SetBranchAddress("run", &record.run);
+    tree->SetBranchAddress("lumi", &record.lumi);
+    tree->SetBranchAddress("event", &record.event);
+    tree->SetBranchAddress("entry", &record.entry);
+    
+    long long const numEntries = tree->GetEntries();
+    records.reserve(numEntries);
+    
+    for (long long i = 0; i < numEntries; ++i)
+    {
+        tree->GetEntry(i);
+        records.emplace_back(record);
+    }
+    
+    tree->ResetBranchAddresses();
+    
+    // The index is normally written sorted, but this is not guaranteed if it has been produced by
+    //other means
+    if (not std::is_sorted(records.begin(), records.end()))
+        std::sort(records.begin(), records.end());
+    
+    
+    // Make sure that every entry is referenced exactly once
+    std::vector<bool> seen(numEntries, false);
+    
+    for (auto const &r: records)
+    {
+        if (r.entry < 0 or r.entry >= numEntries or seen[r.entry])
+            throw std::runtime_error("pec::EventIndex::Read: Index in tree \"" +
+              std::string(tree->GetName()) + "\" is stale, probably because files have been "
+              "merged. Rebuild the index with script eventIndex.py.");
+        
+        seen[r.entry] = true;
+    }
+}
+}  // end of namespace pec
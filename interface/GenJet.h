@@ -20,7 +20,7 @@ public:
     
 public:
     /// Resets the object to a state right after the default initialisation
-    virtual void Reset() override;
+    void Reset();
     
     /**
      * \brief Sets multiplicity of B hadrons
@@ -49,5 +49,8 @@ private:
      * Constructed as the number of B hadrons multiplied by 16 plus number of C hadrons.
      */
     UChar_t bcMult;
+    
+    /// Version of the class for ROOT i/o
+    ClassDefNV(GenJet, 2)
 };
 }  // end of namespace pec
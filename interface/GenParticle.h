@@ -20,7 +20,7 @@ public:
     
 public:
     /// Resets the object to a state right after the default initialisation
-    virtual void Reset() override;
+    void Reset();
     
     /// Sets PDG ID
     void SetPdgId(int pdgId);
@@ -76,5 +76,8 @@ private:
      * particle has more that one mother.
      */
     UChar_t firstMotherIndex, lastMotherIndex;
+    
+    /// Version of the class for ROOT i/o
+    ClassDefNV(GenParticle, 2)
 };
 }  // end of namespace pec
@@ -10,6 +10,9 @@ namespace pec
 /**
  * \class GeneratorInfo
  * \brief Aggregates basic generator-level information
+ * 
+ * The version for ROOT i/o is set with ClassDefNV and must be incremented whenever the data
+ * members change.
  */
 class GeneratorInfo
 {
@@ -43,6 +46,16 @@ public:
     /// Adds an alternative PS event weight to the end of the collection
     void AddAltPsWeight(float weight);
     
+    /**
+     * \brief Returns modifiable collection of alternative LHE weights
+     * 
+     * Allows to add many weights at once instead of calling AddAltLheWeight for each of them.
+     */
+    std::vector<Float_t> &MutableAltLheWeights();
+    
+    /// Returns modifiable collection of alternative PS weights. See MutableAltLheWeights
+    std::vector<Float_t> &MutableAltPsWeights();
+    
     /**
      * \brief Sets momentum fraction carried by an initial parton
      * 
@@ -114,7 +127,11 @@ private:
     /// Process ID as was set during generation of the sample
     Short_t processId;
     
-    /// Nominal generator-level weight
+    /**
+     * \brief Nominal generator-level weight
+     * 
+     * Stored with full precision since weights are summed over many events.
+     */
     Float_t nominalWeight;
     
     /// Alternative LHE weights
@@ -124,7 +141,7 @@ private:
     std::vector<Float_t> altPsWeights;
     
     /// Momenta fractions carried by initial-state partons
-    Float_t pdfX[2];
+    Float16_t pdfX[2];  //[0, 0, 14]
     
     /**
      * \brief ID of initial-state partons
@@ -135,6 +152,9 @@ private:
     UChar_t pdfId;
     
     /// Energy scale to evaluate PDF, GeV
-    Float_t pdfQScale;
+    Float16_t pdfQScale;  //[0, 0, 12]
+    
+    /// Version of the class for ROOT i/o
+    ClassDefNV(GeneratorInfo, 2)
 };
 }  // end of namespace pec
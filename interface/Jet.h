@@ -65,7 +65,7 @@ public:
     
 public:
     /// Resets the object to a state right after the default initialisation
-    virtual void Reset();
+    void Reset();
     
     /// Sets full jet energy correction factor
     void SetCorrFactor(float jecFactor);
@@ -190,55 +190,62 @@ private:
      * 
      * Set to zero if only raw momentum is stored.
      */
-    Float_t corrFactor;
+    Float16_t corrFactor;  //[0, 0, 14]
     
     /**
      * \brief Relative uncertainty of JEC factor
      * 
      * Set to zero if only raw momentum is stored.
      */
-    Float_t jecUncertainty;
+    Float16_t jecUncertainty;  //[0, 0, 10]
     
     /**
      * \brief Relative uncertainty of JER smearing factor
      * 
      * Set to zero if only raw momentum is stored.
      */
-    Float_t jerUncertainty;
+    Float16_t jerUncertainty;  //[0, 0, 10]
     
-    /// Values of b-tagging  and c-tagging discriminators
-    Float_t bTags[2], cTags[2];
+    /**
+     * \brief Values of b-tagging  and c-tagging discriminators
+     * 
+     * Stored with a truncated mantissa rather than within a range since some algorithms use large
+     * negative values to flag jets that cannot be tagged.
+     */
+    Float16_t bTags[2];  //[0, 0, 14]
+    Float16_t cTags[2];  //[0, 0, 14]
     
     /**
      * \brief Values of DNN b-tagging discriminators
      * 
      * Only values of the first four discriminators in the enumeration BTagDNNTypes are stored. The
-     * last discriminator can be computed knowing that their sum is unity.
+     * last discriminator can be computed knowing that their sum is unity. All values are either
+     * probabilities or (-1) if the discriminators cannot be evaluated.
      */
-    Float_t bTagsDNN[4];
+    Float16_t bTagsDNN[4];  //[-1, 1, 16]
     
     /// Value of an MVA discriminator against pile-up
-    Float_t pileUpMVA;
+    Float16_t pileUpMVA;  //[-1, 1, 16]
     
-    /// Value of quark-gluon discriminator
-    Float_t qgTag;
+    /// Value of quark-gluon discriminator, (-1) if not evaluated
+    Float16_t qgTag;  //[-1, 1, 16]
     
     /// Jet area
-    Float_t area;
+    Float16_t area;  //[0, 0, 10]
     
     /**
      * \brief Electric charge of the jet
      * 
      * See documentation for the method Charge.
      */
-    Float_t charge;
+    Float16_t charge;  //[0, 0, 12]
     
     /**
      * \brief Jet pull angle, [-pi, pi)
      * 
      * See documentation for the method PullAngle.
      */
-    Float_t pullAngle;
+    Float16_t pullAngle;  //[-pi, pi, 16]
     
     /**
      * \brief Jet flavours according to multiple definitions, which are encoded in a 16-bit number
@@ -249,5 +256,8 @@ private:
      * parton, and ME parton flavour. They are described in enumeration FlavourType.
      */
     UShort_t flavours;
+    
+    /// Version of the class for ROOT i/o
+    ClassDefNV(Jet, 2)
 };
 }  // end of namespace pec
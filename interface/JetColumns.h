@@ -0,0 +1,175 @@
+#pragma once
+
+#include <Analysis/PECTuples/interface/Jet.h>
+
+#include <array>
+#include <vector>
+
+
+namespace pec
+{
+/**
+ * \class CandidateColumns
+ * \brief Four-momenta of a collection of candidates stored as a structure of arrays
+ * 
+ * The collection is filled at once, and then properties of all candidates are accessed via
+ * contiguous arrays. This allows to process the collection in loops that the compiler can
+ * vectorize. Storage is reused when the object is filled again, so a single object should be kept
+ * for the whole event loop.
+ */
+class CandidateColumns
+{
+public:
+    /**
+     * \brief Fills the arrays from a collection of pec::Candidate or derived objects
+     * 
+     * Previous content is discarded.
+     */
+    template<typename T>
+    void Fill(std::vector<T> const &candidates);
+    
+    /**
+     * \brief Fills the arrays with the help of a reader that provides indexed access
+     * 
+     * The reader must provide methods size, Pt, Eta, Phi, and M that take the index of a
+     * candidate. This is the case for readers defined in TupleReader.h.
+     */
+    template<typename Reader>
+    void FillFrom(Reader &reader);
+    
+    /// Returns the number of candidates
+    unsigned size() const;
+    
+    /// Returns transverse momenta (GeV/c)
+    float const *Pt() const;
+    
+    /// Returns pseudorapidities
+    float const *Eta() const;
+    
+    /// Returns azimuthal angles
+    float const *Phi() const;
+    
+    /// Returns masses (GeV/c^2)
+    float const *M() const;
+    
+protected:
+    /// Changes the size of all arrays
+    void Resize(unsigned size);
+    
+protected:
+    /// Properties of candidates
+    std::vector<float> pt, eta, phi, mass;
+};
+
+
+/**
+ * \class JetColumns
+ * \brief Properties of a collection of jets stored as a structure of arrays
+ * 
+ * Besides four-momenta, contains corrections and their uncertainties, DNN b-tagging
+ * discriminators, and flavours. As in pec::Jet, four-momenta are uncorrected.
+ */
+class JetColumns: public CandidateColumns
+{
+public:
+    /// Fills the arrays from a collection of jets. Previous content is discarded
+    void Fill(std::vector<Jet> const &jets);
+    
+    /**
+     * \brief Fills the arrays with the help of a reader that provides indexed access
+     * 
+     * The reader must provide the same accessors as pec::Jet that take the index of a jet as the
+     * first argument, as pec::JetReader does.
+     */
+    template<typename Reader>
+    void FillFrom(Reader &reader);
+    
+    /// Returns full jet energy correction factors
+    float const *CorrFactor() const;
+    
+    /// Returns relative uncertainties of the JEC factors
+    float const *JECUncertainty() const;
+    
+    /// Returns relative uncertainties of the JER smearing factors
+    float const *JERUncertainty() const;
+    
+    /**
+     * \brief Returns stored DNN b-tagging discriminators
+     * 
+     * Each element contains discriminators BB, B, CC, and C in the order of enumeration
+     * Jet::BTagDNNType.
+     */
+    std::array<float, 4> const *BTagsDNN() const;
+    
+    /// Returns jet flavours according to the given definition
+    int const *Flavour(Jet::FlavourType type = Jet::FlavourType::Hadron) const;
+    
+private:
+    /// Changes the size of all arrays
+    void Resize(unsigned size);
+    
+private:
+    /// Jet energy corrections and their uncertainties
+    std::vector<float> corrFactor, jecUncertainty, jerUncertainty;
+    
+    /// DNN b-tagging discriminators
+    std::vector<std::array<float, 4>> bTagsDNN;
+    
+    /// Flavours of jets for all definitions in enumeration Jet::FlavourType
+    std::array<std::vector<int>, 3> flavours;
+};
+
+
+template<typename T>
+void CandidateColumns::Fill(std::vector<T> const &candidates)
+{
+    CandidateColumns::Resize(candidates.size());
+    
+    for (unsigned i = 0; i < candidates.size(); ++i)
+    {
+        auto const &c = candidates[i];
+        pt[i] = c.Pt();
+        eta[i] = c.Eta();
+        phi[i] = c.Phi();
+        mass[i] = c.M();
+    }
+}
+
+
+template<typename Reader>
+void CandidateColumns::FillFrom(Reader &reader)
+{
+    unsigned const size = reader.size();
+    CandidateColumns::Resize(size);
+    
+    for (unsigned i = 0; i < size; ++i)
+    {
+        pt[i] = reader.Pt(i);
+        eta[i] = reader.Eta(i);
+        phi[i] = reader.Phi(i);
+        mass[i] = reader.M(i);
+    }
+}
+
+
+template<typename Reader>
+void JetColumns::FillFrom(Reader &reader)
+{
+    CandidateColumns::FillFrom(reader);
+    unsigned const size = this->size();
+    Resize(size);
+    
+    for (unsigned i = 0; i < size; ++i)
+    {
+        corrFactor[i] = reader.CorrFactor(i);
+        jecUncertainty[i] = reader.JECUncertainty(i);
+        jerUncertainty[i] = reader.JERUncertainty(i);
+        
+        for (unsigned k = 0; k < 4; ++k)
+            bTagsDNN[i][k] = reader.BTagDNN(i, Jet::BTagDNNType(k));
+        
+        for (unsigned k = 0; k < 3; ++k)
+            flavours[k][i] = reader.Flavour(i, Jet::FlavourType(k));
+    }
+}
+}  // end of namespace pec
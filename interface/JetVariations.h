@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Analysis/PECTuples/interface/Candidate.h>
+#include <Analysis/PECTuples/interface/JetColumns.h>
+
+#include <array>
+#include <vector>
+
+
+namespace pec
+{
+/**
+ * \class JetVariations
+ * \brief Computes corrected jet momenta for the nominal configuration and JEC and JER variations
+ * 
+ * For each jet the corrected transverse momentum and mass are computed as in the documentation of
+ * pec::Jet: the raw values are multiplied by CorrFactor() * (1 +/- JECUncertainty()) for JEC
+ * variations and by CorrFactor() * (1 +/- JERUncertainty()) for JER variations. The stored JER
+ * uncertainty carries a sign: it is negative if the "up" variation of JER reduces the smearing
+ * (see plugin PECJetMET). The sign is kept, so that the "up" variation here reproduces the "up"
+ * variation of the JER factor rather than the larger of the two momenta.
+ * 
+ * All variations are computed for a whole collection in a single loop over structure-of-arrays
+ * input, which the compiler vectorizes. Results are available as contiguous arrays. Storage is
+ * reused when the object is filled again, so a single object should be kept for the whole event
+ * loop. If only raw momenta have been stored (CorrFactor() is zero), all computed momenta are
+ * zero, and corrections must be applied by the user.
+ */
+class JetVariations
+{
+public:
+    /// Supported variations
+    enum class Variation: unsigned
+    {
+        Nominal = 0,
+        JECUp = 1,
+        JECDown = 2,
+        JERUp = 3,
+        JERDown = 4
+    };
+    
+    /// Number of supported variations
+    static unsigned const numVariations = 5;
+    
+public:
+    /// Computes corrected momenta for the given collection of jets
+    void Compute(JetColumns const &jets);
+    
+    /**
+     * \brief Computes corrected momenta for the given arrays of properties of jets
+     * 
+     * All arrays must contain at least the given number of elements.
+     */
+    void Compute(unsigned size, float const *rawPt, float const *rawMass,
+      float const *corrFactor, float const *jecUncertainty, float const *jerUncertainty);
+    
+    /// Returns the number of jets in the last computation
+    unsigned size() const;
+    
+    /// Returns corrected transverse momenta (GeV/c) for the given variation
+    float const *Pt(Variation variation = Variation::Nominal) const;
+    
+    /// Returns corrected masses (GeV/c^2) for the given variation
+    float const *M(Variation variation = Variation::Nominal) const;
+    
+    /**
+     * \brief Propagates variations of jet momenta into MET
+     * 
+     * Returns MET for all variations, indexed according to enumeration Variation. The nominal MET
+     * must be corrected with the nominal jets, which is the case for the fully corrected MET saved
+     * by PECJetMET. Changes of transverse momenta of jets with respect to the nominal
+     * configuration are subtracted from it. Only jets whose nominal corrected transverse momentum
+     * is larger than the given threshold contribute, in accordance with the T1 MET correction.
+     * Azimuthal angles of jets must be given in the same order as for the last computation. All
+     * variations are computed in a single loop over jets. Returned candidates have zero
+     * pseudorapidity and mass, except for the nominal one, which is a copy of the given MET.
+     */
+    std::array<Candidate, numVariations> PropagateToMET(Candidate const &nominalMET,
+      float const *phi, float minPt = 15.f) const;
+    
+private:
+    /// Corrected transverse momenta and masses for all variations
+    std::array<std::vector<float>, numVariations> pt, mass;
+};
+}  // end of namespace pec
@@ -17,7 +17,7 @@ public:
     
 public:
     /// Resets the object to a state right after the default initialisation
-    virtual void Reset() override;
+    void Reset();
     
     /**
      * \brief Sets lepton charge
@@ -48,6 +48,9 @@ private:
     Bool_t charge;
     
     /// Relative isolation
-    Float_t relIso;
+    Float16_t relIso;  //[0, 0, 12]
+    
+    /// Version of the class for ROOT i/o
+    ClassDefNV(Lepton, 2)
 };
 }  // end of namespace pec
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <TFile.h>
+#include <TTree.h>
+
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace pec
+{
+/**
+ * \class LumiBlocks
+ * \brief Converts a selection of luminosity blocks into ranges of entries in a PEC file
+ * 
+ * Reads the tree "LumiBlocks" written by plugin PECEventID (or rebuilt by script eventIndex.py
+ * after merging). It describes contiguous ranges of entries that belong to the same luminosity
+ * block, so a luminosity mask can be applied without reading event IDs. Only events that have
+ * been written to the file are described, i.e. events rejected by the selection are not counted,
+ * and luminosity blocks without selected events are missing. The class is header-only
+ * and can be used from PyROOT in the same way as pec::TupleReader. Usage:
+ * 
+ *   TFile file("pec.root");
+ *   pec::TupleReader reader(file);
+ *   pec::LumiBlocks lumiBlocks(file);
+ *   auto const ranges = lumiBlocks.SelectEntries([](unsigned long run, unsigned long lumi)
+ *     {return run == 297050 and lumi <= 100;});
+ * 
+ *   for (auto const &range: ranges)
+ *       for (long long entry = range.first; entry < range.second; ++entry)
+ *           reader.SetEntry(entry);
+ */
+class LumiBlocks
+{
+public:
+    /// A contiguous range of entries from the same luminosity block
+    struct Block
+    {
+        UInt_t run, lumi;
+        Long64_t firstEntry, numEntries;
+        Double_t sumSelectedWeights;
+    };
+    
+    /// Function that decides whether a luminosity block is selected
+    using Selector = std::function<bool(unsigned long run, unsigned long lumi)>;
+    
+public:
+    /**
+     * \brief Constructor from a file
+     * 
+     * Throws an exception if the file does not contain the summary.
+     */
+    LumiBlocks(TFile &file, std::string const &treeName = "pecEventID/LumiBlocks");
+    
+    /// Constructor from a tree with the summary
+    LumiBlocks(TTree *tree);
+    
+public:
+    /// Returns all blocks in the order of entries
+    std::vector<Block> const &Blocks() const;
+    
+    /**
+     * \brief Returns ranges of entries in selected luminosity blocks
+     * 
+     * Each range is given as a half-open interval [first, second). Adjacent ranges are merged.
+     */
+    std::vector<std::pair<long long, long long>> SelectEntries(Selector const &selector) const;
+    
+    /// Returns the number of entries in selected luminosity blocks
+    long long NumEntries(Selector const &selector) const;
+    
+    /**
+     * \brief Returns the sum of nominal weights of events in selected luminosity blocks
+     * 
+     * Only includes events written to the file. This is not the sum to normalize simulation with.
+     */
+    double SumSelectedWeights(Selector const &selector) const;
+    
+private:
+    /// Reads the summary from the given tree
+    void Read(TTree *tree);
+    
+private:
+    /// Blocks in the order of entries
+    std::vector<Block> blocks;
+};
+
+
+inline LumiBlocks::LumiBlocks(TFile &file, std::string const &treeName)
+{
+    TTree *tree = dynamic_cast<TTree *>(file.Get(treeName.c_str()));
+    
+    if (not tree)
+        throw std::runtime_error("pec::LumiBlocks::LumiBlocks: File \"" +
+          std::string(file.GetName()) + "\" does not contain tree \"" + treeName + "\".");
+    
+    Read(tree);
+}
+
+
+inline LumiBlocks::LumiBlocks(TTree *tree)
+{
+    Read(tree);
+}
+
+
+inline std::vector<LumiBlocks::Block> const &LumiBlocks::Blocks() const
+{
+    return blocks;
+}
+
+
+inline std::vector<std::pair<long long, long long>> LumiBlocks::SelectEntries(
+  Selector const &selector) const
+{
+    std::vector<std::pair<long long, long long>> ranges;
+    
+    for (auto const &b: blocks)
+    {
+        if (not selector(b.run, b.lumi))
+            continue;
+        
+        if (not ranges.empty() and ranges.back().second == b.firstEntry)
+            ranges.back().second += b.numEntries;
+        else
+            ranges.emplace_back(b.firstEntry, b.firstEntry + b.numEntries);
+    }
+    
+    return ranges;
+}
+
+
+inline long long LumiBlocks::NumEntries(Selector const &selector) const
+{
+    long long n = 0;
+    
+    for (auto const &b: blocks)
+        if (selector(b.run, b.lumi))
+            n += b.numEntries;
+    
+    return n;
+}
+
+
+inline double LumiBlocks::SumSelectedWeights(Selector const &selector) const
+{
+    double sum = 0.;
+    
+    for (auto const &b: blocks)
+        if (selector(b.run, b.lumi))
+            sum += b.sumSelectedWeights;
+    
+    return sum;
+}
+
+
+inline void LumiBlocks::Read(TTree *tree)
+{
+    Block block;
+    tree->SetBranchAddress("run", &block.run);
+    tree->SetBranchAddress("lumi", &block.lumi);
+    tree->SetBranchAddress("firstEntry", &block.firstEntry);
+    tree->SetBranchAddress("numEntries", &block.numEntries);
+    tree->SetBranchAddress("sumSelectedWeights", &block.sumSelectedWeights);
+    
+    long long const numEntries = tree->GetEntries();
+    blocks.reserve(numEntries);
+    
+    for (long long i = 0; i < numEntries; ++i)
+    {
+        tree->GetEntry(i);
+        blocks.emplace_back(block);
+    }
+    
+    tree->ResetBranchAddresses();
+}
+}  // end of namespace pec
@@ -19,6 +19,9 @@ public:
     
 public:
     /// Resets the object to a state right after the default initialisation
-    virtual void Reset() override;
+    void Reset();
+    
+    /// Version of the class for ROOT i/o
+    ClassDefNV(Muon, 2)
 };
 }  // end of namespace pec
@@ -8,6 +8,9 @@ namespace pec
 /**
  * \class PileUpInfo
  * \brief Combines information related to pile-up
+ * 
+ * The version for ROOT i/o is set with ClassDefNV and must be incremented whenever the data
+ * members change.
  */
 class PileUpInfo
 {
@@ -93,14 +96,15 @@ private:
     UChar_t numPV;
     
     /// Average angular pt densities, GeV
-    Float_t rho, rhoCentral;
+    Float16_t rho;  //[0, 0, 12]
+    Float16_t rhoCentral;  //[0, 0, 12]
     
     /**
      * \brief "True" number of pile-up interactions
      * 
      * Zero in case of real data.
      */
-    Float_t trueNumPU;
+    Float16_t trueNumPU;  //[0, 0, 14]
     
     /**
      * \brief Number of pile-up interactions in the in-time bunch crossing
@@ -110,6 +114,9 @@ private:
     UChar_t inTimeNumPU;
     
     /// Largest ptHat of admixed in-time pileup interactions
-    Float_t maxPtHat;
+    Float16_t maxPtHat;  //[0, 0, 12]
+    
+    /// Version of the class for ROOT i/o
+    ClassDefNV(PileUpInfo, 2)
 };
 }  // end of namespace pec
@@ -0,0 +1,956 @@
+#pragma once
+
+#include <Analysis/PECTuples/interface/EventIndex.h>
+#include <Analysis/PECTuples/interface/Jet.h>
+
+#include <TBranch.h>
+#include <TBranchElement.h>
+#include <TFile.h>
+#include <TObjArray.h>
+#include <TTree.h>
+
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace pec
+{
+/**
+ * \class LazyBranch
+ * \brief A split top-level branch whose sub-branches are read only when accessed
+ * 
+ * The branch is read in the MakeClass mode, i.e. data members of stored objects are read into
+ * plain arrays and no dictionaries for PEC classes are needed. When created, all sub-branches are
+ * disabled. A sub-branch is enabled when the corresponding data member is accessed for the first
+ * time with the help of class LazyMember, and from then on it is read whenever the parent branch
+ * is loaded. If the branch stores a collection, its size is read into a counter. The counter is
+ * read before the data members, and if the collection does not fit into their buffers, they are
+ * reallocated. The maximal size recorded in the branch is only used as the initial capacity since
+ * it might be underestimated, e.g. in merged files.
+ * 
+ * This class requires that the objects have been written with a non-zero split level, which is
+ * the default for PEC plugins.
+ */
+class LazyBranch
+{
+public:
+    /**
+     * \brief Constructor
+     * 
+     * The tree must have been switched into the MakeClass mode. The entry to read is taken from
+     * the given variable, which is owned by the reader. Throws an exception if the branch is not
+     * found.
+     */
+    LazyBranch(TTree *tree, std::string const &name, long long const &entry);
+    
+    /// Not copyable since addresses of the buffers are registered in ROOT
+    LazyBranch(LazyBranch const &) = delete;
+    
+    /// Not assignable since addresses of the buffers are registered in ROOT
+    LazyBranch &operator=(LazyBranch const &) = delete;
+    
+public:
+    /**
+     * \brief Returns size of the collection in the current entry
+     * 
+     * Meaningless for branches that store a single object.
+     */
+    unsigned Size();
+    
+    /**
+     * \brief Reads the current entry if it has not been read yet
+     * 
+     * Only the counter and enabled sub-branches are read. If the collection is larger than the
+     * current capacity, buffers of all enabled data members are reallocated before they are read.
+     */
+    void Load();
+    
+    /**
+     * \brief Enables reading of the sub-branch for the given data member
+     * 
+     * The given function must allocate a buffer for the given number of objects and return its
+     * address. It is called immediately with Capacity() and then each time the capacity grows.
+     * If the current entry has already been read, reads the sub-branch for it. Throws an exception
+     * if the data member is not found.
+     */
+    void Enable(std::string const &member, std::function<void *(unsigned)> const &allocate);
+    
+    /**
+     * \brief Returns the number of objects buffers of data members must be able to hold
+     * 
+     * Initialized with the maximal size of the collection recorded in the tree, or 1 for single
+     * objects, and grows if a larger collection is read.
+     */
+    unsigned Capacity() const;
+    
+private:
+    /// Searches recursively for the sub-branch that stores the given data member
+    static TBranch *FindMember(TBranch *parent, std::string const &member);
+    
+    /// Disables the given branch and all its sub-branches
+    static void DisableRecursively(TBranch *branch);
+    
+private:
+    /// Top-level branch
+    TBranch *branch;
+    
+    /// Current entry of the reader
+    long long const &entry;
+    
+    /// Entry that has been read last, or -1
+    long long loadedEntry;
+    
+    /// Buffer for the size of the collection
+    Int_t count;
+    
+    /// Number of objects that buffers of data members can hold
+    unsigned capacity;
+    
+    /**
+     * \brief Sub-branches of enabled data members and functions to allocate their buffers
+     * 
+     * The sub-branches stay disabled in the tree and are read explicitly after the counter.
+     */
+    std::vector<std::pair<TBranch *, std::function<void *(unsigned)>>> members;
+};
+
+
+/**
+ * \class LazyMember
+ * \brief Buffer for a data member of objects stored in a LazyBranch
+ * 
+ * The sub-branch is enabled on the first access. Arrays of fixed size N are supported.
+ */
+template<typename T, unsigned N = 1>
+class LazyMember
+{
+public:
+    /// Constructor
+    LazyMember(LazyBranch &parent, std::string const &name);
+    
+public:
+    /**
+     * \brief Returns value of the data member of the object with the given index
+     * 
+     * For array members, the second index selects the element of the array. Indices are not
+     * checked.
+     */
+    T Get(unsigned index, unsigned element = 0);
+    
+private:
+    /// Parent branch
+    LazyBranch &parent;
+    
+    /// Name of the data member
+    std::string const name;
+    
+    /**
+     * \brief Buffer to read the data member
+     * 
+     * Allocated when the sub-branch is enabled.
+     */
+    std::unique_ptr<T[]> buffer;
+};
+
+
+/**
+ * \class CandidateReader
+ * \brief Reads a collection of pec::Candidate or derived objects
+ * 
+ * Accessors reproduce those of pec::Candidate and take the index of the object as an additional
+ * argument.
+ */
+class CandidateReader
+{
+public:
+    /// Constructor
+    CandidateReader(TTree *tree, std::string const &branchName, long long const &entry);
+    
+public:
+    /// Returns the number of objects in the current entry
+    unsigned size();
+    
+    /// Returns transverse momentum (GeV/c)
+    float Pt(unsigned i);
+    
+    /// Returns pseudorapidity
+    float Eta(unsigned i);
+    
+    /// Returns azimuthal angle, [-pi, pi)
+    float Phi(unsigned i);
+    
+    /// Returns mass (GeV/c^2)
+    float M(unsigned i);
+    
+protected:
+    /// Branch with the collection
+    LazyBranch branch;
+    
+private:
+    /// Data members of pec::Candidate
+    LazyMember<Float_t> pt, eta, phi, mass;
+};
+
+
+/**
+ * \class CandidateWithIDReader
+ * \brief Reads a collection of pec::CandidateWithID or derived objects
+ */
+class CandidateWithIDReader: public CandidateReader
+{
+public:
+    /// Constructor
+    CandidateWithIDReader(TTree *tree, std::string const &branchName, long long const &entry);
+    
+public:
+    /// Tests an ID bit
+    bool TestBit(unsigned i, unsigned bit);
+    
+private:
+    /// Data member of pec::CandidateWithID
+    LazyMember<UChar_t> id;
+};
+
+
+/**
+ * \class JetReader
+ * \brief Reads a collection of pec::Jet
+ * 
+ * See documentation of class pec::Jet for description of the accessors.
+ */
+class JetReader: public CandidateWithIDReader
+{
+public:
+    /// Constructor
+    JetReader(TTree *tree, std::string const &branchName, long long const &entry);
+    
+public:
+    float CorrFactor(unsigned i);
+    float JECUncertainty(unsigned i);
+    float JERUncertainty(unsigned i);
+    float BTag(unsigned i, Jet::BTagAlgo algo);
+    float BTagDNN(unsigned i, Jet::BTagDNNType type);
+    float CTag(unsigned i, Jet::CTagAlgo algo);
+    float PileUpID(unsigned i);
+    float QGTag(unsigned i);
+    float Area(unsigned i);
+    float Charge(unsigned i);
+    float PullAngle(unsigned i);
+    int Flavour(unsigned i, Jet::FlavourType type = Jet::FlavourType::Hadron);
+    
+private:
+    /// Data members of pec::Jet
+    LazyMember<Float_t> corrFactor, jecUncertainty, jerUncertainty;
+    LazyMember<Float_t, 2> bTags, cTags;
+    LazyMember<Float_t, 4> bTagsDNN;
+    LazyMember<Float_t> pileUpMVA, qgTag, area, charge, pullAngle;
+    LazyMember<UShort_t> flavours;
+};
+
+
+/**
+ * \class LeptonReader
+ * \brief Reads a collection of pec::Lepton or derived objects, such as pec::Muon
+ */
+class LeptonReader: public CandidateWithIDReader
+{
+public:
+    /// Constructor
+    LeptonReader(TTree *tree, std::string const &branchName, long long const &entry);
+    
+public:
+    /// Returns electric charge of the lepton, +1 or -1
+    int Charge(unsigned i);
+    
+    /// Returns relative isolation
+    float RelIso(unsigned i);
+    
+private:
+    /// Data members of pec::Lepton
+    LazyMember<Bool_t> charge;
+    LazyMember<Float_t> relIso;
+};
+
+
+/**
+ * \class ElectronReader
+ * \brief Reads a collection of pec::Electron
+ */
+class ElectronReader: public LeptonReader
+{
+public:
+    /// Constructor
+    ElectronReader(TTree *tree, std::string const &branchName, long long const &entry);
+    
+public:
+    /// Returns decision of a boolean ID
+    bool BooleanID(unsigned i, unsigned bitIndex);
+    
+    /// Returns value of a real-valued ID
+    float ContinuousID(unsigned i, unsigned index);
+    
+    /// Returns pseudorapidity of the associated supercluster
+    float EtaSC(unsigned i);
+    
+private:
+    /// Size of array pec::Electron::mvaId. Must match pec::Electron::contIdSize
+    static unsigned const contIdSize = 1;
+    
+    /// Data members of pec::Electron
+    LazyMember<Float_t> etaSC;
+    LazyMember<UChar_t> cutBasedId;
+    LazyMember<Float_t, contIdSize> mvaId;
+};
+
+
+/**
+ * \class EventIDReader
+ * \brief Reads pec::EventID
+ */
+class EventIDReader
+{
+public:
+    /// Constructor
+    EventIDReader(TTree *tree, std::string const &branchName, long long const &entry);
+    
+public:
+    unsigned long RunNumber();
+    unsigned long LumiSectionNumber();
+    unsigned long long EventNumber();
+    unsigned BunchCrossing();
+    
+private:
+    /// Branch with the object
+    LazyBranch branch;
+    
+    /// Data members of pec::EventID
+    LazyMember<UInt_t> run, lumi;
+    LazyMember<ULong64_t> event;
+    LazyMember<UShort_t> bunchCrossing;
+};
+
+
+/**
+ * \class TupleReader
+ * \brief Header-only reader for PEC tuples that does not need the dictionary
+ * 
+ * Provides access to jets, MET, leptons, and event ID stored in a PEC file. Both the layout with
+ * a single tree written by PECOutput and the layout with separate trees written by individual
+ * plugins are supported. Branches are read lazily: only the data members that are actually
+ * accessed are read from the file, and collections that are never accessed are not read at all.
+ * All accessors are inline and can be used from PyROOT after declaring the header with
+ * ROOT.gInterpreter.Declare, without loading libAnalysisPECTuples. Usage:
+ * 
+ *   TFile file("pec.root");
+ *   pec::TupleReader reader(file);
+ * 
+ *   while (reader.Next())
+ *       for (unsigned i = 0; i < reader.Jets().size(); ++i)
+ *           double const pt = reader.Jets().Pt(i) * reader.Jets().CorrFactor(i);
+ * 
+ * Objects must have been written with a non-zero split level, and flat branches written with
+ * option "flatBranches" of the PEC plugins are not supported.
+ */
+class TupleReader
+{
+public:
+    /**
+     * \brief Constructor
+     * 
+     * Finds trees in the given file. The file must be kept open while the reader is used.
+     */
+    TupleReader(TFile &file);
+    
+public:
+    /// Returns the number of entries
+    long long GetEntries() const;
+    
+    /**
+     * \brief Moves to the next entry
+     * 
+     * Returns false if there are no more entries.
+     */
+    bool Next();
+    
+    /// Moves to the given entry
+    void SetEntry(long long entry);
+    
+    /**
+     * \brief Moves to the entry with the given event ID
+     * 
+     * Uses the index written by plugin PECEventID, which is read on the first call. Returns false
+     * if the event is not found, in which case the current entry is not changed. Before moving to
+     * the entry found, checks that it contains the requested event and throws an exception
+     * otherwise, which happens if the index is stale and must be rebuilt.
+     */
+    bool SetEvent(unsigned long run, unsigned long lumi, unsigned long long event);
+    
+    /// Access to collections. Throw an exception if the collection is not found in the file
+    EventIDReader &EventID();
+    JetReader &Jets();
+    CandidateReader &METs();
+    CandidateReader &UncorrMETs();
+    LeptonReader &Muons();
+    ElectronReader &Electrons();
+    
+private:
+    /**
+     * \brief Finds the tree that contains the branch of the given plugin
+     * 
+     * Returns the tree and full name of the branch. If the tree is not found, returns nullptr.
+     */
+    std::pair<TTree *, std::string> FindBranch(std::string const &treeName,
+      std::string const &branchName) const;
+    
+    /// Creates a reader for the given branch unless it has already been created
+    template<typename R>
+    R &Access(std::unique_ptr<R> &reader, std::string const &treeName,
+      std::string const &branchName);
+    
+private:
+    /// File with the trees
+    TFile &file;
+    
+    /// Single tree written by PECOutput, or nullptr
+    TTree *sharedTree;
+    
+    /// Number of entries
+    long long numEntries;
+    
+    /// Current entry
+    long long entry;
+    
+    /// Index of events, read on demand
+    std::unique_ptr<EventIndex> eventIndex;
+    
+    /// Readers for supported collections
+    std::unique_ptr<EventIDReader> eventIDReader;
+    std::unique_ptr<JetReader> jetReader;
+    std::unique_ptr<CandidateReader> metReader, uncorrMETReader;
+    std::unique_ptr<LeptonReader> muonReader;
+    std::unique_ptr<ElectronReader> electronReader;
+};
+
+
+inline LazyBranch::LazyBranch(TTree *tree, std::string const &name, long long const &entry_):
+    entry(entry_),
+    loadedEntry(-1),
+    count(0)
+{
+    branch = tree->GetBranch(name.c_str());
+    
+    if (not branch)
+        throw std::runtime_error("pec::LazyBranch::LazyBranch: Branch \"" + name +
+          "\" is not found.");
+    
+    DisableRecursively(branch);
+    branch->ResetBit(kDoNotProcess);
+    
+    // Branches that store collections provide their maximal size. It is zero for single objects
+    TBranchElement *branchElement = dynamic_cast<TBranchElement *>(branch);
+    int const maximum = (branchElement) ? branchElement->GetMaximum() : 0;
+    capacity = (maximum > 1) ? maximum : 1;
+    
+    // In the MakeClass mode the top-level branch of a collection reads its size
+    if (branchElement and branchElement->GetType() == 4)
+        branch->SetAddress(&count);
+}
+
+
+inline unsigned LazyBranch::Size()
+{
+    Load();
+    return count;
+}
+
+
+inline void LazyBranch::Load()
+{
+    if (loadedEntry == entry)
+        return;
+    
+    // Since all sub-branches are disabled, this only reads the counter
+    branch->GetEntry(entry);
+    
+    if (count < 0)
+        throw std::runtime_error(std::string("pec::LazyBranch::Load: Negative size of the "
+          "collection read from branch \"") + branch->GetName() + "\".");
+    
+    
+    // Make sure buffers of data members can hold the collection before they are read
+    if (unsigned(count) > capacity)
+    {
+        capacity = count;
+        
+        for (auto &member: members)
+            member.first->SetAddress(member.second(capacity));
+    }
+    
+    for (auto &member: members)
+        member.first->GetEntry(entry, 1);
+    
+    loadedEntry = entry;
+}
+
+
+inline void LazyBranch::Enable(std::string const &member,
+  std::function<void *(unsigned)> const &allocate)
+{
+    TBranch *subBranch = FindMember(branch, member);
+    
+    if (not subBranch)
+        throw std::runtime_error("pec::LazyBranch::Enable: Data member \"" + member +
+          "\" is not found in branch \"" + branch->GetName() + "\".");
+    
+    subBranch->SetAddress(allocate(capacity));
+    members.emplace_back(subBranch, allocate);
+    
+    if (loadedEntry == entry)
+        subBranch->GetEntry(entry, 1);
+}
+
+
+inline unsigned LazyBranch::Capacity() const
+{
+    return capacity;
+}
+
+
+inline TBranch *LazyBranch::FindMember(TBranch *parent, std::string const &member)
+{
+    std::string const suffix("." + member);
+    
+    for (auto *object: *parent->GetListOfBranches())
+    {
+        TBranch *subBranch = static_cast<TBranch *>(object);
+        std::string const name(subBranch->GetName());
+        
+        if (name == member or (name.size() > suffix.size() and
+          name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0))
+            return subBranch;
+        
+        // Data members of base classes might be stored in nested sub-branches
+        if (TBranch *nested = FindMember(subBranch, member))
+            return nested;
+    }
+    
+    return nullptr;
+}
+
+
+inline void LazyBranch::DisableRecursively(TBranch *branch)
+{
+    branch->SetBit(TBranch::kDoNotProcess);
+    
+    for (auto *object: *branch->GetListOfBranches())
+        DisableRecursively(static_cast<TBranch *>(object));
+}
+
+
+template<typename T, unsigned N>
+inline LazyMember<T, N>::LazyMember(LazyBranch &parent_, std::string const &name_):
+    parent(parent_),
+    name(name_)
+{}
+
+
+template<typename T, unsigned N>
+inline T LazyMember<T, N>::Get(unsigned index, unsigned element /*= 0*/)
+{
+    if (not buffer)
+        parent.Enable(name, [this](unsigned capacity)
+        {
+            buffer.reset(new T[capacity * N]);
+            return static_cast<void *>(buffer.get());
+        });
+    
+    parent.Load();
+    return buffer[index * N + element];
+}
+
+
+inline CandidateReader::CandidateReader(TTree *tree, std::string const &branchName,
+  long long const &entry):
+    branch(tree, branchName, entry),
+    pt(branch, "pt"), eta(branch, "eta"), phi(branch, "phi"), mass(branch, "mass")
+{}
+
+
+inline unsigned CandidateReader::size()
+{
+    return branch.Size();
+}
+
+
+inline float CandidateReader::Pt(unsigned i)
+{
+    return pt.Get(i);
+}
+
+
+inline float CandidateReader::Eta(unsigned i)
+{
+    return eta.Get(i);
+}
+
+
+inline float CandidateReader::Phi(unsigned i)
+{
+    return phi.Get(i);
+}
+
+
+inline float CandidateReader::M(unsigned i)
+{
+    return mass.Get(i);
+}
+
+
+inline CandidateWithIDReader::CandidateWithIDReader(TTree *tree, std::string const &branchName,
+  long long const &entry):
+    CandidateReader(tree, branchName, entry),
+    id(branch, "id")
+{}
+
+
+inline bool CandidateWithIDReader::TestBit(unsigned i, unsigned bit)
+{
+    return (id.Get(i) & (1 << bit));
+}
+
+
+inline JetReader::JetReader(TTree *tree, std::string const &branchName, long long const &entry):
+    CandidateWithIDReader(tree, branchName, entry),
+    corrFactor(branch, "corrFactor"), jecUncertainty(branch, "jecUncertainty"),
+    jerUncertainty(branch, "jerUncertainty"),
+    bTags(branch, "bTags"), cTags(branch, "cTags"), bTagsDNN(branch, "bTagsDNN"),
+    pileUpMVA(branch, "pileUpMVA"), qgTag(branch, "qgTag"), area(branch, "area"),
+    charge(branch, "charge"), pullAngle(branch, "pullAngle"),
+    flavours(branch, "flavours")
+{}
+
+
+inline float JetReader::CorrFactor(unsigned i)
+{
+    return corrFactor.Get(i);
+}
+
+
+inline float JetReader::JECUncertainty(unsigned i)
+{
+    return jecUncertainty.Get(i);
+}
+
+
+inline float JetReader::JERUncertainty(unsigned i)
+{
+    return jerUncertainty.Get(i);
+}
+
+
+inline float JetReader::BTag(unsigned i, Jet::BTagAlgo algo)
+{
+    return bTags.Get(i, unsigned(algo));
+}
+
+
+inline float JetReader::BTagDNN(unsigned i, Jet::BTagDNNType type)
+{
+    // Only the first four discriminators are stored, see pec::Jet::BTagDNN
+    if (type != Jet::BTagDNNType::UDSG)
+        return bTagsDNN.Get(i, unsigned(type));
+    
+    float value = 1.f;
+    
+    for (unsigned k = 0; k < 4; ++k)
+        value -= bTagsDNN.Get(i, k);
+    
+    return (std::abs(value - 5) < 1e-4) ? -1.f : value;
+}
+
+
+inline float JetReader::CTag(unsigned i, Jet::CTagAlgo algo)
+{
+    return cTags.Get(i, unsigned(algo));
+}
+
+
+inline float JetReader::PileUpID(unsigned i)
+{
+    return pileUpMVA.Get(i);
+}
+
+
+inline float JetReader::QGTag(unsigned i)
+{
+    return qgTag.Get(i);
+}
+
+
+inline float JetReader::Area(unsigned i)
+{
+    return area.Get(i);
+}
+
+
+inline float JetReader::Charge(unsigned i)
+{
+    return charge.Get(i);
+}
+
+
+inline float JetReader::PullAngle(unsigned i)
+{
+    return pullAngle.Get(i);
+}
+
+
+inline int JetReader::Flavour(unsigned i, Jet::FlavourType type /*= Jet::FlavourType::Hadron*/)
+{
+    // Decoding follows pec::Jet::Flavour
+    unsigned const encodedFlavour = flavours.Get(i)>>(4 * unsigned(type)) & 0xF;
+    
+    if (encodedFlavour == 0xF)
+        return 21;
+    else if (encodedFlavour == 0)
+        return 0;
+    else
+        return encodedFlavour - 6;
+}
+
+
+inline LeptonReader::LeptonReader(TTree *tree, std::string const &branchName,
+  long long const &entry):
+    CandidateWithIDReader(tree, branchName, entry),
+    charge(branch, "charge"), relIso(branch, "relIso")
+{}
+
+
+inline int LeptonReader::Charge(unsigned i)
+{
+    return ((charge.Get(i)) ? -1 : 1);
+}
+
+
+inline float LeptonReader::RelIso(unsigned i)
+{
+    return relIso.Get(i);
+}
+
+
+inline ElectronReader::ElectronReader(TTree *tree, std::string const &branchName,
+  long long const &entry):
+    LeptonReader(tree, branchName, entry),
+    etaSC(branch, "etaSC"), cutBasedId(branch, "cutBasedId"), mvaId(branch, "mvaId")
+{}
+
+
+inline bool ElectronReader::BooleanID(unsigned i, unsigned bitIndex)
+{
+    return (cutBasedId.Get(i) & (1 << bitIndex));
+}
+
+
+inline float ElectronReader::ContinuousID(unsigned i, unsigned index)
+{
+    return mvaId.Get(i, index);
+}
+
+
+inline float ElectronReader::EtaSC(unsigned i)
+{
+    return etaSC.Get(i);
+}
+
+
+inline EventIDReader::EventIDReader(TTree *tree, std::string const &branchName,
+  long long const &entry):
+    branch(tree, branchName, entry),
+    run(branch, "run"), lumi(branch, "lumi"), event(branch, "event"),
+    bunchCrossing(branch, "bunchCrossing")
+{}
+
+
+inline unsigned long EventIDReader::RunNumber()
+{
+    return run.Get(0);
+}
+
+
+inline unsigned long EventIDReader::LumiSectionNumber()
+{
+    return lumi.Get(0);
+}
+
+
+inline unsigned long long EventIDReader::EventNumber()
+{
+    return event.Get(0);
+}
+
+
+inline unsigned EventIDReader::BunchCrossing()
+{
+    return bunchCrossing.Get(0);
+}
+
+
+inline TupleReader::TupleReader(TFile &file_):
+    file(file_),
+    numEntries(0),
+    entry(-1)
+{
+    sharedTree = dynamic_cast<TTree *>(file.Get("pecOutput/Events"));
+    
+    if (sharedTree)
+    {
+        sharedTree->SetMakeClass(1);
+        numEntries = sharedTree->GetEntries();
+    }
+    else
+    {
+        // All trees written by individual plugins have the same number of entries
+        TTree *tree = dynamic_cast<TTree *>(file.Get("pecEventID/EventID"));
+        
+        if (not tree)
+            throw std::runtime_error("pec::TupleReader::TupleReader: File \"" +
+              std::string(file.GetName()) + "\" does not contain PEC trees.");
+        
+        numEntries = tree->GetEntries();
+    }
+}
+
+
+inline long long TupleReader::GetEntries() const
+{
+    return numEntries;
+}
+
+
+inline bool TupleReader::Next()
+{
+    if (entry + 1 >= numEntries)
+        return false;
+    
+    ++entry;
+    return true;
+}
+
+
+inline void TupleReader::SetEntry(long long entry_)
+{
+    entry = entry_;
+}
+
+
+inline bool TupleReader::SetEvent(unsigned long run, unsigned long lumi, unsigned long long event)
+{
+    if (not eventIndex)
+        eventIndex.reset(new EventIndex(file));
+    
+    long long const res = eventIndex->Find(run, lumi, event);
+    
+    if (res < 0)
+        return false;
+    
+    if (res >= numEntries)
+        throw std::runtime_error("pec::TupleReader::SetEvent: Index in file \"" +
+          std::string(file.GetName()) + "\" refers to entry " + std::to_string(res) +
+          " beyond the end of the tree. Rebuild the index with script eventIndex.py.");
+    
+    
+    // Verify the event ID in the entry found. The current entry is restored if the check fails
+    long long const prevEntry = entry;
+    entry = res;
+    EventIDReader &eventID = EventID();
+    
+    if (eventID.RunNumber() != run or eventID.LumiSectionNumber() != lumi or
+      eventID.EventNumber() != event)
+    {
+        entry = prevEntry;
+        throw std::runtime_error("pec::TupleReader::SetEvent: Entry " + std::to_string(res) +
+          " found in the index of file \"" + std::string(file.GetName()) + "\" does not contain "
+          "event " + std::to_string(run) + ":" + std::to_string(lumi) + ":" +
+          std::to_string(event) + ". Rebuild the index with script eventIndex.py.");
+    }
+    
+    return true;
+}
+
+
+inline EventIDReader &TupleReader::EventID()
+{
+    return Access(eventIDReader, "EventID", "eventId");
+}
+
+
+inline JetReader &TupleReader::Jets()
+{
+    return Access(jetReader, "JetMET", "jets");
+}
+
+
+inline CandidateReader &TupleReader::METs()
+{
+    return Access(metReader, "JetMET", "METs");
+}
+
+
+inline CandidateReader &TupleReader::UncorrMETs()
+{
+    return Access(uncorrMETReader, "JetMET", "uncorrMETs");
+}
+
+
+inline LeptonReader &TupleReader::Muons()
+{
+    return Access(muonReader, "Muons", "muons");
+}
+
+
+inline ElectronReader &TupleReader::Electrons()
+{
+    return Access(electronReader, "Electrons", "electrons");
+}
+
+
+inline std::pair<TTree *, std::string> TupleReader::FindBranch(std::string const &treeName,
+  std::string const &branchName) const
+{
+    // In the shared tree names of branches are prefixed with names of the original trees
+    if (sharedTree)
+        return {sharedTree, treeName + "_" + branchName};
+    
+    // Otherwise the tree is found in the directory of the plugin
+    TTree *tree = dynamic_cast<TTree *>(file.Get(("pec" + treeName + "/" + treeName).c_str()));
+    
+    if (tree)
+        tree->SetMakeClass(1);
+    
+    return {tree, branchName};
+}
+
+
+template<typename R>
+inline R &TupleReader::Access(std::unique_ptr<R> &reader, std::string const &treeName,
+  std::string const &branchName)
+{
+    if (not reader)
+    {
+        auto const location = FindBranch(treeName, branchName);
+        
+        if (not location.first)
+            throw std::runtime_error("pec::TupleReader::Access: Tree \"" + treeName +
+              "\" is not found in file \"" + file.GetName() + "\".");
+        
+        reader.reset(new R(location.first, location.second, entry));
+    }
+    
+    return *reader;
+}
+}  // end of namespace pec
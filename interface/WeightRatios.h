@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Rtypes.h>
+
+
+namespace pec
+{
+/**
+ * \class WeightRatios
+ * \brief Converts alternative event weights to and from the compact representation
+ * 
+ * Plugin PECGenerator can store alternative LHE and PS weights as ratios to the nominal weight
+ * instead of absolute values. The ratios are written either as Float_t or quantized into 16-bit
+ * unsigned integers. In the latter case a ratio is clamped to the range [minRatio, maxRatio] and
+ * mapped linearly onto 65535 equal steps, so the absolute error of a decoded ratio is about
+ * (maxRatio - minRatio) / 131070. The range used in production is written, together with indices
+ * and IDs of stored weights, in the tree "WeightSchema" in the directory of the plugin.
+ * 
+ * If the nominal weight is zero, ratios are stored as zeros, and the reconstructed absolute
+ * weights are zero as well.
+ */
+class WeightRatios
+{
+public:
+    /// Constructor with the range of quantized ratios
+    WeightRatios(float minRatio = -1.f, float maxRatio = 3.f);
+    
+public:
+    /// Returns the ratio of the given weight to the nominal one
+    static float ComputeRatio(float weight, float nominalWeight);
+    
+    /// Converts stored ratios (not quantized) into absolute weights
+    static void Decode(float nominalWeight, unsigned size, Float_t const *ratios, float *weights);
+    
+    /// Converts the given ratio into the 16-bit representation
+    UShort_t Encode(float ratio) const;
+    
+    /// Converts a quantized value back into the ratio
+    float DecodeRatio(UShort_t code) const;
+    
+    /// Converts stored quantized ratios into absolute weights
+    void Decode(float nominalWeight, unsigned size, UShort_t const *codes, float *weights) const;
+    
+    /// Returns the lower boundary of the range of quantized ratios
+    float MinRatio() const;
+    
+    /// Returns the upper boundary of the range of quantized ratios
+    float MaxRatio() const;
+    
+private:
+    /// Range of quantized ratios
+    float minRatio, maxRatio;
+    
+    /// Width of a single quantization step
+    float step;
+    
+    /// Largest value of the 16-bit representation
+    static unsigned const maxCode = 65535;
+};
+}  // end of namespace pec
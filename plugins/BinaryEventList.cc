@@ -0,0 +1,189 @@
+#include "BinaryEventList.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+
+
+BinaryEventList::BinaryEventList(std::string const &fileName_):
+    fileName(fileName_),
+    data(nullptr),
+    dataSize(0)
+{
+    int const fd = open(fileName.c_str(), O_RDONLY);
+    
+    if (fd < 0)
+        throw std::runtime_error("BinaryEventList::BinaryEventList: Cannot open file \"" +
+          fileName + "\".");
+    
+    struct stat fileStat;
+    
+    if (fstat(fd, &fileStat) != 0 or std::size_t(fileStat.st_size) < sizeof(Header))
+    {
+        close(fd);
+        Fail("the file is too short");
+    }
+    
+    dataSize = fileStat.st_size;
+    void *const mapped = mmap(nullptr, dataSize, PROT_READ, MAP_SHARED, fd, 0);
+    
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+    
+    if (mapped == MAP_FAILED)
+        throw std::runtime_error("BinaryEventList::BinaryEventList: Cannot map file \"" +
+          fileName + "\" into memory.");
+    
+    data = static_cast<unsigned char const *>(mapped);
+    
+    
+    // Validate the header and the table of runs. Offsets of restart points and events are checked
+    //here as well, so that lookups do not need to do it
+    header = reinterpret_cast<Header const *>(data);
+    
+    if (std::memcmp(header->magic, "PECEVL01", 8) != 0 or header->version != 1)
+    {
+        munmap(const_cast<unsigned char *>(data), dataSize);
+        Fail("format is not recognized");
+    }
+    
+    try
+    {
+        if (header->restartInterval == 0)
+            Fail("restart interval is zero");
+        
+        if (header->numRuns > (dataSize - sizeof(Header)) / sizeof(RunEntry))
+            Fail("the table of runs is truncated");
+        
+        runs = reinterpret_cast<RunEntry const *>(data + sizeof(Header));
+        
+        for (std::uint64_t i = 0; i < header->numRuns; ++i)
+        {
+            RunEntry const &r = runs[i];
+            std::uint64_t const numRestarts =
+              (r.numEvents + header->restartInterval - 1) / header->restartInterval;
+            
+            if (r.restartsOffset % alignof(RestartPoint) != 0 or r.restartsOffset > dataSize or
+              numRestarts > (dataSize - r.restartsOffset) / sizeof(RestartPoint) or
+              r.dataOffset > dataSize)
+                Fail("offsets for run " + std::to_string(r.run) + " are invalid");
+            
+            if (i > 0 and runs[i - 1].run >= r.run)
+                Fail("runs are not sorted");
+        }
+    }
+    catch (...)
+    {
+        munmap(const_cast<unsigned char *>(data), dataSize);
+        throw;
+    }
+}
+
+
+BinaryEventList::~BinaryEventList() noexcept
+{
+    munmap(const_cast<unsigned char *>(data), dataSize);
+}
+
+
+bool BinaryEventList::Contains(unsigned long run, unsigned long lumi,
+  unsigned long long event) const
+{
+    // Find the run
+    RunEntry const *const runsEnd = runs + header->numRuns;
+    RunEntry const *const r = std::lower_bound(runs, runsEnd, run,
+      [](RunEntry const &entry, unsigned long run){return entry.run < run;});
+    
+    if (r == runsEnd or r->run != run)
+        return false;
+    
+    
+    // Find the last restart point that does not exceed the given ID
+    auto const key = std::make_tuple(lumi, event);
+    std::uint64_t const K = header->restartInterval;
+    std::uint64_t const numRestarts = (r->numEvents + K - 1) / K;
+    RestartPoint const *const restarts =
+      reinterpret_cast<RestartPoint const *>(data + r->restartsOffset);
+    RestartPoint const *const restartsEnd = restarts + numRestarts;
+    
+    RestartPoint const *group = std::upper_bound(restarts, restartsEnd, key,
+      [](std::tuple<unsigned long, unsigned long long> const &key, RestartPoint const &point)
+      {return key < std::make_tuple((unsigned long)point.lumi, (unsigned long long)point.event);});
+    
+    if (group == restarts)
+        return false;
+    
+    --group;
+    
+    if (group->lumi == lumi and group->event == event)
+        return true;
+    
+    
+    // Decode the remaining events of the group
+    std::uint64_t const groupIndex = group - restarts;
+    std::uint64_t const groupSize = std::min(K, r->numEvents - groupIndex * K);
+    unsigned char const *p = data + r->dataOffset + group->position;
+    unsigned char const *const end = data + dataSize;
+    
+    if (p > end)
+        Fail("position of a restart point is out of range");
+    
+    std::uint64_t curLumi = group->lumi, curEvent = group->event;
+    
+    for (std::uint64_t i = 1; i < groupSize; ++i)
+    {
+        std::uint64_t const lumiDelta = DecodeVarint(p, end);
+        
+        if (lumiDelta == 0)
+            curEvent += DecodeVarint(p, end);
+        else
+        {
+            curLumi += lumiDelta;
+            curEvent = DecodeVarint(p, end);
+        }
+        
+        if (curLumi > lumi or (curLumi == lumi and curEvent >= event))
+            return (curLumi == lumi and curEvent == event);
+    }
+    
+    return false;
+}
+
+
+std::size_t BinaryEventList::size() const
+{
+    return header->numEvents;
+}
+
+
+std::uint64_t BinaryEventList::DecodeVarint(unsigned char const *&p, unsigned char const *end)
+{
+    std::uint64_t value = 0;
+    
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        if (p == end)
+            throw std::runtime_error("BinaryEventList: Encoded events are truncated.");
+        
+        unsigned char const byte = *p++;
+        value |= std::uint64_t(byte & 0x7F) << shift;
+        
+        if ((byte & 0x80) == 0)
+            return value;
+    }
+    
+    throw std::runtime_error("BinaryEventList: Encoded event exceeds 64 bits.");
+}
+
+
+void BinaryEventList::Fail(std::string const &reason) const
+{
+    throw std::runtime_error("BinaryEventList: File \"" + fileName + "\" is malformed: " +
+      reason + ".");
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+/**
+ * \class BinaryEventList
+ * \brief Read-only, memory-mapped list of event IDs in a compact binary format
+ * 
+ * Files in this format are produced by script convertEventList.py from lists in the text or ROOT
+ * format accepted by EventIDFilter. The file is mapped into memory read-only and is never copied,
+ * so when several processes on the same machine use the same list, they share its pages in the
+ * page cache. Lookups only touch a few pages, and thus the start-up time does not depend on the
+ * size of the list.
+ * 
+ * All numbers are little-endian. The file consists of the following parts:
+ *  - Header (32 bytes): magic string "PECEVL01", uint32 version (1), uint32 restart interval K,
+ *    uint64 number of runs, uint64 total number of events.
+ *  - Table of runs, sorted by run number (32 bytes per run): uint32 run, uint32 padding, uint64
+ *    number of events in the run, uint64 offset of the restart points of the run, uint64 offset of
+ *    the encoded events of the run. Offsets are given with respect to the start of the file.
+ *  - For each run, restart points (16 bytes each): uint32 luminosity block, uint32 position in
+ *    the encoded events, uint64 event number.
+ *  - For each run, encoded events.
+ * 
+ * Within a run, events are sorted by luminosity block and event number, duplicates are removed,
+ * and events are split into groups of K. The first event of each group is stored in full in its
+ * restart point, which also gives the position of the encoding of the next event. The remaining
+ * events of the group are delta-encoded with respect to the previous event as a variable-length
+ * integer (7 bits per byte, least significant group first) with the difference in the luminosity
+ * block, followed by the difference in the event number if the luminosity block is the same or the
+ * full event number otherwise. A lookup is a binary search in the table of runs and in the restart
+ * points, followed by decoding of at most K - 1 events.
+ */
+class BinaryEventList
+{
+public:
+    /**
+     * \brief Maps the given file into memory
+     * 
+     * Throws an exception of type std::runtime_error if the file cannot be mapped or its format is
+     * not recognized.
+     */
+    BinaryEventList(std::string const &fileName);
+    
+    /// Copying is not allowed
+    BinaryEventList(BinaryEventList const &) = delete;
+    
+    /// Unmaps the file
+    ~BinaryEventList() noexcept;
+    
+    /// Copying is not allowed
+    BinaryEventList &operator=(BinaryEventList const &) = delete;
+    
+public:
+    /// Checks if the given event ID is in the list
+    bool Contains(unsigned long run, unsigned long lumi, unsigned long long event) const;
+    
+    /// Returns the number of events in the list
+    std::size_t size() const;
+    
+private:
+    /// Header of the file
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t restartInterval;
+        std::uint64_t numRuns;
+        std::uint64_t numEvents;
+    };
+    
+    /// Entry of the table of runs
+    struct RunEntry
+    {
+        std::uint32_t run;
+        std::uint32_t padding;
+        std::uint64_t numEvents;
+        std::uint64_t restartsOffset;
+        std::uint64_t dataOffset;
+    };
+    
+    /// Restart point
+    struct RestartPoint
+    {
+        std::uint32_t lumi;
+        std::uint32_t position;
+        std::uint64_t event;
+    };
+    
+private:
+    /**
+     * \brief Decodes a variable-length integer and advances the pointer
+     * 
+     * Throws an exception if the encoding extends beyond the given end.
+     */
+    static std::uint64_t DecodeVarint(unsigned char const *&p, unsigned char const *end);
+    
+    /// Throws an exception with a message about a malformed file
+    [[noreturn]] void Fail(std::string const &reason) const;
+    
+private:
+    /// Name of the file
+    std::string fileName;
+    
+    /// Start of the mapped region
+    unsigned char const *data;
+    
+    /// Size of the mapped region
+    std::size_t dataSize;
+    
+    /// Pointers to parts of the file
+    Header const *header;
+    RunEntry const *runs;
+};
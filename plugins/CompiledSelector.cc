@@ -0,0 +1,202 @@
+#include "CompiledSelector.h"
+
+#include <map>
+
+
+using namespace std;
+
+
+namespace
+{
+/**
+ * \brief Returns accessor to a property that is common for all candidates
+ * 
+ * The function is templated so that derived types can be used directly.
+ */
+template<typename T>
+function<double(T const &)> FindCandidateVariable(string const &name, string const &argument)
+{
+    static map<string, function<double(T const &)>> const variables{
+        {"pt", [](T const &c){return c.pt();}},
+        {"eta", [](T const &c){return c.eta();}},
+        {"phi", [](T const &c){return c.phi();}},
+        {"mass", [](T const &c){return c.mass();}},
+        {"energy", [](T const &c){return c.energy();}},
+        {"et", [](T const &c){return c.et();}},
+        {"p", [](T const &c){return c.p();}},
+        {"px", [](T const &c){return c.px();}},
+        {"py", [](T const &c){return c.py();}},
+        {"pz", [](T const &c){return c.pz();}},
+        {"rapidity", [](T const &c){return c.rapidity();}},
+        {"y", [](T const &c){return c.y();}},
+        {"charge", [](T const &c){return c.charge();}},
+        {"pdgId", [](T const &c){return c.pdgId();}},
+        {"status", [](T const &c){return c.status();}},
+        {"numberOfDaughters", [](T const &c){return c.numberOfDaughters();}}
+    };
+    
+    if (not argument.empty())
+        return nullptr;
+    
+    auto const res = variables.find(name);
+    return (res != variables.end()) ? res->second : nullptr;
+}
+
+
+/// Returns accessor to a user-defined property of a PAT object
+template<typename T>
+function<double(T const &)> FindUserVariable(string const &name, string const &argument)
+{
+    if (argument.empty())
+        return nullptr;
+    
+    if (name == "userFloat")
+        return [argument](T const &o){return o.userFloat(argument);};
+    else if (name == "userInt")
+        return [argument](T const &o){return o.userInt(argument);};
+    else if (name == "hasUserFloat")
+        return [argument](T const &o){return o.hasUserFloat(argument);};
+    else if (name == "hasUserInt")
+        return [argument](T const &o){return o.hasUserInt(argument);};
+    
+    return nullptr;
+}
+}  // anonymous namespace
+
+
+template<>
+function<double(reco::Candidate const &)> SelectorVariables<reco::Candidate>::Find(
+  string const &name, string const &argument)
+{
+    return FindCandidateVariable<reco::Candidate>(name, argument);
+}
+
+
+template<>
+function<double(pat::Electron const &)> SelectorVariables<pat::Electron>::Find(
+  string const &name, string const &argument)
+{
+    using T = pat::Electron;
+    
+    if (auto accessor = FindCandidateVariable<T>(name, argument))
+        return accessor;
+    
+    if (auto accessor = FindUserVariable<T>(name, argument))
+        return accessor;
+    
+    if (name == "electronID" and not argument.empty())
+        return [argument](T const &e){return e.electronID(argument);};
+    
+    static map<string, function<double(T const &)>> const variables{
+        {"superCluster.eta", [](T const &e){return e.superCluster()->eta();}},
+        {"superCluster.phi", [](T const &e){return e.superCluster()->phi();}},
+        {"superCluster.energy", [](T const &e){return e.superCluster()->energy();}},
+        {"isPF", [](T const &e){return e.isPF();}},
+        {"isEB", [](T const &e){return e.isEB();}},
+        {"isEE", [](T const &e){return e.isEE();}}
+    };
+    
+    if (not argument.empty())
+        return nullptr;
+    
+    auto const res = variables.find(name);
+    return (res != variables.end()) ? res->second : nullptr;
+}
+
+
+template<>
+function<double(pat::Muon const &)> SelectorVariables<pat::Muon>::Find(
+  string const &name, string const &argument)
+{
+    using T = pat::Muon;
+    
+    if (auto accessor = FindCandidateVariable<T>(name, argument))
+        return accessor;
+    
+    if (auto accessor = FindUserVariable<T>(name, argument))
+        return accessor;
+    
+    static map<string, function<double(T const &)>> const variables{
+        {"isGlobalMuon", [](T const &m){return m.isGlobalMuon();}},
+        {"isTrackerMuon", [](T const &m){return m.isTrackerMuon();}},
+        {"isPFMuon", [](T const &m){return m.isPFMuon();}},
+        {"isLooseMuon", [](T const &m){return m.isLooseMuon();}},
+        {"isMediumMuon", [](T const &m){return m.isMediumMuon();}},
+        {"numberOfMatchedStations", [](T const &m){return m.numberOfMatchedStations();}}
+    };
+    
+    if (not argument.empty())
+        return nullptr;
+    
+    auto const res = variables.find(name);
+    return (res != variables.end()) ? res->second : nullptr;
+}
+
+
+template<>
+function<double(pat::Jet const &)> SelectorVariables<pat::Jet>::Find(
+  string const &name, string const &argument)
+{
+    using T = pat::Jet;
+    
+    if (auto accessor = FindCandidateVariable<T>(name, argument))
+        return accessor;
+    
+    if (auto accessor = FindUserVariable<T>(name, argument))
+        return accessor;
+    
+    if (name == "bDiscriminator" and not argument.empty())
+        return [argument](T const &j){return j.bDiscriminator(argument);};
+    else if (name == "jecFactor" and not argument.empty())
+        return [argument](T const &j){return j.jecFactor(argument);};
+    
+    static map<string, function<double(T const &)>> const variables{
+        {"hadronFlavour", [](T const &j){return j.hadronFlavour();}},
+        {"partonFlavour", [](T const &j){return j.partonFlavour();}},
+        {"jetArea", [](T const &j){return j.jetArea();}},
+        {"neutralHadronEnergyFraction", [](T const &j){return j.neutralHadronEnergyFraction();}},
+        {"neutralEmEnergyFraction", [](T const &j){return j.neutralEmEnergyFraction();}},
+        {"chargedHadronEnergyFraction", [](T const &j){return j.chargedHadronEnergyFraction();}},
+        {"chargedEmEnergyFraction", [](T const &j){return j.chargedEmEnergyFraction();}},
+        {"muonEnergyFraction", [](T const &j){return j.muonEnergyFraction();}},
+        {"chargedMultiplicity", [](T const &j){return j.chargedMultiplicity();}},
+        {"neutralMultiplicity", [](T const &j){return j.neutralMultiplicity();}}
+    };
+    
+    if (not argument.empty())
+        return nullptr;
+    
+    auto const res = variables.find(name);
+    return (res != variables.end()) ? res->second : nullptr;
+}
+
+
+template<>
+function<double(reco::Vertex const &)> SelectorVariables<reco::Vertex>::Find(
+  string const &name, string const &argument)
+{
+    using T = reco::Vertex;
+    
+    // Both spellings of rho are accepted by StringCutObjectSelector as they are both defined in
+    //the ROOT::Math::PositionVector3D class
+    static map<string, function<double(T const &)>> const variables{
+        {"isFake", [](T const &v){return v.isFake();}},
+        {"isValid", [](T const &v){return v.isValid();}},
+        {"ndof", [](T const &v){return v.ndof();}},
+        {"chi2", [](T const &v){return v.chi2();}},
+        {"normalizedChi2", [](T const &v){return v.normalizedChi2();}},
+        {"tracksSize", [](T const &v){return v.tracksSize();}},
+        {"x", [](T const &v){return v.x();}},
+        {"y", [](T const &v){return v.y();}},
+        {"z", [](T const &v){return v.z();}},
+        {"position.rho", [](T const &v){return v.position().rho();}},
+        {"position.Rho", [](T const &v){return v.position().Rho();}},
+        {"position.z", [](T const &v){return v.position().z();}}
+    };
+    
+    if (not argument.empty())
+        return nullptr;
+    
+    auto const res = variables.find(name);
+    return (res != variables.end()) ? res->second : nullptr;
+}
@@ -0,0 +1,549 @@
+#pragma once
+
+#include <CommonTools/Utils/interface/StringCutObjectSelector.h>
+#include <DataFormats/Candidate/interface/Candidate.h>
+#include <DataFormats/PatCandidates/interface/Electron.h>
+#include <DataFormats/PatCandidates/interface/Jet.h>
+#include <DataFormats/PatCandidates/interface/Muon.h>
+#include <DataFormats/VertexReco/interface/Vertex.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+
+/**
+ * \struct SelectorVariables
+ * \brief Accessors to properties of objects of type T that can be used in CompiledSelector
+ * 
+ * Specializations are provided for reco::Candidate, pat::Electron, pat::Muon, pat::Jet, and
+ * reco::Vertex. Method Find returns an accessor for the given variable. The name of a variable can
+ * include several dot-separated components, as in "superCluster.eta". Some variables, such as
+ * "bDiscriminator", take a string argument. If the variable is not supported, an empty function is
+ * returned.
+ */
+template<typename T>
+struct SelectorVariables
+{
+    static std::function<double(T const &)> Find(std::string const &name,
+      std::string const &argument);
+};
+
+
+template<>
+std::function<double(reco::Candidate const &)> SelectorVariables<reco::Candidate>::Find(
+  std::string const &name, std::string const &argument);
+
+template<>
+std::function<double(pat::Electron const &)> SelectorVariables<pat::Electron>::Find(
+  std::string const &name, std::string const &argument);
+
+template<>
+std::function<double(pat::Muon const &)> SelectorVariables<pat::Muon>::Find(
+  std::string const &name, std::string const &argument);
+
+template<>
+std::function<double(pat::Jet const &)> SelectorVariables<pat::Jet>::Find(
+  std::string const &name, std::string const &argument);
+
+template<>
+std::function<double(reco::Vertex const &)> SelectorVariables<reco::Vertex>::Find(
+  std::string const &name, std::string const &argument);
+
+
+/**
+ * \class CompiledSelector
+ * \brief Drop-in replacement for StringCutObjectSelector that avoids reflection when possible
+ * 
+ * The selection string follows the grammar of StringCutObjectSelector [1]. At construction it is
+ * parsed once into a tree of expressions bound directly to accessors of type T, which are listed
+ * in SelectorVariables<T>. The tree is then evaluated for each object without any string lookups
+ * or reflection. Supported are numeric literals, variables, logical operators (&, &&, |, ||, !),
+ * comparisons, the four arithmetic operations, and functions abs, sqrt, min, and max. If the
+ * string uses anything else, for instance a method not known to SelectorVariables<T>, the
+ * selection is delegated to a StringCutObjectSelector, so the result is always the same as with
+ * the latter. Method IsCompiled tells which of the two is used. An empty string selects all
+ * objects.
+ * [1] https://twiki.cern.ch/twiki/bin/view/CMSPublic/SWGuidePhysicsCutParser
+ */
+template<typename T>
+class CompiledSelector
+{
+public:
+    /// Constructor from the selection string
+    CompiledSelector(std::string const &cut);
+    
+public:
+    /// Evaluates the selection for the given object
+    bool operator()(T const &object) const;
+    
+    /// Checks if the selection has been compiled or StringCutObjectSelector is used instead
+    bool IsCompiled() const;
+    
+private:
+    /// Compiled expression
+    using Expression = std::function<double(T const &)>;
+    
+    /**
+     * \class Parser
+     * \brief Recursive-descent parser that builds a compiled expression
+     * 
+     * Throws an exception of type std::runtime_error if the string cannot be compiled.
+     */
+    class Parser
+    {
+    public:
+        /// Constructor from the string to parse
+        Parser(std::string const &text);
+        
+    public:
+        /// Parses the whole string
+        Expression Parse();
+        
+    private:
+        /// Parses logical disjunction
+        Expression ParseOr();
+        
+        /// Parses logical conjunction
+        Expression ParseAnd();
+        
+        /**
+         * \brief Parses a logical factor, i.e. a comparison or its negation
+         * 
+         * As in StringCutObjectSelector, operator ! applies to a whole comparison and not only to
+         * the arithmetic expression next to it, so that "!abs(eta) < 2.5" is interpreted as
+         * "!(abs(eta) < 2.5)".
+         */
+        Expression ParseNot();
+        
+        /// Parses comparison
+        Expression ParseComparison();
+        
+        /// Parses addition and subtraction
+        Expression ParseSum();
+        
+        /// Parses multiplication and division
+        Expression ParseProduct();
+        
+        /// Parses unary arithmetic operators
+        Expression ParseUnary();
+        
+        /// Parses a literal, variable, function call, or an expression in parentheses
+        Expression ParsePrimary();
+        
+        /// Parses the name of a variable and its optional string argument
+        Expression ParseVariable();
+        
+        /// Parses an identifier
+        std::string ParseIdentifier();
+        
+        /// Consumes the given token if it is found at the current position
+        bool Accept(std::string const &token);
+        
+        /// Consumes the given token or throws an exception
+        void Expect(std::string const &token);
+        
+        /// Skips white spaces
+        void SkipSpaces();
+        
+        /// Throws an exception with the given message
+        [[noreturn]] void Fail(std::string const &message) const;
+        
+    private:
+        /// String to parse
+        std::string const &text;
+        
+        /// Current position in the string
+        std::string::size_type pos;
+    };
+    
+private:
+    /// Compiled expression, or an empty function if the fallback is used
+    Expression expression;
+    
+    /// Selector used if the string cannot be compiled
+    std::unique_ptr<StringCutObjectSelector<T>> fallback;
+};
+
+
+template<typename T>
+CompiledSelector<T>::CompiledSelector(std::string const &cut)
+{
+    try
+    {
+        expression = Parser(cut).Parse();
+    }
+    catch (std::runtime_error const &)
+    {
+        // This also checks the syntax and throws an exception if the string is malformed
+        fallback.reset(new StringCutObjectSelector<T>(cut));
+    }
+}
+
+
+template<typename T>
+bool CompiledSelector<T>::operator()(T const &object) const
+{
+    if (fallback)
+        return (*fallback)(object);
+    else
+        return (expression(object) != 0.);
+}
+
+
+template<typename T>
+bool CompiledSelector<T>::IsCompiled() const
+{
+    return not fallback;
+}
+
+
+template<typename T>
+CompiledSelector<T>::Parser::Parser(std::string const &text_):
+    text(text_),
+    pos(0)
+{}
+
+
+template<typename T>
+typename CompiledSelector<T>::Expression CompiledSelector<T>::Parser::Parse()
+{
+    SkipSpaces();
+    
+    if (pos == text.size())
+        return [](T const &){return 1.;};
+    
+    Expression const e = ParseOr();
+    SkipSpaces();
+    
+    if (pos != text.size())
+        Fail("Unexpected character");
+    
+    return e;
+}
+
+
+template<typename T>
+typename CompiledSelector<T>::Expression CompiledSelector<T>::Parser::ParseOr()
+{
+    Expression e = ParseAnd();
+    
+    while (Accept("||") or Accept("|"))
+    {
+        Expression const lhs = e, rhs = ParseAnd();
+        e = [lhs, rhs](T const &o){return double(lhs(o) != 0. or rhs(o) != 0.);};
+    }
+    
+    return e;
+}
+
+
+template<typename T>
+typename CompiledSelector<T>::Expression CompiledSelector<T>::Parser::ParseAnd()
+{
+    Expression e = ParseNot();
+    
+    while (Accept("&&") or Accept("&"))
+    {
+        Expression const lhs = e, rhs = ParseNot();
+        e = [lhs, rhs](T const &o){return double(lhs(o) != 0. and rhs(o) != 0.);};
+    }
+    
+    return e;
+}
+
+
+template<typename T>
+typename CompiledSelector<T>::Expression CompiledSelector<T>::Parser::ParseNot()
+{
+    if (Accept("!"))
+    {
+        Expression const operand = ParseNot();
+        return [operand](T const &o){return double(operand(o) == 0.);};
+    }
+    
+    return ParseComparison();
+}
+
+
+template<typename T>
+typename CompiledSelector<T>::Expression CompiledSelector<T>::Parser::ParseComparison()
+{
+    Expression const lhs = ParseSum();
+    
+    // Order matters since "<" is a prefix of "<="
+    if (Accept("<="))
+    {
+        Expression const rhs = ParseSum();
+        return [lhs, rhs](T const &o){return double(lhs(o) <= rhs(o));};
+    }
+    else if (Accept(">="))
+    {
+        Expression const rhs = ParseSum();
+        return [lhs, rhs](T const &o){return double(lhs(o) >= rhs(o));};
+    }
+    else if (Accept("=="))
+    {
+        Expression const rhs = ParseSum();
+        return [lhs, rhs](T const &o){return double(lhs(o) == rhs(o));};
+    }
+    else if (Accept("!="))
+    {
+        Expression const rhs = ParseSum();
+        return [lhs, rhs](T const &o){return double(lhs(o) != rhs(o));};
+    }
+    else if (Accept("<"))
+    {
+        Expression const rhs = ParseSum();
+        return [lhs, rhs](T const &o){return double(lhs(o) < rhs(o));};
+    }
+    else if (Accept(">"))
+    {
+        Expression const rhs = ParseSum();
+        return [lhs, rhs](T const &o){return double(lhs(o) > rhs(o));};
+    }
+    
+    return lhs;
+}
+
+
+template<typename T>
+typename CompiledSelector<T>::Expression CompiledSelector<T>::Parser::ParseSum()
+{
+    Expression e = ParseProduct();
+    
+    while (true)
+    {
+        if (Accept("+"))
+        {
+            Expression const lhs = e, rhs = ParseProduct();
+            e = [lhs, rhs](T const &o){return lhs(o) + rhs(o);};
+        }
+        else if (Accept("-"))
+        {
+            Expression const lhs = e, rhs = ParseProduct();
+            e = [lhs, rhs](T const &o){return lhs(o) - rhs(o);};
+        }
+        else
+            return e;
+    }
+}
+
+
+template<typename T>
+typename CompiledSelector<T>::Expression CompiledSelector<T>::Parser::ParseProduct()
+{
+    Expression e = ParseUnary();
+    
+    while (true)
+    {
+        if (Accept("*"))
+        {
+            Expression const lhs = e, rhs = ParseUnary();
+            e = [lhs, rhs](T const &o){return lhs(o) * rhs(o);};
+        }
+        else if (Accept("/"))
+        {
+            Expression const lhs = e, rhs = ParseUnary();
+            e = [lhs, rhs](T const &o){return lhs(o) / rhs(o);};
+        }
+        else
+            return e;
+    }
+}
+
+
+template<typename T>
+typename CompiledSelector<T>::Expression CompiledSelector<T>::Parser::ParseUnary()
+{
+    if (Accept("-"))
+    {
+        Expression const operand = ParseUnary();
+        return [operand](T const &o){return -operand(o);};
+    }
+    else if (Accept("+"))
+        return ParseUnary();
+    
+    return ParsePrimary();
+}
+
+
+template<typename T>
+typename CompiledSelector<T>::Expression CompiledSelector<T>::Parser::ParsePrimary()
+{
+    SkipSpaces();
+    
+    if (pos == text.size())
+        Fail("Unexpected end of string");
+    
+    char const c = text[pos];
+    
+    
+    // Expression in parentheses
+    if (c == '(')
+    {
+        ++pos;
+        Expression const e = ParseOr();
+        Expect(")");
+        return e;
+    }
+    
+    
+    // Numeric literal
+    if (std::isdigit(c) or c == '.')
+    {
+        char const *begin = text.c_str() + pos;
+        char *end;
+        double const value = std::strtod(begin, &end);
+        pos += end - begin;
+        return [value](T const &){return value;};
+    }
+    
+    
+    // Functions. Make sure that a variable whose name starts with the name of a function is not
+    //mistaken for it
+    auto const savedPos = pos;
+    std::string const name = (std::isalpha(c) or c == '_') ? ParseIdentifier() : "";
+    
+    if (name == "abs" or name == "sqrt" or name == "min" or name == "max")
+    {
+        SkipSpaces();
+        
+        if (Accept("("))
+        {
+            Expression const arg1 = ParseOr();
+            
+            if (name == "abs")
+            {
+                Expect(")");
+                return [arg1](T const &o){return std::abs(arg1(o));};
+            }
+            else if (name == "sqrt")
+            {
+                Expect(")");
+                return [arg1](T const &o){return std::sqrt(arg1(o));};
+            }
+            
+            Expect(",");
+            Expression const arg2 = ParseOr();
+            Expect(")");
+            
+            if (name == "min")
+                return [arg1, arg2](T const &o){return std::min(arg1(o), arg2(o));};
+            else
+                return [arg1, arg2](T const &o){return std::max(arg1(o), arg2(o));};
+        }
+    }
+    
+    
+    // Variables
+    pos = savedPos;
+    return ParseVariable();
+}
+
+
+template<typename T>
+typename CompiledSelector<T>::Expression CompiledSelector<T>::Parser::ParseVariable()
+{
+    std::string name, argument;
+    
+    // The name consists of dot-separated components, each of which can be followed by empty
+    //parentheses. Only the last component can have a string argument
+    while (true)
+    {
+        name += ParseIdentifier();
+        SkipSpaces();
+        
+        if (Accept("("))
+        {
+            SkipSpaces();
+            
+            if (pos < text.size() and (text[pos] == '"' or text[pos] == '\''))
+            {
+                char const quote = text[pos];
+                auto const end = text.find(quote, pos + 1);
+                
+                if (end == std::string::npos)
+                    Fail("Unterminated string");
+                
+                argument = text.substr(pos + 1, end - pos - 1);
+                pos = end + 1;
+            }
+            
+            Expect(")");
+        }
+        
+        if (not argument.empty() or text.compare(pos, 1, ".") != 0)
+            break;
+        
+        ++pos;
+        name += '.';
+    }
+    
+    auto const accessor = SelectorVariables<T>::Find(name, argument);
+    
+    if (not accessor)
+        Fail("Unknown variable \"" + name + "\"");
+    
+    return accessor;
+}
+
+
+template<typename T>
+std::string CompiledSelector<T>::Parser::ParseIdentifier()
+{
+    SkipSpaces();
+    auto const start = pos;
+    
+    while (pos < text.size() and (std::isalnum(text[pos]) or text[pos] == '_'))
+        ++pos;
+    
+    if (pos == start or std::isdigit(text[start]))
+        Fail("Identifier expected");
+    
+    return text.substr(start, pos - start);
+}
+
+
+template<typename T>
+bool CompiledSelector<T>::Parser::Accept(std::string const &token)
+{
+    SkipSpaces();
+    
+    if (text.compare(pos, token.size(), token) == 0)
+    {
+        pos += token.size();
+        return true;
+    }
+    
+    return false;
+}
+
+
+template<typename T>
+void CompiledSelector<T>::Parser::Expect(std::string const &token)
+{
+    if (not Accept(token))
+        Fail("\"" + token + "\" expected");
+}
+
+
+template<typename T>
+void CompiledSelector<T>::Parser::SkipSpaces()
+{
+    while (pos < text.size() and std::isspace(text[pos]))
+        ++pos;
+}
+
+
+template<typename T>
+void CompiledSelector<T>::Parser::Fail(std::string const &message) const
+{
+    throw std::runtime_error("CompiledSelector: " + message + " at position " +
+      std::to_string(pos) + " in \"" + text + "\".");
+}
@@ -3,46 +3,11 @@
 #include <DataFormats/Common/interface/View.h>
 #include <FWCore/Utilities/interface/InputTag.h>
 #include <FWCore/Framework/interface/MakerMacros.h>
+#include <FWCore/Utilities/interface/EDMException.h>
 
 #include <TTree.h>
 
 
-SignedKahanSum::SignedKahanSum() noexcept:
-    posSum(0.), negSum(0.),
-    posCompensation(0.), negCompensation(0.)
-{}
-
-
-void SignedKahanSum::Fill(double x)
-{
-    if (x >= 0.)
-    {
-        double const xCompensated = x - posCompensation;
-        double const sum = posSum + xCompensated;
-        posCompensation = (sum - posSum) - xCompensated;
-        posSum = sum;
-    }
-    else
-    {
-        // Run the standard Kahan algorithm with the inverted input
-        x = -x;
-        
-        double const xCompensated = x - negCompensation;
-        double const sum = negSum + xCompensated;
-        negCompensation = (sum - negSum) - xCompensated;
-        negSum = sum;
-    }
-}
-
-
-double SignedKahanSum::GetSum() const
-{
-    // Since there might be a catastrophic cancellation between the positive and negative sums,
-    //take into account also the correction from the compensations
-    return (posSum - negSum) - (posCompensation - negCompensation);
-}
-
-
 EventCounter::EventCounter(edm::ParameterSet const &cfg):
     lheWeightIndices(cfg.getParameter<std::vector<int>>("saveAltLHEWeights")),
     psWeightIndices(cfg.getParameter<std::vector<int>>("saveAltPSWeights")),
@@ -63,17 +28,21 @@ EventCounter::EventCounter(edm::ParameterSet const &cfg):
 }
 
 
-void EventCounter::analyze(edm::Event const &event, edm::EventSetup const &)
+void EventCounter::analyze(edm::StreamID streamID, edm::Event const &event,
+  edm::EventSetup const &) const
 {
+    EventCounterStreamSums &sums = *streamCache(streamID);
+    
+    
     // Update event counter
-    ++nEventProcessed;
+    ++sums.nEventProcessed;
     
     
     // Update the sum of nominal event weights
     edm::Handle<GenEventInfoProduct> generator;
     event.getByToken(generatorToken, generator);
     
-    sumNominalWeight.Fill(generator->weight());
+    sums.sumNominalWeight.Fill(generator->weight());
     
     
     // Update sums of alternative LHE event weights if requested
@@ -85,9 +54,10 @@ void EventCounter::analyze(edm::Event const &event, edm::EventSetup const &)
         std::vector<gen::WeightsInfo> const &altWeights = lheEventInfo->weights();
         
         
-        // If this is the first event being processed, create summators for the alternative weights
-        if (sumAltLheWeightCollection.empty())
-            sumAltLheWeightCollection.resize(
+        // If this is the first event processed in the stream, create summators for the alternative
+        //weights
+        if (sums.sumAltLheWeightCollection.empty())
+            sums.sumAltLheWeightCollection.resize(
               lheWeightIndices.NumberIndices(0, altWeights.size() - 1));
         
         
@@ -98,12 +68,9 @@ void EventCounter::analyze(edm::Event const &event, edm::EventSetup const &)
         
         unsigned writeIndex = 0;
 
-        for (int readIndex: lheWeightIndices.GetIndices(0, altWeights.size() - 1))
-        {
-            double const weight = altWeights[readIndex].wgt * factor;
-            sumAltLheWeightCollection[writeIndex].Fill(weight);
-            ++writeIndex;
-        }
+        for (auto const &range: lheWeightIndices.GetRanges(0, int(altWeights.size()) - 1))
+            for (int readIndex = range.first; readIndex <= range.second; ++readIndex, ++writeIndex)
+                sums.sumAltLheWeightCollection[writeIndex].Fill(altWeights[readIndex].wgt * factor);
     }
 
 
@@ -112,19 +79,18 @@ void EventCounter::analyze(edm::Event const &event, edm::EventSetup const &)
 
     if (not psWeightIndices.Empty() and psWeights.size() > 1)
     {
-        // If this is the first event being processed, create summators for the alternative weights
-        if (sumAltPsWeightCollection.empty())
-            sumAltPsWeightCollection.resize(
+        // If this is the first event processed in the stream, create summators for the alternative
+        //weights
+        if (sums.sumAltPsWeightCollection.empty())
+            sums.sumAltPsWeightCollection.resize(
               psWeightIndices.NumberIndices(0, psWeights.size() - 1));
         
         
         unsigned writeIndex = 0;
 
-        for (int readIndex: psWeightIndices.GetIndices(0, psWeights.size() - 1))
-        {
-            sumAltPsWeightCollection[writeIndex].Fill(psWeights[readIndex]);
-            ++writeIndex;
-        }
+        for (auto const &range: psWeightIndices.GetRanges(0, int(psWeights.size()) - 1))
+            for (int readIndex = range.first; readIndex <= range.second; ++readIndex, ++writeIndex)
+                sums.sumAltPsWeightCollection[writeIndex].Fill(psWeights[readIndex]);
     }
     
     
@@ -134,7 +100,7 @@ void EventCounter::analyze(edm::Event const &event, edm::EventSetup const &)
         edm::Handle<edm::View<PileupSummaryInfo>> puSummary;
         event.getByToken(puSummaryToken, puSummary);
         
-        pileupProfile->Fill(puSummary->front().getTrueNumInteractions());
+        sums.pileupProfile->Fill(puSummary->front().getTrueNumInteractions());
     }
 }
 
@@ -146,6 +112,24 @@ void EventCounter::beginJob()
 }
 
 
+std::unique_ptr<EventCounterStreamSums> EventCounter::beginStream(edm::StreamID) const
+{
+    auto sums = std::make_unique<EventCounterStreamSums>();
+    
+    
+    // The partial pileup profile reuses the binning of the output histogram. It must not be
+    //attached to any directory as it is owned by the cache
+    if (not puSummaryToken.isUninitialized())
+    {
+        sums->pileupProfile.reset(dynamic_cast<TH1D *>(pileupProfile->Clone()));
+        sums->pileupProfile->SetDirectory(nullptr);
+        sums->pileupProfile->Reset();
+    }
+    
+    return sums;
+}
+
+
 void EventCounter::endJob()
 {
     TTree *tree = fileService->make<TTree>("EventCounts", "Event counts and weights");
@@ -183,6 +167,23 @@ void EventCounter::endJob()
 }
 
 
+void EventCounter::endStream(edm::StreamID streamID) const
+{
+    EventCounterStreamSums const &sums = *streamCache(streamID);
+    std::lock_guard<std::mutex> lock(mergeMutex);
+    
+    nEventProcessed += sums.nEventProcessed;
+    sumNominalWeight.Merge(sums.sumNominalWeight);
+    
+    
+    MergeSums(sumAltLheWeightCollection, sums.sumAltLheWeightCollection);
+    MergeSums(sumAltPsWeightCollection, sums.sumAltPsWeightCollection);
+    
+    if (sums.pileupProfile)
+        pileupProfile->Add(sums.pileupProfile.get());
+}
+
+
 void EventCounter::fillDescriptions(edm::ConfigurationDescriptions &descriptions)
 {
     edm::ParameterSetDescription desc;
@@ -203,4 +204,27 @@ void EventCounter::fillDescriptions(edm::ConfigurationDescriptions &descriptions
 }
 
 
+void EventCounter::MergeSums(std::vector<SignedKahanSum> &totalSums,
+  std::vector<SignedKahanSum> const &streamSums)
+{
+    // Summators are only created in a stream once it has processed an event
+    if (streamSums.empty())
+        return;
+    
+    if (totalSums.empty())
+        totalSums.resize(streamSums.size());
+    
+    if (totalSums.size() != streamSums.size())
+    {
+        edm::Exception excp(edm::errors::LogicError);
+        excp << "Numbers of alternative weights differ between streams: " << totalSums.size() <<
+          " vs " << streamSums.size() << ".";
+        excp.raise();
+    }
+    
+    for (unsigned i = 0; i < totalSums.size(); ++i)
+        totalSums[i].Merge(streamSums[i]);
+}
+
+
 DEFINE_FWK_MODULE(EventCounter);
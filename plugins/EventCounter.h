@@ -1,8 +1,9 @@
 #pragma once
 
 #include "IndexIntervals.h"
+#include "SignedKahanSum.h"
 
-#include <FWCore/Framework/interface/EDAnalyzer.h>
+#include <FWCore/Framework/interface/global/EDAnalyzer.h>
 #include <FWCore/Framework/interface/Event.h>
 #include <FWCore/ParameterSet/interface/ParameterSet.h>
 #include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
@@ -17,38 +18,43 @@
 
 #include <TH1D.h>
 
+#include <memory>
+#include <mutex>
 #include <vector>
 
 
 /**
- * \class SignedKahanSum
- * \brief Implements compensated summation for positive and negative numbers separately
- * 
- * This class computes a sum of the given sequence of numbers on the fly. It tries to compensate
- * for errors arising from the floating-point arithmetic using the Kahan summation algorithm [1].
- * Summation is done independently for positive and negative numbers in order to prevent a
- * catastrophic cancellation.
- * [1] https://en.wikipedia.org/wiki/Kahan_summation_algorithm
+ * \struct EventCounterStreamSums
+ * \brief Event counts and sums of weights accumulated in a single stream
  */
-class SignedKahanSum
+struct EventCounterStreamSums
 {
-public:
-    /// Trivial constructor
-    SignedKahanSum() noexcept;
+    /// Number of events processed in the stream
+    ULong64_t nEventProcessed = 0;
     
-public:
-    /// Adds a new number to the sum
-    void Fill(double x);
+    /// Sum of nominal weights
+    SignedKahanSum sumNominalWeight;
     
-    /// Returns the current sum
-    double GetSum() const;
+    /**
+     * \brief Sums of alternative LHE weights
+     * 
+     * The vector is initialized when the first event in the stream is processed.
+     */
+    std::vector<SignedKahanSum> sumAltLheWeightCollection;
     
-private:
-    /// Current sums of positive and negative numbers
-    double posSum, negSum;
+    /**
+     * \brief Sums of alternative PS weights
+     * 
+     * The vector is initialized when the first event in the stream is processed.
+     */
+    std::vector<SignedKahanSum> sumAltPsWeightCollection;
     
-    /// Compensation values for the two sums, which are used in the Kahan algorithm
-    double posCompensation, negCompensation;
+    /**
+     * \brief Partial pileup profile
+     * 
+     * The histogram is not attached to any directory. Null if pileup profile is not requested.
+     */
+    std::unique_ptr<TH1D> pileupProfile;
 };
 
 
@@ -68,27 +74,44 @@ private:
  * before any filters.
  * 
  * Computation of mean weights is implemented with the help of the compensated summation algorithm
- * provided by class SignedKahanSum.
+ * provided by class SignedKahanSum. Each stream accumulates its own sums and pileup profile, and
+ * they are merged into the totals at the end of the stream.
  */
-class EventCounter: public edm::EDAnalyzer
+class EventCounter: public edm::global::EDAnalyzer<edm::StreamCache<EventCounterStreamSums>>
 {
 public:
     /// Constructor
     EventCounter(edm::ParameterSet const &cfg);
     
 public:
-    /// Updates event counter and sums of event weights
-    virtual void analyze(edm::Event const &event, edm::EventSetup const &) override;
+    /// Updates event counter and sums of event weights in the given stream
+    virtual void analyze(edm::StreamID streamID, edm::Event const &event, edm::EventSetup const &)
+      const override;
     
     /// Creates histogram for pileup profile if needed
     virtual void beginJob() override;
     
+    /// Creates summators for a new stream
+    virtual std::unique_ptr<EventCounterStreamSums> beginStream(edm::StreamID) const override;
+    
     /// Saves output in a trivial tree
     virtual void endJob() override;
     
+    /// Adds sums accumulated in the given stream to the totals
+    virtual void endStream(edm::StreamID streamID) const override;
+    
     /// Verifies configuration of the plugin
     static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
     
+private:
+    /**
+     * \brief Adds sums of alternative weights from a stream to the totals
+     * 
+     * The totals are created if needed. Throws an exception if the numbers of weights differ.
+     */
+    static void MergeSums(std::vector<SignedKahanSum> &totalSums,
+      std::vector<SignedKahanSum> const &streamSums);
+    
 private:
     /// Token to access global generator information
     edm::EDGetTokenT<GenEventInfoProduct> generatorToken;
@@ -109,25 +132,28 @@ private:
      */
     edm::EDGetTokenT<edm::View<PileupSummaryInfo>> puSummaryToken;
     
-    /// Running number of processed events
-    ULong64_t nEventProcessed;
+    /// Mutex to protect the totals below when they are updated at the end of a stream
+    mutable std::mutex mergeMutex;
+    
+    /// Total number of processed events
+    mutable ULong64_t nEventProcessed;
     
     /// Sum of nominal weights of processed events
-    SignedKahanSum sumNominalWeight;
+    mutable SignedKahanSum sumNominalWeight;
     
     /**
      * \brief Sums of alternative LHE weights, for each type of weight
      * 
-     * This vector is reinitialized when the first event is processed.
+     * This vector is initialized when sums from the first stream are merged.
      */
-    std::vector<SignedKahanSum> sumAltLheWeightCollection;
+    mutable std::vector<SignedKahanSum> sumAltLheWeightCollection;
     
     /**
      * \brief Sums of alternative PS weights, for each type of weight
      * 
-     * This vector is reinitialized when the first event is processed.
+     * This vector is initialized when sums from the first stream are merged.
      */
-    std::vector<SignedKahanSum> sumAltPsWeightCollection;
+    mutable std::vector<SignedKahanSum> sumAltPsWeightCollection;
     
     /**
      * \brief Non-owning pointer to a histogram with pileup profile
@@ -6,7 +6,6 @@
 
 
 EventFlags::FlagInfo::FlagInfo(std::string const &name):
-    index(-1),
     decision(false)
 {
     auto const delimPos = name.find(':');
@@ -25,7 +24,6 @@ EventFlags::FlagInfo::FlagInfo(std::string const &name):
 
 
 EventFlags::EventFlags(edm::ParameterSet const &cfg):
-    indicesSetup(false),
     tree(nullptr)
 {
     flagToken = consumes<edm::TriggerResults>(cfg.getParameter<edm::InputTag>("src"));
@@ -49,14 +47,18 @@ void EventFlags::fillDescriptions(edm::ConfigurationDescriptions &descriptions)
 }
 
 
-void EventFlags::analyze(edm::Event const &event, edm::EventSetup const &eventSetup)
+void EventFlags::analyze(edm::StreamID streamID, edm::Event const &event,
+  edm::EventSetup const &eventSetup) const
 {
-    // Read flags for the current event. If this is the first event, find indices correspoinding
-    //to the selected flags.
+    auto &buffers = *streamCache(streamID);
+    
+    
+    // Read flags for the current event. If this is the first event in the stream, find indices
+    //correspoinding to the selected flags.
     edm::Handle<edm::TriggerResults> flags;
     event.getByToken(flagToken, flags);
     
-    if (not indicesSetup)
+    if (not buffers.indicesSetup)
     {
         edm::TriggerNames const &flagNames = event.triggerNames(*flags);
         unsigned const nFlags = flagNames.size();
@@ -72,27 +74,57 @@ void EventFlags::analyze(edm::Event const &event, edm::EventSetup const &eventSe
                 excp.raise();
             }
             else
-                flagInfos[i].index = i;
+                buffers.indices[i] = index;
         }
         
-        indicesSetup = true;
+        buffers.indicesSetup = true;
     }
     
     
-    // Read and store flag values
-    for (auto &flagInfo: flagInfos)
-        flagInfo.decision = flags->accept(flagInfo.index);
+    // Read flag values
+    for (unsigned i = 0; i < flagInfos.size(); ++i)
+        buffers.decisions[i] = flags->accept(buffers.indices[i]);
     
-    tree->Fill();
+    treeFillService->Commit(this, streamID);
 }
 
 
 void EventFlags::beginJob()
 {
-    tree = fileService->make<TTree>("EventFlags", "Selected flags");
+    tree = treeFillService->BookTree(this, "EventFlags", "Selected flags");
     
     for (auto &info: flagInfos)
-        tree->Branch(info.branchName.c_str(), &info.decision);
+        tree->Branch(BranchName(info.branchName).c_str(), &info.decision);
+}
+
+
+std::unique_ptr<EventFlagsStreamBuffers> EventFlags::beginStream(edm::StreamID) const
+{
+    auto buffers = std::make_unique<EventFlagsStreamBuffers>();
+    buffers->indices.resize(flagInfos.size());
+    buffers->decisions.resize(flagInfos.size());
+    return buffers;
+}
+
+
+void EventFlags::AllocateSlots(unsigned numSlots)
+{
+    stagedDecisions.assign(numSlots, std::vector<Bool_t>(flagInfos.size()));
+}
+
+
+void EventFlags::StageEntry(edm::StreamID streamID, unsigned slot)
+{
+    stagedDecisions[slot] = streamCache(streamID)->decisions;
+}
+
+
+void EventFlags::MoveToTree(unsigned slot)
+{
+    auto const &decisions = stagedDecisions[slot];
+    
+    for (unsigned i = 0; i < flagInfos.size(); ++i)
+        flagInfos[i].decision = decisions[i];
 }
 
 
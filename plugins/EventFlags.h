@@ -1,21 +1,44 @@
 #pragma once
 
-#include <FWCore/Framework/interface/EDAnalyzer.h>
+#include "TreeFillService.h"
+
+#include <FWCore/Framework/interface/global/EDAnalyzer.h>
 #include <FWCore/Framework/interface/Event.h>
 #include <FWCore/ParameterSet/interface/ParameterSet.h>
 #include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
 #include <FWCore/ParameterSet/interface/ParameterSetDescription.h>
 
-#include <CommonTools/UtilAlgos/interface/TFileService.h>
 #include <DataFormats/Common/interface/TriggerResults.h>
 #include <FWCore/ServiceRegistry/interface/Service.h>
 
 #include <TTree.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 
 
+/**
+ * \struct EventFlagsStreamBuffers
+ * \brief Indices and decisions of selected flags in a single stream
+ */
+struct EventFlagsStreamBuffers
+{
+    /**
+     * \brief Flag showing whether indices to access flags have been set up
+     * 
+     * It is assumed that the indices do not change throughout the whole job.
+     */
+    bool indicesSetup = false;
+    
+    /// Indices of selected flags in TriggerResults
+    std::vector<unsigned> indices;
+    
+    /// Decisions of selected flags in the current event
+    std::vector<Bool_t> decisions;
+};
+
+
 /**
  * \class EventFlags
  * \brief Stores boolean values of selected flags
@@ -25,8 +48,12 @@
  * FlagName is the name of the flag in TriggerResults and BranchName is the desired name for the
  * TTree branch to store this flag; if the colon is not found in the string, the string is used as
  * both FlagName and BranchName.
+ * 
+ * Decisions are read into buffers of the current stream. Each stream looks up indices of the flags
+ * in edm::TriggerResults with its first event.
  */
-class EventFlags: public edm::EDAnalyzer
+class EventFlags: public edm::global::EDAnalyzer<edm::StreamCache<EventFlagsStreamBuffers>>,
+  public TreeFillService::Client
 {
 private:
     /// Auxiliary structure to aggregate information about a flag
@@ -46,9 +73,6 @@ private:
         /// Name for the corresponding branch in the output tree
         std::string branchName;
         
-        /// Index of the flag in TriggerResults
-        unsigned index;
-        
         /// Buffer for the tree to write flag decision in each event
         Bool_t decision;
     };
@@ -62,33 +86,42 @@ public:
     static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
     
 private:
-    /// Fills the output tree with flags for the current event
-    virtual void analyze(edm::Event const &event, edm::EventSetup const &eventSetup) override;
+    /// Reads flags for the current event into buffers of the stream
+    virtual void analyze(edm::StreamID streamID, edm::Event const &event,
+      edm::EventSetup const &eventSetup) const override;
     
-    /// Creates the output tree
+    /// Creates the output tree and registers it in TreeFillService
     virtual void beginJob() override;
     
+    /// Creates buffers for the given stream
+    virtual std::unique_ptr<EventFlagsStreamBuffers> beginStream(edm::StreamID) const override;
+    
+    /// Allocates buffers for staging slots of TreeFillService
+    virtual void AllocateSlots(unsigned numSlots) override;
+    
+    /// Copies decisions from buffers of the given stream into the given staging slot
+    virtual void StageEntry(edm::StreamID streamID, unsigned slot) override;
+    
+    /// Copies decisions from the given staging slot into buffers of the output tree
+    virtual void MoveToTree(unsigned slot) override;
+    
 private:
     /// Token to access precomputed flags
     edm::EDGetTokenT<edm::TriggerResults> flagToken;
     
-    /// Names and indices of selected flags
+    /// Names of selected flags
     std::vector<FlagInfo> flagInfos;
     
-    /**
-     * \brief Flag showing whether indices to access flags have been set up
-     * 
-     * It is assumed that the indices do not change throughout the whole job.
-     */
-    bool indicesSetup;
-    
-    /// An object to handle the output ROOT file
-    edm::Service<TFileService> fileService;
+    /// Service that fills the output tree
+    edm::Service<TreeFillService> treeFillService;
     
     /**
      * \brief The output tree
      * 
-     * The tree is managed by the fileService object.
+     * The tree is managed by TFileService.
      */
     TTree *tree;
+    
+    /// Decisions in events queued for writing, indexed with staging slot
+    std::vector<std::vector<Bool_t>> stagedDecisions;
 };
@@ -9,12 +9,10 @@
 #include <TTree.h>
 
 #include <boost/algorithm/string/predicate.hpp>
-#include <boost/regex.hpp>
 
-#include <algorithm>
-#include <fstream>
 #include <memory>
 #include <list>
+#include <stdexcept>
 #include <utility>
 
 
@@ -32,6 +30,19 @@ EventIDFilter::EventIDFilter(ParameterSet const &cfg):
         ReadTextFile(eventListFileName);
     else if (boost::ends_with(eventListFileName, ".root"))
         ReadROOTFile(eventListFileName);
+    else if (boost::ends_with(eventListFileName, ".evl"))
+    {
+        try
+        {
+            binaryEvents.reset(new BinaryEventList(eventListFileName));
+        }
+        catch (runtime_error const &e)
+        {
+            Exception excp(errors::LogicError);
+            excp << e.what() << '\n';
+            excp.raise();
+        }
+    }
     else
     {
         Exception excp(errors::LogicError);
@@ -41,9 +52,9 @@ EventIDFilter::EventIDFilter(ParameterSet const &cfg):
     }
     
     
-    // Sort the collection of event IDs read from the file. This is needed to improve the
-    //performance of the lookup
-    sort(knownEvents.begin(), knownEvents.end());
+    // Put the event IDs read from the file into the lookup table. Nothing is added to it if the
+    //binary format is used
+    knownEvents.Build();
 }
 
 
@@ -51,7 +62,8 @@ void EventIDFilter::fillDescriptions(ConfigurationDescriptions &descriptions)
 {
     ParameterSetDescription desc;
     desc.add<FileInPath>("eventListFile")->
-     setComment("Name of a text file containing a list of events.");
+     setComment("Name of a file containing a list of events. Supported formats are text (.txt), "
+     "ROOT (.root), and binary (.evl).");
     desc.add<bool>("rejectKnownEvents", false)->
      setComment("Determines whether a known event is kept or rejected.");
     
@@ -59,11 +71,13 @@ void EventIDFilter::fillDescriptions(ConfigurationDescriptions &descriptions)
 }
 
 
-bool EventIDFilter::filter(Event &event, EventSetup const &)
+bool EventIDFilter::filter(StreamID, Event &event, EventSetup const &) const
 {
-    // Check if ID of the current event is present in the collection. Profit from the fact that the
-    //collection is sorted
-    bool const eventKnown = binary_search(knownEvents.begin(), knownEvents.end(), event.id());
+    // Check if ID of the current event is present in the collection
+    EventID const &id = event.id();
+    bool const eventKnown = (binaryEvents) ?
+     binaryEvents->Contains(id.run(), id.luminosityBlock(), id.event()) :
+     knownEvents.Contains(id.run(), id.luminosityBlock(), id.event());
     
     
     return rejectKnownEvents xor eventKnown;
@@ -72,49 +86,16 @@ bool EventIDFilter::filter(Event &event, EventSetup const &)
 
 void EventIDFilter::ReadTextFile(string const &fileName)
 {
-    // Open the given text file with event IDs
-    ifstream eventListFile(fileName);
-    
-    if (not eventListFile.good())
+    try
     {
-        Exception excp(errors::FileOpenError);
-        excp << "Cannot open file \"" << fileName << "\".\n";
-        excp.raise();
+        knownEvents.ReadTextFile(fileName);
     }
-    
-    
-    // Read IDs from the file. Lines are parsed with the help of a regular expression
-    string line;
-    boost::regex eventIDRegex("^(\\d+):(\\d+):(\\d+)$", boost::regex::extended);
-    boost::smatch matchResults;
-    
-    while (true)
+    catch (runtime_error const &e)
     {
-        // Read the next line from the input file
-        getline(eventListFile, line);
-        
-        if (eventListFile.eof() or line.length() == 0)
-            break;
-        
-        
-        // Extract the event ID from the line and add it to the collection
-        if (not boost::regex_match(line, matchResults, eventIDRegex))
-        {
-            Exception excp(errors::LogicError);
-            excp << "Failed to parse line\n  \"" << line << "\"\nof input file \"" << fileName <<
-             "\". The file format seems to be wrong.\n";
-            excp.raise();
-        }
-        
-        unsigned long const run = stol(matchResults[1]);
-        unsigned long const lumiSection = stol(matchResults[2]);
-        unsigned long long const event = stoll(matchResults[3]);
-        
-        knownEvents.emplace_back(run, lumiSection, event);
+        Exception excp(errors::LogicError);
+        excp << e.what() << '\n';
+        excp.raise();
     }
-    
-    
-    eventListFile.close();
 }
 
 
@@ -208,7 +189,17 @@ void EventIDFilter::ReadROOTFile(string const &fileName)
     for (unsigned long ev = 0; ev < nEntries; ++ev)
     {
         eventListTree->GetEntry(ev);
-        knownEvents.emplace_back(run, lumiSection, event);
+        
+        try
+        {
+            knownEvents.Add(run, lumiSection, event);
+        }
+        catch (runtime_error const &e)
+        {
+            Exception excp(errors::LogicError);
+            excp << "In file \"" << fileName << "\": " << e.what() << '\n';
+            excp.raise();
+        }
     }
 }
 
@@ -1,13 +1,14 @@
 #pragma once
 
-#include <FWCore/Framework/interface/EDFilter.h>
+#include "BinaryEventList.h"
+#include "EventIDSet.h"
+
+#include <FWCore/Framework/interface/global/EDFilter.h>
 #include <FWCore/Framework/interface/Event.h>
 #include <FWCore/ParameterSet/interface/ParameterSet.h>
 #include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
 
-#include <DataFormats/Provenance/interface/EventID.h>
-
-#include <vector>
+#include <memory>
 #include <string>
 
 
@@ -17,16 +18,21 @@
  * 
  * Depending on the configuration, keeps or rejects events whose IDs are found in the collection.
  * The collection is read from a text or a ROOT file. Their formats are described in the
- * documentation for methods ReadTextFile and ReadROOTFile.
+ * documentation for methods ReadTextFile and ReadROOTFile. Event IDs are stored in an EventIDSet,
+ * so that lists of millions of events are read quickly and looked up in constant time.
+ * 
+ * Alternatively, the collection can be given in the binary format described in BinaryEventList,
+ * which is recognized by extension ".evl" and produced by script convertEventList.py. Such a file
+ * is memory-mapped instead of being read, which reduces the start-up time and allows processes
+ * running on the same machine to share a single copy of the list.
  */
-class EventIDFilter: public edm::EDFilter
+class EventIDFilter: public edm::global::EDFilter<>
 {
 public:
     /**
      * \brief Constructor
      * 
-     * Reads the configuration. Reads the input file with event IDs, stores them in a vector, and
-     * sorts it.
+     * Reads the configuration. Reads the input file with event IDs and builds the lookup table.
      */
     EventIDFilter(edm::ParameterSet const &cfg);
     
@@ -35,14 +41,15 @@ public:
     static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
     
     /// Performs event filtering based on ID of the current event
-    virtual bool filter(edm::Event &event, edm::EventSetup const &) override;
+    virtual bool filter(edm::StreamID, edm::Event &event, edm::EventSetup const &) const override;
     
 private:
     /**
      * \brief Reads a collection of event IDs from a text file
      * 
-     * Event IDs must be stored in the form "run:lumi:event", one per line. No blank lines or
-     * comments are allowed. If method fails to parse the file, it throws an exception.
+     * Event IDs must be stored in the form "run:lumi:event", one per line. No comments are
+     * allowed, and reading stops at the first empty line. If method fails to parse the file, it
+     * throws an exception. Parsing is done by EventIDSet::ReadTextFile.
      */
     void ReadTextFile(std::string const &fileName);
     
@@ -56,14 +63,11 @@ private:
     void ReadROOTFile(std::string const &fileName);
     
 private:
-    /**
-     * \brief Collection of event IDs read from the input file
-     * 
-     * The vector will be sorted before the first event is checked. Use a vector instead of a set
-     * because lookup in an ordered vector is at least as fast as in a set, while insertion is
-     * much faster.
-     */
-    std::vector<edm::EventID> knownEvents;
+    /// Collection of event IDs read from the input file
+    EventIDSet knownEvents;
+    
+    /// Memory-mapped collection of event IDs, used instead of knownEvents for binary files
+    std::unique_ptr<BinaryEventList> binaryEvents;
     
     /// Determines if events present in the container should be kept or rejected
     bool rejectKnownEvents;
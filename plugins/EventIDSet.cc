@@ -0,0 +1,249 @@
+#include "EventIDSet.h"
+
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+
+std::size_t const EventIDSet::blockSize;
+
+
+EventIDSet::EventIDSet() noexcept:
+    mask(0),
+    numElements(0)
+{}
+
+
+void EventIDSet::Add(unsigned long run, unsigned long lumi, unsigned long long event)
+{
+    if (run == 0)
+        throw std::runtime_error("EventIDSet::Add: Run number 0 is not allowed.");
+    
+    pending.push_back({std::uint32_t(run), std::uint32_t(lumi), event});
+}
+
+
+void EventIDSet::ReadTextFile(std::string const &fileName)
+{
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> file(std::fopen(fileName.c_str(), "rb"),
+      &std::fclose);
+    
+    if (not file)
+        throw std::runtime_error("EventIDSet::ReadTextFile: Cannot open file \"" + fileName +
+          "\".");
+    
+    
+    // The file is read in blocks. Unparsed data, i.e. the beginning of a line whose end has not
+    //been read yet, are moved to the front of the buffer before the next block is read
+    std::vector<char> buffer(blockSize);
+    std::size_t begin = 0, end = 0;
+    bool endOfFile = false;
+    unsigned long lineNumber = 0;
+    
+    while (true)
+    {
+        char const *lineBegin = buffer.data() + begin;
+        char const *lineEnd = static_cast<char const *>(
+          std::memchr(lineBegin, '\n', end - begin));
+        
+        if (not lineEnd)
+        {
+            if (endOfFile)
+            {
+                // The last line might not be terminated with a newline
+                if (begin == end)
+                    break;
+                
+                lineEnd = buffer.data() + end;
+            }
+            else
+            {
+                if (begin == 0 and end == buffer.size())
+                {
+                    std::ostringstream message;
+                    message << "EventIDSet::ReadTextFile: Line " << lineNumber + 1 <<
+                      " in file \"" << fileName << "\" is too long.";
+                    throw std::runtime_error(message.str());
+                }
+                
+                std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+                end -= begin;
+                begin = 0;
+                
+                end += std::fread(buffer.data() + end, 1, buffer.size() - end, file.get());
+                
+                if (end < buffer.size())
+                {
+                    if (std::ferror(file.get()))
+                        throw std::runtime_error("EventIDSet::ReadTextFile: Failed to read "
+                          "file \"" + fileName + "\".");
+                    
+                    endOfFile = true;
+                }
+                
+                continue;
+            }
+        }
+        
+        ++lineNumber;
+        begin = lineEnd - buffer.data() + ((lineEnd < buffer.data() + end) ? 1 : 0);
+        
+        
+        // Support files with Windows line endings
+        char const *contentEnd = lineEnd;
+        
+        if (contentEnd > lineBegin and *(contentEnd - 1) == '\r')
+            --contentEnd;
+        
+        if (contentEnd == lineBegin)
+            break;
+        
+        ParseLine(lineBegin, contentEnd, fileName, lineNumber);
+    }
+}
+
+
+void EventIDSet::Build()
+{
+    // Choose the number of slots such that the load factor does not exceed 0.7
+    std::size_t const numIDs = pending.size() + numElements;
+    std::size_t numSlots = 16;
+    
+    while (numSlots * 7 < numIDs * 10)
+        numSlots *= 2;
+    
+    
+    // Collect all IDs, including the ones in the current table, and rebuild the table
+    std::vector<Slot> ids;
+    ids.swap(pending);
+    ids.reserve(numIDs);
+    
+    for (auto const &slot: slots)
+        if (slot.run != 0)
+            ids.emplace_back(slot);
+    
+    slots.assign(numSlots, Slot{0, 0, 0});
+    mask = numSlots - 1;
+    numElements = 0;
+    
+    for (auto const &id: ids)
+    {
+        std::uint64_t index = Hash(id.run, id.lumi, id.event) & mask;
+        
+        while (slots[index].run != 0)
+        {
+            Slot const &s = slots[index];
+            
+            if (s.run == id.run and s.lumi == id.lumi and s.event == id.event)
+                break;
+            
+            index = (index + 1) & mask;
+        }
+        
+        if (slots[index].run == 0)
+        {
+            slots[index] = id;
+            ++numElements;
+        }
+    }
+}
+
+
+bool EventIDSet::Contains(unsigned long run, unsigned long lumi, unsigned long long event) const
+{
+    if (numElements == 0)
+        return false;
+    
+    std::uint64_t index = Hash(run, lumi, event) & mask;
+    
+    while (true)
+    {
+        Slot const &s = slots[index];
+        
+        if (s.run == 0)
+            return false;
+        
+        if (s.run == run and s.lumi == lumi and s.event == event)
+            return true;
+        
+        index = (index + 1) & mask;
+    }
+}
+
+
+std::size_t EventIDSet::size() const
+{
+    return numElements;
+}
+
+
+std::uint64_t EventIDSet::Hash(std::uint32_t run, std::uint32_t lumi, std::uint64_t event)
+{
+    // Finalizer of the SplitMix64 generator applied to a combination of the three numbers. Event
+    //numbers within a run are often consecutive, so they need to be mixed well
+    std::uint64_t h = event ^ ((std::uint64_t(run) << 32 | lumi) * 0x9e3779b97f4a7c15ULL);
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+
+void EventIDSet::ParseLine(char const *begin, char const *end, std::string const &fileName,
+  unsigned long lineNumber)
+{
+    std::uint64_t values[3];
+    char const *p = begin;
+    
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        if (i > 0)
+        {
+            if (p == end or *p != ':')
+                p = nullptr;
+            else
+                ++p;
+        }
+        
+        if (not p or p == end or *p < '0' or *p > '9')
+        {
+            p = nullptr;
+            break;
+        }
+        
+        std::uint64_t value = 0;
+        
+        while (p != end and *p >= '0' and *p <= '9')
+        {
+            unsigned const digit = *p - '0';
+            
+            if (value > (std::numeric_limits<std::uint64_t>::max() - digit) / 10)
+            {
+                p = nullptr;
+                break;
+            }
+            
+            value = value * 10 + digit;
+            ++p;
+        }
+        
+        if (not p)
+            break;
+        
+        values[i] = value;
+    }
+    
+    if (not p or p != end or values[0] > std::numeric_limits<std::uint32_t>::max() or
+      values[1] > std::numeric_limits<std::uint32_t>::max() or values[0] == 0)
+    {
+        std::ostringstream message;
+        message << "EventIDSet::ReadTextFile: Failed to parse line " << lineNumber << "\n  \"" <<
+          std::string(begin, end) << "\"\nof file \"" << fileName << "\". The line must have " <<
+          "the form \"run:lumi:event\" with a non-zero run number.";
+        throw std::runtime_error(message.str());
+    }
+    
+    pending.push_back({std::uint32_t(values[0]), std::uint32_t(values[1]), values[2]});
+}
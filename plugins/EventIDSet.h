@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/**
+ * \class EventIDSet
+ * \brief A set of event IDs optimized for fast construction and lookup of millions of entries
+ * 
+ * Event IDs are added with method Add or read from a text file with ReadTextFile. Once all IDs have
+ * been added, method Build must be called. It puts them into an open-addressing hash table with
+ * linear probing, whose load factor does not exceed 0.7. A lookup then normally touches a single
+ * cache line, both for IDs that are present in the set and for those that are not, regardless of
+ * the size of the set. Each slot takes 16 bytes.
+ * 
+ * An event ID consists of the run number, the luminosity block, and the event number, and all
+ * three must match. Run number 0 is reserved to mark empty slots and cannot be added.
+ */
+class EventIDSet
+{
+public:
+    /// Constructor for an empty set
+    EventIDSet() noexcept;
+    
+public:
+    /**
+     * \brief Adds an event ID
+     * 
+     * Invalidates the hash table. Method Build must be called before the next lookup. Duplicates
+     * are allowed and merged. Throws an exception of type std::runtime_error if the run number is
+     * zero.
+     */
+    void Add(unsigned long run, unsigned long lumi, unsigned long long event);
+    
+    /**
+     * \brief Reads event IDs from a text file
+     * 
+     * Event IDs must be stored in the form "run:lumi:event", one per line. Reading stops at the
+     * first empty line or at the end of the file. The file is parsed with a hand-written parser
+     * that reads it in large blocks. Throws an exception of type std::runtime_error if the file
+     * cannot be read or a line does not follow the format.
+     */
+    void ReadTextFile(std::string const &fileName);
+    
+    /// Builds the hash table from added event IDs
+    void Build();
+    
+    /**
+     * \brief Checks if the given event ID is in the set
+     * 
+     * Method Build must have been called after the last addition.
+     */
+    bool Contains(unsigned long run, unsigned long lumi, unsigned long long event) const;
+    
+    /// Returns the number of distinct event IDs in the set
+    std::size_t size() const;
+    
+private:
+    /// A slot of the hash table
+    struct Slot
+    {
+        /// Run number, or 0 if the slot is empty
+        std::uint32_t run;
+        
+        /// Luminosity block
+        std::uint32_t lumi;
+        
+        /// Event number
+        std::uint64_t event;
+    };
+    
+private:
+    /// Computes hash of the given event ID
+    static std::uint64_t Hash(std::uint32_t run, std::uint32_t lumi, std::uint64_t event);
+    
+    /// Parses a single line of a text file and adds the event ID
+    void ParseLine(char const *begin, char const *end, std::string const &fileName,
+      unsigned long lineNumber);
+    
+private:
+    /// Event IDs added since the last build
+    std::vector<Slot> pending;
+    
+    /// Hash table. The number of slots is a power of 2
+    std::vector<Slot> slots;
+    
+    /// Mask to convert a hash into an index of a slot
+    std::uint64_t mask;
+    
+    /// Number of occupied slots
+    std::size_t numElements;
+    
+    /// Size of blocks in which text files are read
+    static std::size_t const blockSize = 1 << 20;
+};
@@ -54,21 +54,51 @@ void EventWeights::fillDescriptions(edm::ConfigurationDescriptions &descriptions
 }
 
 
-void EventWeights::analyze(edm::Event const &event, edm::EventSetup const &)
+void EventWeights::analyze(edm::StreamID streamID, edm::Event const &event,
+  edm::EventSetup const &) const
 {
-    for (auto &weightInfo: weightInfos)
-        weightInfo.Read(event);
+    auto &values = *streamCache(streamID);
+
+    for (unsigned i = 0; i < weightInfos.size(); ++i)
+        values[i] = weightInfos[i].Read(event);
 
-    outTree->Fill();
+    treeFillService->Commit(this, streamID);
 }
 
 
 void EventWeights::beginJob()
 {
-    outTree = fileService->make<TTree>("EventWeights", "Additional event weights");
+    outTree = treeFillService->BookTree(this, "EventWeights", "Additional event weights");
 
     for (auto &weightInfo: weightInfos)
-        outTree->Branch(weightInfo.branchName.c_str(), &weightInfo.value);
+        outTree->Branch(BranchName(weightInfo.branchName).c_str(), &weightInfo.value);
+}
+
+
+std::unique_ptr<std::vector<double>> EventWeights::beginStream(edm::StreamID) const
+{
+    return std::make_unique<std::vector<double>>(weightInfos.size());
+}
+
+
+void EventWeights::AllocateSlots(unsigned numSlots)
+{
+    stagedValues.assign(numSlots, std::vector<double>(weightInfos.size()));
+}
+
+
+void EventWeights::StageEntry(edm::StreamID streamID, unsigned slot)
+{
+    stagedValues[slot] = *streamCache(streamID);
+}
+
+
+void EventWeights::MoveToTree(unsigned slot)
+{
+    auto const &values = stagedValues[slot];
+
+    for (unsigned i = 0; i < weightInfos.size(); ++i)
+        weightInfos[i].value = values[i];
 }
 
 
@@ -1,6 +1,8 @@
 #pragma once
 
-#include <FWCore/Framework/interface/EDAnalyzer.h>
+#include "TreeFillService.h"
+
+#include <FWCore/Framework/interface/global/EDAnalyzer.h>
 #include <FWCore/Framework/interface/Event.h>
 #include <FWCore/ParameterSet/interface/ParameterSet.h>
 #include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
@@ -8,10 +10,10 @@
 #include <FWCore/Utilities/interface/InputTag.h>
 
 #include <FWCore/ServiceRegistry/interface/Service.h>
-#include <CommonTools/UtilAlgos/interface/TFileService.h>
 
 #include <TTree.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -22,8 +24,11 @@
  * The configuration must provide a vector of input tags that identify the weights to be stored
  * (which must be of type double). Names for the corresponding branches in the output tree can also
  * be provided. If not, they are constructed from the input tags.
+ *
+ * Values of the weights are read into a buffer of the current stream.
  */
-class EventWeights: public edm::EDAnalyzer
+class EventWeights: public edm::global::EDAnalyzer<edm::StreamCache<std::vector<double>>>,
+  public TreeFillService::Client
 {
 private:
     /// Auxiliary class to aggregate details about a single weight
@@ -34,8 +39,8 @@ private:
 
         WeightInfo(edm::EDGetTokenT<T> &&token);
 
-        /// Read the value of the weight from the given event
-        void Read(edm::Event const &event);
+        /// Reads the value of the weight from the given event
+        T Read(edm::Event const &event) const;
 
         /// Token to read the weight from the event
         edm::EDGetTokenT<T> token;
@@ -43,7 +48,7 @@ private:
         /// Name for the branch in which this weight will be stored
         std::string branchName;
 
-        /// Buffer to read the value of the weight into
+        /// Buffer for the output tree
         T value;
     };
 
@@ -54,22 +59,30 @@ public:
     static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
     
 private:
-    void analyze(edm::Event const &event, edm::EventSetup const &) override;
+    void analyze(edm::StreamID streamID, edm::Event const &event, edm::EventSetup const &) const
+      override;
     void beginJob() override;
+    std::unique_ptr<std::vector<double>> beginStream(edm::StreamID) const override;
+    void AllocateSlots(unsigned numSlots) override;
+    void StageEntry(edm::StreamID streamID, unsigned slot) override;
+    void MoveToTree(unsigned slot) override;
 
 private:
     /// Details about weights to be saved
     std::vector<WeightInfo<double>> weightInfos;
     
-    /// An object to handle output ROOT file
-    edm::Service<TFileService> fileService;
+    /// Service that fills the output tree
+    edm::Service<TreeFillService> treeFillService;
     
     /**
      * \brief Output tree
      *
-     * Managed by the fileService object.
+     * Managed by TFileService.
      */
     TTree *outTree;
+    
+    /// Values of weights in events queued for writing, indexed with staging slot
+    std::vector<std::vector<double>> stagedValues;
 };
 
 
@@ -80,10 +93,10 @@ EventWeights::WeightInfo<T>::WeightInfo(edm::EDGetTokenT<T> &&token_):
 
 
 template <typename T>
-void EventWeights::WeightInfo<T>::Read(edm::Event const &event)
+T EventWeights::WeightInfo<T>::Read(edm::Event const &event) const
 {
     edm::Handle<double> handle;
     event.getByToken(token, handle);
-    value = *handle;
+    return *handle;
 }
 
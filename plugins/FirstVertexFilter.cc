@@ -33,7 +33,8 @@ void FirstVertexFilter::fillDescriptions(edm::ConfigurationDescriptions &descrip
 }
 
 
-bool FirstVertexFilter::filter(edm::Event &event, edm::EventSetup const &eventSetup)
+bool FirstVertexFilter::filter(edm::StreamID, edm::Event &event,
+  edm::EventSetup const &eventSetup) const
 {
     // Read a collection of vertices
     edm::Handle<reco::VertexCollection> vertices;
@@ -1,6 +1,8 @@
 #pragma once
 
-#include <FWCore/Framework/interface/EDFilter.h>
+#include "CompiledSelector.h"
+
+#include <FWCore/Framework/interface/global/EDFilter.h>
 #include <FWCore/Framework/interface/Event.h>
 
 #include <FWCore/ParameterSet/interface/ParameterSet.h>
@@ -8,7 +10,6 @@
 
 #include <DataFormats/VertexReco/interface/VertexFwd.h>
 #include <DataFormats/VertexReco/interface/Vertex.h>
-#include <CommonTools/Utils/interface/StringCutObjectSelector.h>
 
 #include <string>
 
@@ -20,7 +21,7 @@
  * The plugin performs string-based filtering on the first vertex in the collection given. The
  * vertices that pass the selection are put into the event content in a separate collection.
  */
-class FirstVertexFilter: public edm::EDFilter
+class FirstVertexFilter: public edm::global::EDFilter<>
 {
 public:
     /// Constructor
@@ -35,7 +36,8 @@ public:
      * 
      * Stores vertices that pass the selection in a separate collection.
      */
-    virtual bool filter(edm::Event &event, edm::EventSetup const &eventSetup);
+    virtual bool filter(edm::StreamID, edm::Event &event, edm::EventSetup const &eventSetup)
+      const override;
     
 private:
     /// Input collection of vertices
@@ -47,5 +49,5 @@ private:
      * String-based selectors are described in [1].
      * [1] https://twiki.cern.ch/twiki/bin/view/CMSPublic/SWGuidePhysicsCutParser
      */
-    StringCutObjectSelector<reco::Vertex> const selector;
+    CompiledSelector<reco::Vertex> const selector;
 };
@@ -0,0 +1,329 @@
+#pragma once
+
+#include "FloatPrecision.h"
+
+#include <Rtypes.h>
+#include <TBranch.h>
+#include <TClass.h>
+#include <TObjArray.h>
+#include <TStreamerElement.h>
+#include <TTree.h>
+#include <TVirtualStreamerInfo.h>
+
+#include <FWCore/Utilities/interface/EDMException.h>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+
+/**
+ * \class FlatBranches
+ * \brief Writes a collection of objects as a set of counter-plus-array leaf branches
+ * 
+ * Instead of storing an std::vector of objects in a single object branch, which requires the
+ * dictionary to read back, properties of objects are written into separate branches of plain
+ * arrays. Their size is given by a common counter branch. This is the layout used by NanoAOD, e.g.
+ * jets are stored in branches nJet, Jet_pt[nJet], Jet_eta[nJet], and so on. Such branches can be
+ * read column by column by tools that do not know about PEC classes, such as RDataFrame or uproot.
+ * 
+ * Each column is defined with a function that extracts the corresponding property from an object.
+ * Supported types of columns are Float_t, Int_t, UShort_t, and UChar_t. The buffers attached to
+ * the branches grow automatically when a larger collection is filled.
+ * 
+ * A column that stores a data member of class T should be added with method AddMemberColumn. For
+ * Float_t columns, values are then written with the same reduced precision as the data member has
+ * in an object branch. Method CheckMembers verifies that all persistent data members of class T
+ * are stored in some column, so that a change in the class does not go unnoticed.
+ */
+template<typename T>
+class FlatBranches
+{
+private:
+    /// Interface for a single column
+    class ColumnBase
+    {
+    public:
+        /// Default virtual destructor
+        virtual ~ColumnBase() = default;
+        
+    public:
+        /// Copies properties of given objects into the buffer of the column
+        virtual void Fill(std::vector<T> const &objects) = 0;
+    };
+    
+    /// Column with values of the given type
+    template<typename V>
+    class Column: public ColumnBase
+    {
+    public:
+        /// Creates a branch in the given tree
+        Column(TTree *tree, std::string const &name, std::string const &counterName,
+          std::function<V(T const &)> const &getter);
+        
+    public:
+        /// Copies properties of given objects into the buffer of the column
+        virtual void Fill(std::vector<T> const &objects) override;
+        
+    private:
+        /// Function to extract the value from an object
+        std::function<V(T const &)> getter;
+        
+        /// Buffer attached to the branch
+        std::vector<V> buffer;
+        
+        /// Branch in the output tree
+        TBranch *branch;
+    };
+    
+public:
+    /**
+     * \brief Constructor
+     * 
+     * Creates the counter branch with the given name in the given tree.
+     */
+    FlatBranches(TTree *tree, std::string const &counterName);
+    
+public:
+    /**
+     * \brief Adds a new column
+     * 
+     * The branch with the given name is created immediately. The given function is applied to each
+     * object in the collection to compute the value stored in the column.
+     */
+    template<typename V>
+    void AddColumn(std::string const &name, std::function<V(T const &)> const &getter);
+    
+    /**
+     * \brief Adds a Float_t column for the given floating-point data member of class T
+     * 
+     * The value returned by the given function is rounded to the precision with which the data
+     * member is stored in an object branch. The precision is read from the dictionary of class T.
+     */
+    void AddMemberColumn(std::string const &name, std::string const &member,
+      std::function<Float_t(T const &)> const &getter);
+    
+    /**
+     * \brief Adds a column of a non-floating-point type for the given data member of class T
+     * 
+     * The value returned by the given function is stored as is. The data member is only recorded
+     * for the check in CheckMembers.
+     */
+    template<typename V>
+    void AddMemberColumn(std::string const &name, std::string const &member,
+      std::function<V(T const &)> const &getter);
+    
+    /**
+     * \brief Checks that all persistent data members of class T are stored
+     * 
+     * Data members of base classes are included. Members in the given list are skipped on
+     * purpose. Throws an exception if a data member is neither stored in a column added with
+     * AddMemberColumn nor skipped, or if a skipped member does not exist. Should be called after
+     * all columns have been added.
+     */
+    void CheckMembers(std::vector<std::string> const &skipped) const;
+    
+    /// Copies properties of given objects into buffers of all columns
+    void Fill(std::vector<T> const &objects);
+    
+private:
+    /// Leaf type codes for supported types of columns
+    static char LeafType(Float_t const *);
+    static char LeafType(Int_t const *);
+    static char LeafType(UShort_t const *);
+    static char LeafType(UChar_t const *);
+    
+    /// Appends names of persistent data members of the given class and its bases to the list
+    static void ListMembers(TClass *cl, std::vector<std::string> &members);
+    
+private:
+    /// Tree in which the branches are created
+    TTree *tree;
+    
+    /// Name of the counter branch
+    std::string const counterName;
+    
+    /// Buffer for the counter branch
+    UInt_t counter;
+    
+    /// Registered columns
+    std::vector<std::unique_ptr<ColumnBase>> columns;
+    
+    /// Data members of class T stored in registered columns
+    std::set<std::string> storedMembers;
+    
+    /// Number of elements allocated in buffers of new columns
+    static unsigned const initialCapacity = 16;
+};
+
+
+template<typename T>
+template<typename V>
+FlatBranches<T>::Column<V>::Column(TTree *tree, std::string const &name,
+  std::string const &counterName, std::function<V(T const &)> const &getter):
+    getter(getter),
+    buffer(initialCapacity)
+{
+    std::string const leafList(name + "[" + counterName + "]/" + LeafType(buffer.data()));
+    branch = tree->Branch(name.c_str(), buffer.data(), leafList.c_str());
+}
+
+
+template<typename T>
+template<typename V>
+void FlatBranches<T>::Column<V>::Fill(std::vector<T> const &objects)
+{
+    // If the buffer is reallocated, the branch must be pointed to the new location
+    if (objects.size() > buffer.size())
+    {
+        buffer.resize(objects.size());
+        branch->SetAddress(buffer.data());
+    }
+    
+    for (unsigned i = 0; i < objects.size(); ++i)
+        buffer[i] = getter(objects[i]);
+}
+
+
+template<typename T>
+FlatBranches<T>::FlatBranches(TTree *tree_, std::string const &counterName_):
+    tree(tree_),
+    counterName(counterName_),
+    counter(0)
+{
+    tree->Branch(counterName.c_str(), &counter, (counterName + "/i").c_str());
+}
+
+
+template<typename T>
+template<typename V>
+void FlatBranches<T>::AddColumn(std::string const &name,
+  std::function<V(T const &)> const &getter)
+{
+    columns.emplace_back(new Column<V>(tree, name, counterName, getter));
+}
+
+
+template<typename T>
+void FlatBranches<T>::AddMemberColumn(std::string const &name, std::string const &member,
+  std::function<Float_t(T const &)> const &getter)
+{
+    FloatPrecision const precision(TClass::GetClass(typeid(T)), member);
+    AddColumn<Float_t>(name, [getter, precision](T const &object)
+    {
+        return precision(getter(object));
+    });
+    
+    storedMembers.insert(member);
+}
+
+
+template<typename T>
+template<typename V>
+void FlatBranches<T>::AddMemberColumn(std::string const &name, std::string const &member,
+  std::function<V(T const &)> const &getter)
+{
+    AddColumn<V>(name, getter);
+    storedMembers.insert(member);
+}
+
+
+template<typename T>
+void FlatBranches<T>::CheckMembers(std::vector<std::string> const &skipped) const
+{
+    TClass *cl = TClass::GetClass(typeid(T));
+    std::vector<std::string> members;
+    
+    if (cl)
+        ListMembers(cl, members);
+    
+    std::set<std::string> const skippedSet(skipped.begin(), skipped.end());
+    std::string missing, unknown;
+    
+    for (auto const &member: members)
+    {
+        if (storedMembers.count(member) == 0 and skippedSet.count(member) == 0)
+            missing += " " + member;
+    }
+    
+    for (auto const &member: skippedSet)
+    {
+        if (std::find(members.begin(), members.end(), member) == members.end())
+            unknown += " " + member;
+    }
+    
+    if (not missing.empty() or not unknown.empty())
+    {
+        edm::Exception excp(edm::errors::LogicError);
+        excp << "Flat columns with counter \"" << counterName << "\" do not match data members "
+          "of class \"" << ((cl) ? cl->GetName() : "(unknown)") << "\".";
+        
+        if (not missing.empty())
+            excp << " Data members not stored:" << missing << ".";
+        
+        if (not unknown.empty())
+            excp << " Skipped data members that do not exist:" << unknown << ".";
+        
+        excp.raise();
+    }
+}
+
+
+template<typename T>
+void FlatBranches<T>::Fill(std::vector<T> const &objects)
+{
+    counter = objects.size();
+    
+    for (auto &column: columns)
+        column->Fill(objects);
+}
+
+
+template<typename T>
+char FlatBranches<T>::LeafType(Float_t const *)
+{
+    return 'F';
+}
+
+
+template<typename T>
+char FlatBranches<T>::LeafType(Int_t const *)
+{
+    return 'I';
+}
+
+
+template<typename T>
+char FlatBranches<T>::LeafType(UShort_t const *)
+{
+    return 's';
+}
+
+
+template<typename T>
+char FlatBranches<T>::LeafType(UChar_t const *)
+{
+    return 'b';
+}
+
+
+template<typename T>
+void FlatBranches<T>::ListMembers(TClass *cl, std::vector<std::string> &members)
+{
+    TIter next(cl->GetStreamerInfo()->GetElements());
+    
+    while (auto const *element = static_cast<TStreamerElement const *>(next()))
+    {
+        if (element->IsBase())
+        {
+            if (element->GetClassPointer())
+                ListMembers(element->GetClassPointer(), members);
+        }
+        else
+            members.emplace_back(element->GetName());
+    }
+}
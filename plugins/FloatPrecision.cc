@@ -0,0 +1,105 @@
+#include "FloatPrecision.h"
+
+#include <TStreamerElement.h>
+#include <TVirtualStreamerInfo.h>
+
+#include <FWCore/Utilities/interface/EDMException.h>
+
+#include <cstdint>
+#include <cstring>
+
+
+using namespace std;
+
+
+FloatPrecision::FloatPrecision(TClass *cl, string const &member):
+    mode(Mode::Full),
+    numBits(0),
+    xMin(0.), xMax(0.), factor(0.)
+{
+    Int_t offset;
+    TStreamerElement const *element = (cl) ?
+      cl->GetStreamerInfo()->GetStreamerElement(member.c_str(), offset) : nullptr;
+    
+    if (not element)
+    {
+        edm::Exception excp(edm::errors::LogicError);
+        excp << "Data member \"" << member << "\" is not found in the streamer info of class \"" <<
+          ((cl) ? cl->GetName() : "(unknown)") << "\".";
+        excp.raise();
+    }
+    
+    int const type = element->GetType() % TVirtualStreamerInfo::kOffsetL;
+    
+    if (type == TVirtualStreamerInfo::kFloat)
+        return;
+    
+    if (type != TVirtualStreamerInfo::kFloat16)
+    {
+        edm::Exception excp(edm::errors::LogicError);
+        excp << "Data member \"" << member << "\" of class \"" << cl->GetName() <<
+          "\" is not of type Float_t or Float16_t.";
+        excp.raise();
+    }
+    
+    
+    // Interpret the range in the same way as TBufferFile::WriteFloat16 does. If no range has been
+    //given, TStreamerElement stores the number of bits of the mantissa in place of the lower
+    //boundary
+    if (element->GetFactor() != 0.)
+    {
+        mode = Mode::Range;
+        xMin = element->GetXmin();
+        xMax = element->GetXmax();
+        factor = element->GetFactor();
+    }
+    else
+    {
+        mode = Mode::Mantissa;
+        numBits = int(element->GetXmin());
+        
+        if (numBits == 0)
+            numBits = 12;
+    }
+}
+
+
+Float_t FloatPrecision::operator()(Float_t value) const
+{
+    if (mode == Mode::Range)
+    {
+        double x = value;
+        
+        if (x < xMin)
+            x = xMin;
+        
+        if (x > xMax)
+            x = xMax;
+        
+        uint32_t const code = uint32_t(0.5 + factor * (x - xMin));
+        return Float_t(code / factor + xMin);
+    }
+    else if (mode == Mode::Mantissa)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        
+        // Round the mantissa to the given number of bits, but do not let it overflow into the
+        //exponent
+        uint32_t const exponent = (bits << 1) >> 24;
+        uint32_t mantissa = ((1u << (numBits + 1)) - 1) & (bits >> (23 - numBits - 1));
+        mantissa = (mantissa + 1) >> 1;
+        
+        if (mantissa & (1u << numBits))
+            mantissa = (1u << numBits) - 1;
+        
+        bits = (exponent << 23) | (mantissa << (23 - numBits));
+        
+        Float_t result;
+        memcpy(&result, &bits, sizeof(result));
+        
+        return (value < 0.f) ? -result : result;
+    }
+    else
+        return value;
+}
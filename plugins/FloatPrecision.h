@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Rtypes.h>
+#include <TClass.h>
+
+#include <string>
+
+
+/**
+ * \class FloatPrecision
+ * \brief Reproduces the precision with which a floating-point data member is stored in ROOT files
+ * 
+ * Floating-point data members of PEC classes are declared as Float16_t with a comment that
+ * specifies their precision (see documentation for pec::Candidate). The ROOT streamer applies this
+ * precision when an object is written. This class reads the precision of a data member from the
+ * streamer info of its class and applies it to a given value in the same way, so that a value
+ * stored in a plain Float_t branch is identical to what would be read back from an object branch.
+ * Besides giving consistent results in both layouts, this makes the values more compressible.
+ * 
+ * Values of data members of type Float_t are not changed.
+ */
+class FloatPrecision
+{
+public:
+    /**
+     * \brief Constructor
+     * 
+     * Reads the precision of the given data member of the given class. The data member can be
+     * defined in a base class. Throws an exception if the data member is not found or is not of a
+     * floating-point type.
+     */
+    FloatPrecision(TClass *cl, std::string const &member);
+    
+public:
+    /// Returns the given value as it would be read back after being written with this precision
+    Float_t operator()(Float_t value) const;
+    
+private:
+    /// Supported ways to store a floating-point number
+    enum class Mode
+    {
+        /// Full precision of Float_t
+        Full,
+        
+        /// Mantissa truncated to a given number of bits
+        Mantissa,
+        
+        /// Integer with a given number of bits, which encodes the value within a range
+        Range
+    };
+    
+private:
+    /// Way to store the data member
+    Mode mode;
+    
+    /// Number of bits kept in the mantissa. Only used in mode Mantissa
+    int numBits;
+    
+    /**
+     * \brief Range and scale factor for the integer encoding
+     * 
+     * Only used in mode Range. The definitions follow those in TStreamerElement.
+     */
+    double xMin, xMax, factor;
+};
@@ -1,6 +1,7 @@
 #include "IndexIntervals.h"
 
 #include <algorithm>
+#include <iterator>
 #include <limits>
 #include <sstream>
 #include <stdexcept>
@@ -25,11 +26,48 @@ IndexIntervals::IterableIndices::IterableIndices(
         min = std::max(intervals.front().first, min_);
         max = std::min(intervals.back().second, max_);
 
-        beginIntervalIt = parent.FindInterval(min);
+        // The boundaries might fall in gaps between intervals. Move them to the closest included
+        //indices, using the same intervals as in iteration over ranges
+        IterableRanges const ranges(parent, min, max);
+        beginIntervalIt = ranges.begin().Interval();
+        auto const endIntervalIt = ranges.end().Interval();
+
+        if (beginIntervalIt == endIntervalIt)
+        {
+            min = 0;
+            max = -1;
+        }
+        else
+        {
+            min = std::max(min, beginIntervalIt->first);
+            max = std::min(max, std::prev(endIntervalIt)->second);
+        }
     }
 }
 
 
+IndexIntervals::IterableRanges::IterableRanges(
+  IndexIntervals const &parent, index_t min_, index_t max_):
+    min{min_}, max{max_}
+{
+    auto const &intervals = parent.intervals;
+
+    if (min > max)
+    {
+        beginIntervalIt = endIntervalIt = intervals.end();
+        return;
+    }
+
+    // Since the intervals are sorted and do not overlap, the ones that overlap with the range
+    //[min, max] form a contiguous block. It starts with the first interval that ends not before
+    //min and stops before the first interval that starts after max.
+    beginIntervalIt = std::lower_bound(intervals.begin(), intervals.end(), min,
+      [](auto const &r, index_t const &value){return (r.second < value);});
+    endIntervalIt = std::upper_bound(beginIntervalIt, intervals.end(), max,
+      [](index_t const &value, auto const &r){return (value < r.first);});
+}
+
+
 IndexIntervals::IndexIntervals(std::vector<index_t> edges)
 {
     if (edges.size() == 1 and edges[0] == -1)
@@ -88,17 +126,10 @@ IndexIntervals::IndexIntervals(std::vector<index_t> edges)
 
 unsigned IndexIntervals::NumberIndices(index_t min, index_t max) const
 {
-    if (Empty())
-        return 0;
-
-    min = std::max(min, intervals.front().first);
-    max = std::min(max, intervals.back().second);
-
     unsigned count = 0;
-    auto end = ++FindInterval(max);
 
-    for (auto intervalIt = FindInterval(min); intervalIt != end; ++intervalIt)
-        count += std::min(intervalIt->second, max) - std::max(intervalIt->first, min) + 1;
+    for (auto const &range: GetRanges(min, max))
+        count += range.second - range.first + 1;
 
     return count;
 }
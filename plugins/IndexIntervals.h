@@ -2,6 +2,7 @@
 
 #include <boost/iterator/iterator_facade.hpp>
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 
@@ -11,7 +12,9 @@
  *
  * Allows to test whether a given index is contained within one of the included intervals (using
  * method \ref Contain). Provides means to iterate over all indices in all intervals (method
- * \ref GetIndices).
+ * \ref GetIndices) or over the intervals themselves (method \ref GetRanges). The latter is
+ * preferred in performance-critical code as it allows to process each interval with a tight loop.
+ * Methods \ref Gather copy selected elements of a vector in this way.
  */
 class IndexIntervals
 {
@@ -90,6 +93,69 @@ public:
         std::vector<interval_t>::const_iterator beginIntervalIt;
     };
 
+    /// Auxiliary class that implements a forward iterator for intervals clipped to a range
+    class RangeIt: public boost::iterator_facade<
+      RangeIt, interval_t const, boost::forward_traversal_tag, interval_t, int>
+    {
+    public:
+        RangeIt() = default;
+
+        RangeIt(std::vector<interval_t>::const_iterator intervalIt_, index_t min_, index_t max_):
+            intervalIt{intervalIt_}, min{min_}, max{max_}
+        {}
+
+        /// Returns iterator to the underlying (not clipped) interval
+        std::vector<interval_t>::const_iterator Interval() const
+        {
+            return intervalIt;
+        }
+
+    private:
+        friend class boost::iterator_core_access;
+
+        reference dereference() const
+        {
+            return {std::max(intervalIt->first, min), std::min(intervalIt->second, max)};
+        }
+
+        bool equal(RangeIt const &other) const
+        {
+            return intervalIt == other.intervalIt;
+        }
+
+        void increment()
+        {
+            ++intervalIt;
+        }
+
+        std::vector<interval_t>::const_iterator intervalIt;
+        index_t min, max;
+    };
+
+    /// Auxiliary class to implement iteration over intervals
+    class IterableRanges
+    {
+    public:
+        IterableRanges(IndexIntervals const &parent, index_t min, index_t max);
+
+        RangeIt begin() const
+        {
+            return {beginIntervalIt, min, max};
+        }
+
+        RangeIt end() const
+        {
+            return {endIntervalIt, min, max};
+        }
+
+    private:
+        /// Intervals are clipped to this range
+        index_t min, max;
+
+        /// Intervals that overlap with the range
+        std::vector<interval_t>::const_iterator beginIntervalIt, endIntervalIt;
+    };
+
 public:
     /**
      * \brief Constructor from edges of intervals
@@ -133,6 +199,51 @@ public:
         return {*this, min, max};
     }
 
+    /**
+     * \brief Returns an iterable object to visit all intervals, clipped to given range
+     *
+     * Returned object provides forward iterators over closed intervals [first, last] that overlap
+     * with the given range (boundaries are included). Dereferencing the iterator gives the
+     * intersection of the interval with the range, which is never empty. The intervals are visited
+     * in an increasing order.
+     */
+    IterableRanges GetRanges(index_t min, index_t max) const
+    {
+        return {*this, min, max};
+    }
+
+    /**
+     * \brief Appends selected elements of a vector to another vector
+     *
+     * Indices of selected elements are restricted to the size of the source vector. Elements are
+     * copied interval by interval with std::vector::insert, which reduces to memmove for
+     * trivially copyable elements of the same type.
+     */
+    template<typename Src, typename Dst>
+    void Gather(std::vector<Src> const &src, std::vector<Dst> &dst) const
+    {
+        for (auto const &range: GetRanges(0, index_t(src.size()) - 1))
+            dst.insert(dst.end(), src.begin() + range.first, src.begin() + range.second + 1);
+    }
+
+    /**
+     * \brief Appends selected elements of a vector to another vector, applying a transformation
+     *
+     * Same as the above version, but each selected element is converted with the given function.
+     * The loop over each interval has no branches and can be vectorized if the function allows.
+     */
+    template<typename Src, typename Dst, typename Transform>
+    void Gather(std::vector<Src> const &src, std::vector<Dst> &dst, Transform transform) const
+    {
+        for (auto const &range: GetRanges(0, index_t(src.size()) - 1))
+        {
+            auto const offset = dst.size();
+            dst.resize(offset + (range.second - range.first + 1));
+            std::transform(src.begin() + range.first, src.begin() + range.second + 1,
+              dst.begin() + offset, transform);
+        }
+    }
+
     /**
      * \brief Returns the number of indices, restricting them to given range
      *
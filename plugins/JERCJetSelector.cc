@@ -7,7 +7,6 @@
 #include <FWCore/Utilities/interface/Exception.h>
 #include <FWCore/Utilities/interface/InputTag.h>
 
-#include <CondFormats/JetMETObjects/interface/JetCorrectorParameters.h>
 #include <JetMETCorrections/Objects/interface/JetCorrectionsRecord.h>
 
 #include <CLHEP/Random/RandGaussQ.h>
@@ -19,8 +18,21 @@
 #include <limits>
 
 
+JERCJetSelectorRunCache::JERCJetSelectorRunCache(edm::EventSetup const &setup,
+  std::string const &jetTypeLabel):
+    jerProvider(JME::JetResolution::get(setup, jetTypeLabel + "_pt")),
+    jerSFProvider(JME::JetResolutionScaleFactor::get(setup, jetTypeLabel))
+{
+    // Parameters to construct an object to obtain JEC uncertainty [1]
+    //[1] https://twiki.cern.ch/twiki/bin/view/CMSPublic/WorkBookJetEnergyCorrections?rev=137#JetCorUncertainties
+    edm::ESHandle<JetCorrectorParametersCollection> jecParametersCollection;
+    setup.get<JetCorrectionsRecord>().get(jetTypeLabel, jecParametersCollection);
+    
+    jecUncParameters = (*jecParametersCollection)["Uncertainty"];
+}
+
+
 JERCJetSelector::JERCJetSelector(edm::ParameterSet const &cfg):
-    edm::EDFilter(),
     preselector(cfg.getParameter<std::string>("preselection")),
     minPt(cfg.getParameter<double>("minPt")),
     minRawPt(cfg.getParameter<double>("minRawPt")),
@@ -62,27 +74,41 @@ void JERCJetSelector::fillDescriptions(edm::ConfigurationDescriptions &descripti
 }
 
 
-void JERCJetSelector::beginRun(edm::Run const &, edm::EventSetup const &setup)
+std::unique_ptr<JERCJetSelectorStreamCache> JERCJetSelector::beginStream(edm::StreamID) const
 {
-    // Construct an object to obtain JEC uncertainty [1]
-    //[1] https://twiki.cern.ch/twiki/bin/view/CMSPublic/WorkBookJetEnergyCorrections?rev=137#JetCorUncertainties
-    edm::ESHandle<JetCorrectorParametersCollection> jecParametersCollection;
-    setup.get<JetCorrectionsRecord>().get(jetTypeLabel, jecParametersCollection); 
-    
-    JetCorrectorParameters const &jecParameters = (*jecParametersCollection)["Uncertainty"];
-    jecUncProvider.reset(new JetCorrectionUncertainty(jecParameters));
-    
-    
-    // Objects that provide jet energy resolution and its scale factors
-    jerProvider.reset(
-      new JME::JetResolution(std::move(JME::JetResolution::get(setup, jetTypeLabel + "_pt"))));
-    jerSFProvider.reset(new JME::JetResolutionScaleFactor(
-      std::move(JME::JetResolutionScaleFactor::get(setup, jetTypeLabel))));
+    return std::make_unique<JERCJetSelectorStreamCache>();
 }
 
 
-bool JERCJetSelector::filter(edm::Event &event, edm::EventSetup const &)
+std::shared_ptr<JERCJetSelectorRunCache> JERCJetSelector::globalBeginRun(edm::Run const &,
+  edm::EventSetup const &setup) const
 {
+    return std::make_shared<JERCJetSelectorRunCache>(setup, jetTypeLabel);
+}
+
+
+void JERCJetSelector::globalEndRun(edm::Run const &, edm::EventSetup const &) const
+{}
+
+
+void JERCJetSelector::streamBeginRun(edm::StreamID streamID, edm::Run const &run,
+  edm::EventSetup const &) const
+{
+    // JetCorrectionUncertainty changes its state when it is evaluated for a jet, and thus a
+    //separate instance is needed in each stream
+    streamCache(streamID)->jecUncProvider.reset(
+      new JetCorrectionUncertainty(runCache(run.index())->jecUncParameters));
+}
+
+
+bool JERCJetSelector::filter(edm::StreamID streamID, edm::Event &event,
+  edm::EventSetup const &) const
+{
+    // Providers of JEC uncertainty and JER
+    JetCorrectionUncertainty &jecUncProvider = *streamCache(streamID)->jecUncProvider;
+    JERCJetSelectorRunCache const &conditions = *runCache(event.getRun().index());
+    
+    
     // Read the source collection of jets and rho. The latter is only used in JER smearing and thus
     //is only read when the corresponding flag is set.
     edm::Handle<edm::View<pat::Jet>> srcJets;
@@ -136,9 +162,9 @@ bool JERCJetSelector::filter(edm::Event &event, edm::EventSetup const &)
         {
             // Find JEC uncertainty for the current jet [1]
             //[1] https://twiki.cern.ch/twiki/bin/view/CMSPublic/WorkBookJetEnergyCorrections?rev=137#JetCorUncertainties
-            jecUncProvider->setJetEta(j.eta());
-            jecUncProvider->setJetPt(j.pt());
-            jecUncertainty = std::abs(jecUncProvider->getUncertainty(true));
+            jecUncProvider.setJetEta(j.eta());
+            jecUncProvider.setJetPt(j.pt());
+            jecUncertainty = std::abs(jecUncProvider.getUncertainty(true));
             
             
             // Evaluate JER smearing factors. This is only done for simulation.
@@ -146,14 +172,14 @@ bool JERCJetSelector::filter(edm::Event &event, edm::EventSetup const &)
             {
                 // JER pt resolution (relative) and scale factors
                 double const ptResolution =
-                  jerProvider->getResolution({{JME::Binning::JetPt, j.pt()},
+                  conditions.jerProvider.getResolution({{JME::Binning::JetPt, j.pt()},
                   {JME::Binning::JetEta, j.eta()}, {JME::Binning::Rho, *rho}});
                 
-                double const jerSFNominal = jerSFProvider->getScaleFactor(
+                double const jerSFNominal = conditions.jerSFProvider.getScaleFactor(
                   {{JME::Binning::JetEta, j.eta()}}, Variation::NOMINAL);
-                double const jerSFUp = jerSFProvider->getScaleFactor(
+                double const jerSFUp = conditions.jerSFProvider.getScaleFactor(
                   {{JME::Binning::JetEta, j.eta()}}, Variation::UP);
-                double const jerSFDown = jerSFProvider->getScaleFactor(
+                double const jerSFDown = conditions.jerSFProvider.getScaleFactor(
                   {{JME::Binning::JetEta, j.eta()}}, Variation::DOWN);
                 
                 
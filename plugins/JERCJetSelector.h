@@ -1,19 +1,63 @@
 #pragma once
 
-#include <FWCore/Framework/interface/EDFilter.h>
+#include "CompiledSelector.h"
+
+#include <FWCore/Framework/interface/global/EDFilter.h>
 #include <FWCore/Framework/interface/Event.h>
+#include <FWCore/Framework/interface/Run.h>
 #include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
 #include <FWCore/ParameterSet/interface/ParameterSet.h>
 #include <FWCore/ServiceRegistry/interface/Service.h>
 #include <FWCore/Utilities/interface/RandomNumberGenerator.h>
 
 #include <CondFormats/JetMETObjects/interface/JetCorrectionUncertainty.h>
-#include <CommonTools/Utils/interface/StringCutObjectSelector.h>
 #include <DataFormats/JetReco/interface/GenJet.h>
 #include <DataFormats/PatCandidates/interface/Jet.h>
+#include <CondFormats/JetMETObjects/interface/JetCorrectorParameters.h>
 #include <JetMETCorrections/Modules/interface/JetResolution.h>
 
 #include <memory>
+#include <string>
+
+
+/**
+ * \struct JERCJetSelectorRunCache
+ * \brief Conditions for JEC uncertainty and JER shared by all streams within a run
+ * 
+ * JER providers are only accessed via their const methods and thus can be used by several streams
+ * concurrently. This is not the case for JetCorrectionUncertainty, which changes its state when
+ * properties of a jet are set. For this reason only parameters of the JEC uncertainty are shared,
+ * and each stream constructs its own JetCorrectionUncertainty from them.
+ */
+struct JERCJetSelectorRunCache
+{
+    /// Constructor from the event setup
+    JERCJetSelectorRunCache(edm::EventSetup const &setup, std::string const &jetTypeLabel);
+    
+    /// Parameters of JEC uncertainty
+    JetCorrectorParameters jecUncParameters;
+    
+    /// An object that provides jet energy resolution in simulation
+    JME::JetResolution const jerProvider;
+    
+    /// An object that provides JER scale factors
+    JME::JetResolutionScaleFactor const jerSFProvider;
+};
+
+
+/**
+ * \struct JERCJetSelectorStreamCache
+ * \brief Objects that cannot be shared between streams
+ */
+struct JERCJetSelectorStreamCache
+{
+    /**
+     * \brief An object to access JEC uncertainty
+     * 
+     * Constructed in each run from parameters stored in the run cache.
+     */
+    std::unique_ptr<JetCorrectionUncertainty> jecUncProvider;
+};
 
 
 /**
@@ -39,23 +83,41 @@
  * indicating the presence of a matching generator-level jet is written as userInt "hasGenMatch".
  * The matching is performed as recommended in [1].
  * 
+ * JEC and JER conditions are read once per run and shared between all streams. The only exception
+ * is the JEC uncertainty provider, which is not thread-safe and is therefore constructed in each
+ * stream.
+ * 
  * [1] https://twiki.cern.ch/twiki/bin/view/CMS/JetResolution?rev=54#Smearing_procedures
  */
-class JERCJetSelector: public edm::EDFilter
+class JERCJetSelector:
+  public edm::global::EDFilter<edm::RunCache<JERCJetSelectorRunCache>,
+    edm::StreamCache<JERCJetSelectorStreamCache>>
 {
 public:
     /// Constructor
     JERCJetSelector(edm::ParameterSet const &cfg);
     
 public:
-    /// Creates objects that provide JEC uncertainty and JER resolution and scale factors
-    virtual void beginRun(edm::Run const &, edm::EventSetup const &setup) override;
+    /// Creates an empty cache for a new stream
+    virtual std::unique_ptr<JERCJetSelectorStreamCache> beginStream(edm::StreamID) const override;
+    
+    /// Reads JEC uncertainty and JER resolution and scale factors for the new run
+    virtual std::shared_ptr<JERCJetSelectorRunCache> globalBeginRun(edm::Run const &,
+      edm::EventSetup const &setup) const override;
+    
+    /// Does nothing. Required by the framework
+    virtual void globalEndRun(edm::Run const &, edm::EventSetup const &) const override;
+    
+    /// Creates the object that provides JEC uncertainty in the given stream
+    virtual void streamBeginRun(edm::StreamID streamID, edm::Run const &run,
+      edm::EventSetup const &) const override;
     
     /// Verifies plugin configuration
     static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
     
     /// Produces collection of selected jets and performs event filtering
-    virtual bool filter(edm::Event &event, edm::EventSetup const &) override;
+    virtual bool filter(edm::StreamID streamID, edm::Event &event, edm::EventSetup const &)
+      const override;
     
 private:
     /**
@@ -73,7 +135,7 @@ private:
     edm::EDGetTokenT<edm::View<pat::Jet>> jetToken;
     
     /// Preselection for jets
-    StringCutObjectSelector<pat::Jet> const preselector;
+    CompiledSelector<pat::Jet> const preselector;
     
     /// Selection on corrected pt
     double minPt;
@@ -98,9 +160,6 @@ private:
      */
     std::string const jetTypeLabel;
     
-    /// An object to access JEC uncertainty
-    std::unique_ptr<JetCorrectionUncertainty> jecUncProvider;
-    
     /**
      * \brief Collection of GEN-level jets
      * 
@@ -122,12 +181,6 @@ private:
      */
     edm::EDGetTokenT<double> rhoToken;
     
-    /// An object that provides jet energy resolution in simulation
-    std::unique_ptr<JME::JetResolution> jerProvider;
-    
-    /// An object that provides JER scale factors
-    std::unique_ptr<JME::JetResolutionScaleFactor> jerSFProvider;
-    
     /**
      * \brief Random-number generator service
      * 
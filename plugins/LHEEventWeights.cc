@@ -7,6 +7,7 @@
 
 #include <boost/regex.hpp>
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
@@ -23,7 +24,7 @@ LHEEventWeights::LHEEventWeights(ParameterSet const &cfg):
     storeWeights(cfg.getParameter<bool>("storeWeights")),
     printToFiles(cfg.getParameter<bool>("printToFiles")),
     nEventsProcessed(0),
-    bfAltWeights(nullptr)
+    outTree(nullptr)
 {
     // Register required input data
     lheRunInfoToken =
@@ -38,12 +39,6 @@ LHEEventWeights::LHEEventWeights(ParameterSet const &cfg):
 }
 
 
-LHEEventWeights::~LHEEventWeights()
-{
-    delete [] bfAltWeights;
-}
-
-
 void LHEEventWeights::fillDescriptions(ConfigurationDescriptions &descriptions)
 {
     ParameterSetDescription desc;
@@ -68,8 +63,11 @@ void LHEEventWeights::fillDescriptions(ConfigurationDescriptions &descriptions)
 }
 
 
-void LHEEventWeights::analyze(Event const &event, EventSetup const &)
+void LHEEventWeights::analyze(StreamID streamID, Event const &event, EventSetup const &) const
 {
+    LHEEventWeightsStreamCache &cache = *streamCache(streamID);
+    
+    
     // Read LHE information for the current event
     Handle<LHEEventProduct> lheEventInfo;
     event.getByToken(lheEventInfoToken, lheEventInfo);
@@ -77,16 +75,22 @@ void LHEEventWeights::analyze(Event const &event, EventSetup const &)
     vector<gen::WeightsInfo> const &altWeightObjects = lheEventInfo->weights();
     
     
-    // Perform initialization when processing the first event
-    if (nEventsProcessed == 0)
+    // Set up IDs and sums of weights when processing the first event in the stream. This cannot be
+    //done from the LHE header in beginRun; see documentation for method globalEndRun
+    if (cache.nEventsProcessed == 0)
     {
-        altWeights.reserve(altWeightObjects.size());
+        cache.altWeights.reserve(altWeightObjects.size());
         
         if (computeMeanWeights)
-            SetupWeightMeans(altWeightObjects);
-        
-        if (storeWeights)
-            SetupWeightTree(altWeightObjects.size());
+        {
+            cache.weightIDs.reserve(1 + altWeightObjects.size());
+            cache.weightIDs.emplace_back("nominal");
+            
+            for (auto const &w: altWeightObjects)
+                cache.weightIDs.emplace_back(w.id);
+            
+            cache.sumWeights.resize(cache.weightIDs.size());
+        }
     }
     
     
@@ -105,53 +109,71 @@ void LHEEventWeights::analyze(Event const &event, EventSetup const &)
     
     
     // The nominal weight
-    double const nominalWeight = lheEventInfo->originalXWGTUP() * factor;
+    cache.nominalWeight = lheEventInfo->originalXWGTUP() * factor;
     
     
     // Alternative weights
-    altWeights.clear();
+    cache.altWeights.clear();
     
     for (gen::WeightsInfo const &weight: altWeightObjects)
-        altWeights.push_back(weight.wgt * factor);
+        cache.altWeights.push_back(weight.wgt * factor);
     
     
-        
-    // Update means if requested
+    // Update sums if requested
     if (computeMeanWeights)
     {
-        // Use online algorithm described here [1]
-        //[1] https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#Online_algorithm
-        meanWeights.front().second +=
-         (nominalWeight - meanWeights.front().second) / (nEventsProcessed + 1);
-        
-        for (unsigned i = 0; i < altWeights.size(); ++i)
+        if (cache.altWeights.size() + 1 != cache.sumWeights.size())
         {
-            meanWeights.at(i + 1).second +=
-             (altWeights.at(i) - meanWeights.at(i + 1).second) / (nEventsProcessed + 1);
+            Exception excp(errors::LogicError);
+            excp << "Number of alternative weights in the current event (" <<
+              cache.altWeights.size() << ") differs from that in the first event (" <<
+              cache.sumWeights.size() - 1 << ").";
+            excp.raise();
         }
-    }
-    
-    
-    // Fill the output tree if requested
-    if (storeWeights)
-    {
-        bfNominalWeight = nominalWeight;
-        bfNumAltWeights = altWeights.size();
-        
-        for (unsigned i = 0; i < altWeights.size(); ++i)
-            bfAltWeights[i] = altWeights.at(i);
         
+        cache.sumWeights.front().Fill(cache.nominalWeight);
         
-        outTree->Fill();
+        for (unsigned i = 0; i < cache.altWeights.size(); ++i)
+            cache.sumWeights[i + 1].Fill(cache.altWeights[i]);
     }
     
     
     // Update event counter
-    ++nEventsProcessed;
+    ++cache.nEventsProcessed;
+    
+    
+    // Request filling of the output tree if needed
+    if (storeWeights)
+        treeFillService->Commit(this, streamID);
 }
 
 
-void LHEEventWeights::endRun(Run const &run, EventSetup const &)
+void LHEEventWeights::beginJob()
+{
+    if (not storeWeights)
+        return;
+    
+    
+    // Create the tree and setup its branches. The branch with alternative weights will be added
+    //when the tree is filled for the first time
+    outTree = treeFillService->BookTree(this, "EventWeights", "Generator-level event weights");
+    
+    outTree->Branch(BranchName("nominalWeight").c_str(), &bfNominalWeight);
+    outTree->Branch(BranchName("numAltWeights").c_str(), &bfNumAltWeights);
+}
+
+
+unique_ptr<LHEEventWeightsStreamCache> LHEEventWeights::beginStream(StreamID) const
+{
+    return make_unique<LHEEventWeightsStreamCache>();
+}
+
+
+void LHEEventWeights::globalBeginRun(Run const &, EventSetup const &) const
+{}
+
+
+void LHEEventWeights::globalEndRun(Run const &run, EventSetup const &) const
 {
     // Print description of LHE weights from the LHE header
     
@@ -288,44 +310,93 @@ void LHEEventWeights::endJob()
     // Print mean values of weights into the selected output stream
     out << "Mean values of event weights:\n index   ID   mean\n\n";
     out.precision(10);
-    out << "   -   nominal   " << meanWeights.front().second << "\n\n";
     
-    for (unsigned i = 1; i < meanWeights.size(); ++i)
+    if (not sumWeights.empty())
     {
-        auto const &w = meanWeights.at(i);
-        out << " " << setw(3) << i - 1 << "   " << w.first << "   " << w.second << '\n';
+        out << "   -   nominal   " << sumWeights.front().GetSum() / nEventsProcessed << "\n\n";
+        
+        for (unsigned i = 1; i < sumWeights.size(); ++i)
+            out << " " << setw(3) << i - 1 << "   " << weightIDs[i] << "   " <<
+              sumWeights[i].GetSum() / nEventsProcessed << '\n';
     }
     
     out << endl;
 }
 
 
-void LHEEventWeights::SetupWeightMeans(vector<gen::WeightsInfo> const &altWeights)
+void LHEEventWeights::endStream(StreamID streamID) const
 {
-    meanWeights.reserve(1 + altWeights.size());
+    LHEEventWeightsStreamCache const &cache = *streamCache(streamID);
+    
+    // Sums are only set up in a stream once it has processed an event
+    if (cache.nEventsProcessed == 0 or not computeMeanWeights)
+        return;
+    
     
+    lock_guard<mutex> lock(mergeMutex);
     
-    // Set text IDs for all weights and set their means to zeros
-    meanWeights.emplace_back("nominal", 0.);
+    if (sumWeights.empty())
+    {
+        weightIDs = cache.weightIDs;
+        sumWeights.resize(cache.sumWeights.size());
+    }
+    
+    if (weightIDs != cache.weightIDs)
+    {
+        Exception excp(errors::LogicError);
+        excp << "Sets of LHE weights differ between streams.";
+        excp.raise();
+    }
     
-    for (auto const &w: altWeights)
-        meanWeights.emplace_back(w.id, 0.);
+    for (unsigned i = 0; i < sumWeights.size(); ++i)
+        sumWeights[i].Merge(cache.sumWeights[i]);
+    
+    nEventsProcessed += cache.nEventsProcessed;
+}
+
+
+void LHEEventWeights::AllocateSlots(unsigned numSlots)
+{
+    stagedWeights.resize(numSlots);
+}
+
+
+void LHEEventWeights::StageEntry(StreamID streamID, unsigned slot)
+{
+    LHEEventWeightsStreamCache &cache = *streamCache(streamID);
+    StagedWeights &staged = stagedWeights[slot];
+    
+    // The vector of alternative weights is cleared at the beginning of each event, so it can be
+    //swapped
+    staged.nominalWeight = cache.nominalWeight;
+    swap(staged.altWeights, cache.altWeights);
 }
 
 
-void LHEEventWeights::SetupWeightTree(unsigned nAltWeights)
+void LHEEventWeights::MoveToTree(unsigned slot)
 {
-    // Allocate a buffer to store alternative weights
-    bfNumAltWeights = nAltWeights;
-    bfAltWeights = new Float_t[nAltWeights];
+    StagedWeights const &staged = stagedWeights[slot];
+    
+    bfNominalWeight = staged.nominalWeight;
+    bfNumAltWeights = staged.altWeights.size();
+    
+    
+    // Create the branch with alternative weights when the tree is filled for the first time, and
+    //update its address if the buffer has been reallocated
+    Float_t const *prevAddress = bfAltWeights.data();
+    
+    if (bfAltWeights.size() < staged.altWeights.size())
+        bfAltWeights.resize(staged.altWeights.size());
     
+    string const branchName = BranchName("altWeights");
     
-    // Create the tree and setup its branches
-    outTree = fileService->make<TTree>("EventWeights", "Generator-level event weights");
+    if (not outTree->GetBranch(branchName.c_str()))
+        outTree->Branch(branchName.c_str(), bfAltWeights.data(),
+          (branchName + "[" + BranchName("numAltWeights") + "]/F").c_str());
+    else if (bfAltWeights.data() != prevAddress)
+        outTree->SetBranchAddress(branchName.c_str(), bfAltWeights.data());
     
-    outTree->Branch("nominalWeight", &bfNominalWeight);
-    outTree->Branch("numAltWeights", &bfNumAltWeights);
-    outTree->Branch("altWeights", bfAltWeights, "altWeights[numAltWeights]/F");
+    copy(staged.altWeights.begin(), staged.altWeights.end(), bfAltWeights.begin());
 }
 
 
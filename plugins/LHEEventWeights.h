@@ -1,6 +1,9 @@
 #pragma once
 
-#include <FWCore/Framework/interface/EDAnalyzer.h>
+#include "SignedKahanSum.h"
+#include "TreeFillService.h"
+
+#include <FWCore/Framework/interface/global/EDAnalyzer.h>
 #include <FWCore/Framework/interface/Event.h>
 #include <FWCore/ParameterSet/interface/ParameterSet.h>
 #include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
@@ -11,13 +14,41 @@
 #include <SimDataFormats/GeneratorProducts/interface/GenEventInfoProduct.h>
 
 #include <FWCore/ServiceRegistry/interface/Service.h>
-#include <CommonTools/UtilAlgos/interface/TFileService.h>
 
 #include <TTree.h>
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
-#include <utility>
+
+
+/**
+ * \struct LHEEventWeightsStreamCache
+ * \brief Weights of the current event and sums of weights accumulated in a single stream
+ */
+struct LHEEventWeightsStreamCache
+{
+    /// Nominal weight in the current event
+    double nominalWeight = 0.;
+    
+    /// (Possibly rescaled) alternative LHE weights in the current event
+    std::vector<double> altWeights;
+    
+    /**
+     * \brief Text IDs of all weights
+     * 
+     * Set up when the first event in the stream is processed. The first element corresponds to
+     * the nominal weight.
+     */
+    std::vector<std::string> weightIDs;
+    
+    /// Sums of nominal and alternative weights, in the same order as in weightIDs
+    std::vector<SignedKahanSum> sumWeights;
+    
+    /// Number of events processed in the stream
+    unsigned long long nEventsProcessed = 0;
+};
 
 
 /**
@@ -29,8 +60,15 @@
  * of all weights in the current job. The output is either printed to the standard output or
  * directed to text files, depending on the configuration. User can also configure the plugin to
  * store weights in all events in a ROOT file.
+ * 
+ * Events are processed concurrently. Each stream accumulates its own sums of weights, which are
+ * merged when the stream ends. Mean weights are computed from the merged sums in endJob. The tree
+ * with per-event weights is written through TreeFillService, so that it can be used as a friend of
+ * trees written by PEC plugins.
  */
-class LHEEventWeights: public edm::EDAnalyzer
+class LHEEventWeights:
+  public edm::global::EDAnalyzer<edm::StreamCache<LHEEventWeightsStreamCache>, edm::WatchRuns>,
+  public TreeFillService::Client
 {
 public:
     /**
@@ -40,15 +78,22 @@ public:
      */
     LHEEventWeights(edm::ParameterSet const &cfg);
     
-    /// Destructor
-    ~LHEEventWeights();
-    
 public:
     /// Verifies configuration of the plugin
     static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
     
-    /// Stores weights and updates their mean values (if requested)
-    virtual void analyze(edm::Event const &event, edm::EventSetup const &) override;
+    /// Stores weights and updates their sums in the given stream (if requested)
+    virtual void analyze(edm::StreamID streamID, edm::Event const &event, edm::EventSetup const &)
+      const override;
+    
+    /// Creates the output tree if requested
+    virtual void beginJob() override;
+    
+    /// Creates an empty cache for a new stream
+    virtual std::unique_ptr<LHEEventWeightsStreamCache> beginStream(edm::StreamID) const override;
+    
+    /// Does nothing
+    virtual void globalBeginRun(edm::Run const &, edm::EventSetup const &) const override;
     
     /**
      * \brief Prints out description of alternative weights as provided in the LHE header
@@ -57,21 +102,30 @@ public:
      * of technical limitations, see e.g. here [1].
      * [1] https://hypernews.cern.ch/HyperNews/CMS/get/physTools/3437.html
      */
-    virtual void endRun(edm::Run const &run, edm::EventSetup const &) override;
+    virtual void globalEndRun(edm::Run const &run, edm::EventSetup const &) const override;
     
     /// Prints out mean values of the nominal and alternative weights
     virtual void endJob() override;
     
-private:
-    /**
-     * \brief Sets up running means of nominal and alternative weights while processing first event
-     * 
-     * IDs of alternative weights are read from the given vector.
-     */
-    void SetupWeightMeans(std::vector<gen::WeightsInfo> const &altWeights);
+    /// Adds sums of weights accumulated in the given stream to the totals
+    virtual void endStream(edm::StreamID streamID) const override;
     
-    /// Sets up the tree to store event weights
-    void SetupWeightTree(unsigned nAltWeights);
+    /// Allocates buffers for staging slots of TreeFillService
+    virtual void AllocateSlots(unsigned numSlots) override;
+    
+    /// Moves weights from the given stream into the given staging slot
+    virtual void StageEntry(edm::StreamID streamID, unsigned slot) override;
+    
+    /// Copies weights from the given staging slot into buffers of the output tree
+    virtual void MoveToTree(unsigned slot) override;
+    
+private:
+    /// Weights of an event queued for writing
+    struct StagedWeights
+    {
+        double nominalWeight = 0.;
+        std::vector<double> altWeights;
+    };
     
 private:
     /// Token to access per-run LHE information
@@ -114,28 +168,30 @@ private:
     bool printToFiles;
     
     
-    /// Buffer to keep (possibly rescaled) alternative LHE weights
-    std::vector<double> altWeights;
+    /// Mutex to protect the totals below when they are updated at the end of a stream
+    mutable std::mutex mergeMutex;
     
     /**
-     * \brief Running means of nominal and alternative weights
+     * \brief Text IDs of all weights
      * 
-     * Pairs stored in this vector consist of text IDs of weights and their current mean values,
-     * which are updated with every new event. The first element of the vector corresponds to the
-     * nominal weight. It is followed by pairs for alternative weights, keeping their ordering.
+     * The first element corresponds to the nominal weight. It is followed by IDs of alternative
+     * weights, keeping their ordering. Set when sums from the first stream are merged.
      */
-    std::vector<std::pair<std::string, double>> meanWeights;
+    mutable std::vector<std::string> weightIDs;
+    
+    /// Sums of nominal and alternative weights, in the same order as in weightIDs
+    mutable std::vector<SignedKahanSum> sumWeights;
     
     /**
      * \brief Total number of events processed
      * 
-     * This counter is needed to update mean values of weights.
+     * This counter is needed to compute mean values of weights.
      */
-    unsigned long long nEventsProcessed;
+    mutable unsigned long long nEventsProcessed;
     
     
-    /// An object to handle the output ROOT file
-    edm::Service<TFileService> fileService;
+    /// Service that fills the output tree
+    edm::Service<TreeFillService> treeFillService;
     
     /**
      * \brief Output tree
@@ -158,7 +214,12 @@ private:
     /**
      * \brief Alternative weights
      * 
-     * Pointer to a dynamically allocated array. The array is owned by this.
+     * The branch for alternative weights is created when the tree is filled for the first time
+     * since only then the number of weights is known. If the vector is reallocated later, the
+     * address of the branch is updated.
      */
-    Float_t *bfAltWeights;
+    std::vector<Float_t> bfAltWeights;
+    
+    /// Weights of events queued for writing, indexed with staging slot
+    std::vector<StagedWeights> stagedWeights;
 };
@@ -0,0 +1,116 @@
+#include "LumiMaskFilter.h"
+
+#include <FWCore/Framework/interface/MakerMacros.h>
+#include <FWCore/ParameterSet/interface/ParameterSetDescription.h>
+#include <FWCore/Utilities/interface/EDMException.h>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+using namespace edm;
+using namespace std;
+
+
+LumiMaskFilter::LumiMaskFilter(ParameterSet const &cfg):
+    noLumis(make_shared<IndexIntervals>(vector<IndexIntervals::index_t>()))
+{
+    string const lumiMaskFileName(cfg.getParameter<string>("lumiMask"));
+    boost::property_tree::ptree root;
+    
+    try
+    {
+        boost::property_tree::read_json(lumiMaskFileName, root);
+    }
+    catch (boost::property_tree::json_parser_error const &e)
+    {
+        Exception excp(errors::Configuration);
+        excp << "Failed to parse luminosity mask \"" << lumiMaskFileName << "\": " << e.what() <<
+         '\n';
+        excp.raise();
+    }
+    
+    
+    // Convert the list of ranges for each run into a set of intervals. The JSON format is
+    //{"run": [[first, last], ...], ...}, and ranges in it are stored as arrays, i.e. as nodes with
+    //empty keys
+    for (auto const &runNode: root)
+    {
+        RunNumber_t run;
+        vector<IndexIntervals::index_t> edges;
+        
+        try
+        {
+            run = stoul(runNode.first);
+            
+            for (auto const &rangeNode: runNode.second)
+            {
+                if (rangeNode.second.size() != 2)
+                    throw runtime_error("A range of luminosity blocks must contain two numbers.");
+                
+                for (auto const &edgeNode: rangeNode.second)
+                    edges.emplace_back(edgeNode.second.get_value<IndexIntervals::index_t>());
+            }
+            
+            lumiMask[run] = make_shared<IndexIntervals>(edges);
+        }
+        catch (exception const &e)
+        {
+            Exception excp(errors::Configuration);
+            excp << "Failed to parse entry \"" << runNode.first << "\" in luminosity mask \"" <<
+             lumiMaskFileName << "\": " << e.what() << '\n';
+            excp.raise();
+        }
+    }
+}
+
+
+void LumiMaskFilter::fillDescriptions(ConfigurationDescriptions &descriptions)
+{
+    ParameterSetDescription desc;
+    desc.add<string>("lumiMask")->
+     setComment("Path to a luminosity mask in the standard JSON format.");
+    
+    descriptions.add("lumiMaskFilter", desc);
+}
+
+
+shared_ptr<IndexIntervals> LumiMaskFilter::globalBeginRun(Run const &run, EventSetup const &)
+  const
+{
+    auto const res = lumiMask.find(run.run());
+    
+    if (res == lumiMask.end())
+        return noLumis;
+    else
+        return res->second;
+}
+
+
+void LumiMaskFilter::globalEndRun(Run const &, EventSetup const &) const
+{}
+
+
+shared_ptr<bool> LumiMaskFilter::globalBeginLuminosityBlock(LuminosityBlock const &lumi,
+  EventSetup const &) const
+{
+    IndexIntervals const &lumiIntervals = *runCache(lumi.getRun().index());
+    return make_shared<bool>(lumiIntervals.Contain(lumi.luminosityBlock()));
+}
+
+
+void LumiMaskFilter::globalEndLuminosityBlock(LuminosityBlock const &, EventSetup const &) const
+{}
+
+
+bool LumiMaskFilter::filter(StreamID, Event &event, EventSetup const &) const
+{
+    return *luminosityBlockCache(event.getLuminosityBlock().index());
+}
+
+
+DEFINE_FWK_MODULE(LumiMaskFilter);
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "IndexIntervals.h"
+
+#include <FWCore/Framework/interface/global/EDFilter.h>
+#include <FWCore/Framework/interface/Event.h>
+#include <FWCore/Framework/interface/LuminosityBlock.h>
+#include <FWCore/Framework/interface/Run.h>
+#include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
+#include <FWCore/ParameterSet/interface/ParameterSet.h>
+
+#include <map>
+#include <memory>
+
+
+/**
+ * \class LumiMaskFilter
+ * \brief Selects events from luminosity blocks listed in a luminosity mask
+ * 
+ * The mask is read from a file in the standard JSON format, which maps run numbers to lists of
+ * closed ranges [first, last] of luminosity blocks. Ranges of each run are put into an
+ * IndexIntervals object. All events from runs not included in the mask are rejected.
+ * 
+ * The decision is made once per luminosity block. The set of intervals for the current run is
+ * found at the beginning of the run and shared between all streams, and at the beginning of each
+ * luminosity block it is checked with IndexIntervals::Contain. The result is cached, and the
+ * decision for an individual event only requires reading the cached flag. The framework does not
+ * allow a filter to skip a whole luminosity block, so events from rejected blocks are still read
+ * but are rejected without any further computation.
+ */
+class LumiMaskFilter:
+  public edm::global::EDFilter<edm::RunCache<IndexIntervals>, edm::LuminosityBlockCache<bool>>
+{
+public:
+    /// Constructor
+    LumiMaskFilter(edm::ParameterSet const &cfg);
+    
+public:
+    /// Verifies configuration of the plugin
+    static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
+    
+    /// Finds intervals of luminosity blocks for the new run
+    virtual std::shared_ptr<IndexIntervals> globalBeginRun(edm::Run const &run,
+      edm::EventSetup const &) const override;
+    
+    /// Does nothing. Required by the framework
+    virtual void globalEndRun(edm::Run const &, edm::EventSetup const &) const override;
+    
+    /// Checks if the new luminosity block is included in the mask
+    virtual std::shared_ptr<bool> globalBeginLuminosityBlock(edm::LuminosityBlock const &lumi,
+      edm::EventSetup const &) const override;
+    
+    /// Does nothing. Required by the framework
+    virtual void globalEndLuminosityBlock(edm::LuminosityBlock const &, edm::EventSetup const &)
+      const override;
+    
+    /// Accepts the event if its luminosity block is included in the mask
+    virtual bool filter(edm::StreamID, edm::Event &event, edm::EventSetup const &) const override;
+    
+private:
+    /// Intervals of luminosity blocks to select, for each run included in the mask
+    std::map<edm::RunNumber_t, std::shared_ptr<IndexIntervals>> lumiMask;
+    
+    /// Empty set of intervals for runs not present in the mask
+    std::shared_ptr<IndexIntervals> noLumis;
+};
@@ -16,6 +16,7 @@ using namespace std;
 PECElectrons::PECElectrons(ParameterSet const &cfg):
     embeddedBoolIDLabels(cfg.getParameter<vector<string>>("embeddedBoolIDs")),
     embeddedContIDLabels(cfg.getParameter<vector<string>>("embeddedContIDs")),
+    flatBranches(cfg.getParameter<bool>("flatBranches")),
     eaReader((cfg.getParameter<FileInPath>("effAreas")).fullPath())
 {
     // Register required input data
@@ -58,6 +59,8 @@ void PECElectrons::fillDescriptions(ConfigurationDescriptions &descriptions)
     desc.add<vector<string>>("selection", vector<string>(0))->
       setComment("User-defined selections for electrons whose results will be stored in the "
       "output tree.");
+    desc.add<bool>("flatBranches", false)->
+      setComment("Requests storing electrons in counter-plus-array leaf branches.");
     
     descriptions.add("electrons", desc);
 }
@@ -65,15 +68,78 @@ void PECElectrons::fillDescriptions(ConfigurationDescriptions &descriptions)
 
 void PECElectrons::beginJob()
 {
-    outTree = fileService->make<TTree>("Electrons", "Properties of selected electrons");
+    outTree = treeFillService->BookTree(this, "Electrons", "Properties of selected electrons");
     
-    storeElectronsPointer = &storeElectrons;
-    outTree->Branch("electrons", &storeElectronsPointer);
+    if (not flatBranches)
+    {
+        storeElectronsPointer = &storeElectrons;
+        outTree->Branch(BranchName("electrons").c_str(), &storeElectronsPointer);
+    }
+    else
+    {
+        using Electron = pec::Electron;
+        flatElectrons.reset(new FlatBranches<Electron>(outTree, "nElectron"));
+        
+        flatElectrons->AddMemberColumn("Electron_pt", "pt",
+          [](Electron const &e){return e.Pt();});
+        flatElectrons->AddMemberColumn("Electron_eta", "eta",
+          [](Electron const &e){return e.Eta();});
+        flatElectrons->AddMemberColumn("Electron_phi", "phi",
+          [](Electron const &e){return e.Phi();});
+        flatElectrons->AddMemberColumn<Int_t>("Electron_charge", "charge",
+          [](Electron const &e){return e.Charge();});
+        flatElectrons->AddMemberColumn("Electron_relIso", "relIso",
+          [](Electron const &e){return e.RelIso();});
+        flatElectrons->AddMemberColumn<UChar_t>("Electron_bits", "id", [](Electron const &e)
+        {
+            UChar_t bits = 0;
+            
+            for (unsigned i = 0; i < 8; ++i)
+                bits |= (e.TestBit(i) << i);
+            
+            return bits;
+        });
+        
+        flatElectrons->AddMemberColumn("Electron_etaSC", "etaSC",
+          [](Electron const &e){return e.EtaSC();});
+        flatElectrons->AddMemberColumn<UChar_t>("Electron_boolIDs", "cutBasedId",
+          [](Electron const &e)
+        {
+            UChar_t bits = 0;
+            
+            for (unsigned i = 0; i < 8; ++i)
+                bits |= (e.BooleanID(i) << i);
+            
+            return bits;
+        });
+        
+        // Only create columns for real-valued IDs that are actually filled
+        unsigned const nContIDs = embeddedContIDLabels.size() + contIDMapTokens.size();
+        
+        for (unsigned i = 0; i < nContIDs; ++i)
+            flatElectrons->AddMemberColumn("Electron_contID" + to_string(i), "mvaId",
+              [i](Electron const &e){return e.ContinuousID(i);});
+        
+        // The mass of leptons is never set, and it is not stored
+        if (nContIDs > 0)
+            flatElectrons->CheckMembers({"mass"});
+        else
+            flatElectrons->CheckMembers({"mass", "mvaId"});
+    }
 }
 
 
-void PECElectrons::analyze(Event const &event, EventSetup const &)
+unique_ptr<vector<pec::Electron>> PECElectrons::beginStream(StreamID) const
 {
+    return make_unique<vector<pec::Electron>>();
+}
+
+
+void PECElectrons::analyze(StreamID streamID, Event const &event, EventSetup const &) const
+{
+    vector<pec::Electron> &buffer = *streamCache(streamID);
+    
+    
     // Read the electron collection and rho
     Handle<View<pat::Electron>> srcElectrons;
     Handle<double> rho;
@@ -108,7 +174,7 @@ void PECElectrons::analyze(Event const &event, EventSetup const &)
     
     
     // Loop through the collection and store relevant properties of electrons
-    storeElectrons.clear();
+    buffer.clear();
     pec::Electron storeElectron;  // will reuse this object to fill the vector
     
     for (unsigned i = 0; i < srcElectrons->size(); ++i)
@@ -189,12 +255,31 @@ void PECElectrons::analyze(Event const &event, EventSetup const &)
         
         
         // The electron is set up. Add it to the vector.
-        storeElectrons.emplace_back(storeElectron);
+        buffer.emplace_back(storeElectron);
     }
     
-    
-    // Fill the output tree
-    outTree->Fill();
+    treeFillService->Commit(this, streamID);
+}
+
+
+void PECElectrons::AllocateSlots(unsigned numSlots)
+{
+    stagedElectrons.resize(numSlots);
+}
+
+
+void PECElectrons::StageEntry(StreamID streamID, unsigned slot)
+{
+    swap(stagedElectrons[slot], *streamCache(streamID));
+}
+
+
+void PECElectrons::MoveToTree(unsigned slot)
+{
+    if (not flatBranches)
+        swap(storeElectrons, stagedElectrons[slot]);
+    else
+        flatElectrons->Fill(stagedElectrons[slot]);
 }
 
 
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <Analysis/PECTuples/interface/Electron.h>
+#include "CompiledSelector.h"
+#include "FlatBranches.h"
+#include "TreeFillService.h"
 
-#include <FWCore/Framework/interface/EDAnalyzer.h>
+#include <FWCore/Framework/interface/global/EDAnalyzer.h>
 #include <FWCore/Framework/interface/Event.h>
 #include <FWCore/ParameterSet/interface/ParameterSet.h>
 #include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
@@ -11,13 +14,12 @@
 #include <DataFormats/PatCandidates/interface/Electron.h>
 #include <DataFormats/VertexReco/interface/VertexFwd.h>
 #include <RecoEgamma/EgammaTools/interface/EffectiveAreas.h>
-#include <CommonTools/Utils/interface/StringCutObjectSelector.h>
 
 #include <FWCore/ServiceRegistry/interface/Service.h>
-#include <CommonTools/UtilAlgos/interface/TFileService.h>
 
 #include <TTree.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -36,8 +38,17 @@
  * configuration. In addition, it can include boolean and real-valued decisions provided in the
  * form of value maps. All these IDs are optional. It also stores the value of the dicriminator for
  * non-triggering MVA ID; the access to it is hard-coded.
+ * 
+ * If parameter "flatBranches" is set, electrons are written in counter-plus-array leaf branches
+ * (nElectron, Electron_pt[nElectron], etc.) instead of an object branch. They can be read without
+ * the dictionary for PEC classes. Real-valued properties are stored with the same precision as
+ * the corresponding data members of pec::Electron.
+ * 
+ * Selected electrons are collected in a separate buffer for each stream, and values of real-valued
+ * IDs from ValueMaps are read there as well.
  */
-class PECElectrons: public edm::EDAnalyzer
+class PECElectrons: public edm::global::EDAnalyzer<edm::StreamCache<std::vector<pec::Electron>>>,
+  public TreeFillService::Client
 {
 public:
     /**
@@ -51,15 +62,28 @@ public:
     /// Verifies configuration of the plugin
     static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
     
-    /// Creates output tree
+    /// Creates output tree and registers it in TreeFillService
     virtual void beginJob() override;
     
+    /// Creates a buffer for the given stream
+    virtual std::unique_ptr<std::vector<pec::Electron>> beginStream(edm::StreamID) const override;
+    
     /**
      * \brief Analyses current event
      * 
-     * Copies electrons into the buffers, evaluates string-based selections, fills the output tree.
+     * Copies electrons into the buffer of the stream and evaluates string-based selections.
      */
-    virtual void analyze(edm::Event const &event, edm::EventSetup const &) override;
+    virtual void analyze(edm::StreamID streamID, edm::Event const &event, edm::EventSetup const &)
+      const override;
+    
+    /// Allocates buffers for staging slots of TreeFillService
+    virtual void AllocateSlots(unsigned numSlots) override;
+    
+    /// Moves content of the buffer of the given stream into the buffer of the given staging slot
+    virtual void StageEntry(edm::StreamID streamID, unsigned slot) override;
+    
+    /// Moves content of the buffer of the given staging slot into the buffer of the output tree
+    virtual void MoveToTree(unsigned slot) override;
     
 private:
     /**
@@ -104,11 +128,14 @@ private:
      * Details on implementation are documented in [1].
      * [1] https://twiki.cern.ch/twiki/bin/view/CMSPublic/SWGuidePhysicsCutParser
      */
-    std::vector<StringCutObjectSelector<pat::Electron>> eleSelectors;
+    std::vector<CompiledSelector<pat::Electron>> eleSelectors;
     
+    /// Requests storing electrons in flat branches instead of an object branch
+    bool const flatBranches;
     
-    /// An object to handle the output ROOT file
-    edm::Service<TFileService> fileService;
+    
+    /// Service that fills the output tree
+    edm::Service<TreeFillService> treeFillService;
     
     
     /// An object to access effective areas for electron isolation
@@ -118,6 +145,9 @@ private:
     /// Output tree
     TTree *outTree;
     
+    /// Electrons of events queued for writing, indexed with staging slot
+    std::vector<std::vector<pec::Electron>> stagedElectrons;
+    
     /// Buffer to store electrons
     std::vector<pec::Electron> storeElectrons;
     
@@ -127,4 +157,12 @@ private:
      * ROOT needs a variable with a pointer to an object to store the object in a tree.
      */
     std::vector<pec::Electron> *storeElectronsPointer;
+    
+    /**
+     * \brief Flat branches for electrons
+     * 
+     * Only created if flat branches are requested. In this case the buffer of objects above is not
+     * used.
+     */
+    std::unique_ptr<FlatBranches<pec::Electron>> flatElectrons;
 };
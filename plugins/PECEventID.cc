@@ -3,46 +3,148 @@
 #include <FWCore/Utilities/interface/InputTag.h>
 #include <FWCore/Framework/interface/MakerMacros.h>
 
+#include <algorithm>
+#include <tuple>
+
 using namespace edm;
 
 
-PECEventID::PECEventID(ParameterSet const &)
-{}
+PECEventID::PECEventID(ParameterSet const &cfg)
+{
+    InputTag const generatorTag(cfg.getParameter<InputTag>("generator"));
+    
+    if (generatorTag.label() != "")
+        generatorToken = consumes<GenEventInfoProduct>(generatorTag);
+}
 
 
 void PECEventID::fillDescriptions(ConfigurationDescriptions &descriptions)
 {
     ParameterSetDescription desc;
+    desc.add<InputTag>("generator", InputTag(""))->
+      setComment("Tag to access GenEventInfoProduct to sum up weights of selected events in "
+        "luminosity blocks. An empty value (\"\") means that weights are not read.");
+    
     descriptions.add("eventID", desc);
-    //^ The configuration is trivial
 }
 
 
 void PECEventID::beginJob()
 {
-    outTree = fileService->make<TTree>("EventID", "Event ID");
+    outTree = treeFillService->BookTree(this, "EventID", "Event ID");
     
     eventIdPointer = &eventId;
-    outTree->Branch("eventId", &eventIdPointer);
+    outTree->Branch(BranchName("eventId").c_str(), &eventIdPointer);
+}
+
+
+void PECEventID::endJob()
+{
+    std::sort(index.begin(), index.end(), [](IndexRecord const &a, IndexRecord const &b)
+    {
+        return std::tie(a.run, a.lumi, a.event) < std::tie(b.run, b.lumi, b.event);
+    });
+    
+    TTree *indexTree = fileService->make<TTree>("EventIndex",
+      "Entries of events in the EventID tree, sorted by event ID");
+    
+    IndexRecord record;
+    indexTree->Branch("run", &record.run);
+    indexTree->Branch("lumi", &record.lumi);
+    indexTree->Branch("event", &record.event);
+    indexTree->Branch("entry", &record.entry);
+    
+    for (auto const &r: index)
+    {
+        record = r;
+        indexTree->Fill();
+    }
+    
+    
+    TTree *lumiTree = fileService->make<TTree>("LumiBlocks",
+      "Ranges of entries in the EventID tree for luminosity blocks");
+    
+    LumiBlock block;
+    lumiTree->Branch("run", &block.run);
+    lumiTree->Branch("lumi", &block.lumi);
+    lumiTree->Branch("firstEntry", &block.firstEntry);
+    lumiTree->Branch("numEntries", &block.numEntries);
+    lumiTree->Branch("sumSelectedWeights", &block.sumSelectedWeights);
+    
+    for (auto const &b: lumiBlocks)
+    {
+        block = b;
+        lumiTree->Fill();
+    }
+}
+
+
+std::unique_ptr<PECEventIDBuffers> PECEventID::beginStream(StreamID) const
+{
+    return std::make_unique<PECEventIDBuffers>();
 }
 
 
-void PECEventID::analyze(edm::Event const &event, edm::EventSetup const &)
+void PECEventID::analyze(StreamID streamID, Event const &event, EventSetup const &) const
 {
+    PECEventIDBuffers &buffers = *streamCache(streamID);
+    pec::EventID &buffer = buffers.eventId;
+    
     // Reset the buffer from the previous event
-    eventId.Reset();
+    buffer.Reset();
     
     
-    eventId.SetRunNumber(event.id().run());
-    eventId.SetEventNumber(event.id().event());
-    eventId.SetLumiSectionNumber(event.luminosityBlock());
+    buffer.SetRunNumber(event.id().run());
+    buffer.SetEventNumber(event.id().event());
+    buffer.SetLumiSectionNumber(event.luminosityBlock());
     
     if (event.isRealData())
-        eventId.SetBunchCrossing(event.bunchCrossing());
+        buffer.SetBunchCrossing(event.bunchCrossing());
+    
+    if (not generatorToken.isUninitialized())
+    {
+        Handle<GenEventInfoProduct> generator;
+        event.getByToken(generatorToken, generator);
+        buffers.weight = generator->weight();
+    }
+    
+    treeFillService->Commit(this, streamID);
+}
+
+
+void PECEventID::AllocateSlots(unsigned numSlots)
+{
+    stagedBuffers.resize(numSlots);
+}
+
+
+void PECEventID::StageEntry(StreamID streamID, unsigned slot)
+{
+    stagedBuffers[slot] = *streamCache(streamID);
+}
+
+
+void PECEventID::MoveToTree(unsigned slot)
+{
+    PECEventIDBuffers const &buffers = stagedBuffers[slot];
+    eventId = buffers.eventId;
+    
+    // The tree is filled right after this method returns, so the current event will be written
+    //into the entry with this number
+    Long64_t const entry = outTree->GetEntries();
+    UInt_t const run = eventId.RunNumber(), lumi = eventId.LumiSectionNumber();
+    index.push_back({run, lumi, eventId.EventNumber(), entry});
     
     
-    // Fill the output tree
-    outTree->Fill();
+    // Extend the current luminosity block or start a new one
+    if (not lumiBlocks.empty() and lumiBlocks.back().run == run and
+      lumiBlocks.back().lumi == lumi)
+    {
+        ++lumiBlocks.back().numEntries;
+        lumiBlocks.back().sumSelectedWeights += buffers.weight;
+    }
+    else
+        lumiBlocks.push_back({run, lumi, entry, 1, buffers.weight});
 }
 
 
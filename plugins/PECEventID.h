@@ -1,50 +1,142 @@
 #pragma once
 
 #include <Analysis/PECTuples/interface/EventID.h>
+#include "TreeFillService.h"
 
-#include <FWCore/Framework/interface/EDAnalyzer.h>
+#include <FWCore/Framework/interface/global/EDAnalyzer.h>
 #include <FWCore/Framework/interface/Event.h>
 #include <FWCore/ParameterSet/interface/ParameterSet.h>
 #include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
 #include <FWCore/ParameterSet/interface/ParameterSetDescription.h>
 
-#include <FWCore/ServiceRegistry/interface/Service.h>
+#include <SimDataFormats/GeneratorProducts/interface/GenEventInfoProduct.h>
+
 #include <CommonTools/UtilAlgos/interface/TFileService.h>
+#include <FWCore/ServiceRegistry/interface/Service.h>
 
 #include <TTree.h>
 
+#include <memory>
+#include <vector>
+
+
+/**
+ * \struct PECEventIDBuffers
+ * \brief Per-stream buffers of plugin PECEventID
+ */
+struct PECEventIDBuffers
+{
+    /// ID of the current event
+    pec::EventID eventId;
+    
+    /// Nominal generator-level weight of the current event, or zero if not read
+    double weight = 0.;
+};
+
 
 /**
  * \class PECEventID
  * \brief Stores event ID (run, luminosity block, and event number)
+ * 
+ * In addition, the plugin remembers the ID of each event written to the output tree together with
+ * the number of the entry. At the end of the job these records are sorted by run, luminosity block,
+ * and event number and written into the tree "EventIndex" in the directory of the plugin. With the
+ * help of class pec::EventIndex or script eventIndex.py, entries of given events can then be found
+ * with a binary search instead of a scan of the whole file. Entry numbers are only valid for the
+ * file written by the job. After files are merged with hadd, the index must be rebuilt with
+ * eventIndex.py (this is done automatically by mergeCrabRes.py).
+ * 
+ * The plugin also writes a summary of luminosity blocks into the tree "LumiBlocks" in the same
+ * directory. Each entry describes a contiguous range of entries of the EventID tree that belong
+ * to the same luminosity block: run, lumi, firstEntry, numEntries, and sumSelectedWeights. The
+ * latter is the sum of nominal generator-level weights of events in the range. It is only computed
+ * if a GenEventInfoProduct is given with parameter "generator", and is zero otherwise. Since the
+ * plugin only sees events that have passed the event selection, this sum does not include rejected
+ * events, and luminosity blocks without selected events are not listed at all. Thus the summary
+ * cannot be used to normalize simulation; use the sums of weights from EventCounter, which runs
+ * before the selection, instead. Normally all events from a luminosity block are
+ * written consecutively, but when several of them are processed concurrently, their events can
+ * interleave, and then a block is described by several entries. This allows to apply a luminosity
+ * mask by reading only this small tree and converting the selected blocks into ranges of entries
+ * (see class pec::LumiBlocks and script eventIndex.py). Like the index of events, the summary
+ * must be rebuilt after merging.
  */
-class PECEventID: public edm::EDAnalyzer
+class PECEventID: public edm::global::EDAnalyzer<edm::StreamCache<PECEventIDBuffers>>,
+  public TreeFillService::Client
 {
 public:
-    /**
-     * \brief Constructor
-     * 
-     * The plugin has a trivial configuration, and thus the constructor does not read it.
-     */
-    PECEventID(edm::ParameterSet const &);
+    /// Constructor
+    PECEventID(edm::ParameterSet const &cfg);
     
 public:
     /// Verifies configuration of the plugin
     static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
     
-    /// Creates output tree
+    /// Creates output tree and registers it in TreeFillService
     virtual void beginJob() override;
     
-    /// Writes ID of the current event in the buffer and fills the output tree
-    virtual void analyze(edm::Event const &event, edm::EventSetup const &) override;
+    /// Sorts the event index and writes it and the summary of luminosity blocks into the output
+    virtual void endJob() override;
+    
+    /// Creates a buffer for the given stream
+    virtual std::unique_ptr<PECEventIDBuffers> beginStream(edm::StreamID) const override;
+    
+    /// Writes ID of the current event in the buffer of the stream
+    virtual void analyze(edm::StreamID streamID, edm::Event const &event, edm::EventSetup const &)
+      const override;
+    
+    /// Allocates buffers for staging slots of TreeFillService
+    virtual void AllocateSlots(unsigned numSlots) override;
+    
+    /// Copies event ID from the buffer of the given stream into the buffer of the given slot
+    virtual void StageEntry(edm::StreamID streamID, unsigned slot) override;
+    
+    /// Copies event ID from the buffer of the given staging slot into the buffer of the output tree
+    virtual void MoveToTree(unsigned slot) override;
     
 private:
+    /**
+     * \struct IndexRecord
+     * \brief Event ID and the number of the corresponding entry in the output tree
+     */
+    struct IndexRecord
+    {
+        UInt_t run, lumi;
+        ULong64_t event;
+        Long64_t entry;
+    };
+    
+    /**
+     * \struct LumiBlock
+     * \brief A contiguous range of entries in the output tree from the same luminosity block
+     */
+    struct LumiBlock
+    {
+        UInt_t run, lumi;
+        Long64_t firstEntry, numEntries;
+        Double_t sumSelectedWeights;
+    };
+    
+private:
+    /**
+     * \brief Token to access nominal generator-level weights
+     * 
+     * Not initialized if weights are not requested.
+     */
+    edm::EDGetTokenT<GenEventInfoProduct> generatorToken;
+    
+    /// Service that fills the output tree
+    edm::Service<TreeFillService> treeFillService;
+    
     /// An object to handle the output ROOT file
     edm::Service<TFileService> fileService;
     
     /// Output tree
     TTree *outTree;
     
+    /// Event IDs and weights of events queued for writing, indexed with staging slot
+    std::vector<PECEventIDBuffers> stagedBuffers;
+    
     /// Buffer to store event ID
     pec::EventID eventId;
     
@@ -54,4 +146,18 @@ private:
      * ROOT needs a variable with a pointer to an object to store the object in a tree.
      */
     pec::EventID *eventIdPointer;
+    
+    /**
+     * \brief Records for all events written to the output tree
+     * 
+     * Only accessed in MoveToTree, which is serialized by TreeFillService, and in endJob.
+     */
+    std::vector<IndexRecord> index;
+    
+    /**
+     * \brief Summary of luminosity blocks, in the order of entries
+     * 
+     * Accessed in the same way as the index above.
+     */
+    std::vector<LumiBlock> lumiBlocks;
 };
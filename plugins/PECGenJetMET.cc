@@ -51,23 +51,33 @@ void PECGenJetMET::fillDescriptions(ConfigurationDescriptions &descriptions)
 
 void PECGenJetMET::beginJob()
 {
-    tree = fs->make<TTree>("GenJetMET", "Properties of generator-level jets and generator-level "
-     "MET");
+    tree = treeFillService->BookTree(this, "GenJetMET",
+      "Properties of generator-level jets and generator-level MET");
     
     
     storeJetsPointer = &storeJets;
-    tree->Branch("jets", &storeJetsPointer);
+    tree->Branch(BranchName("jets").c_str(), &storeJetsPointer);
     
     if (metGiven)
     {
         storeMETsPointer = &storeMETs;
-        tree->Branch("METs", &storeMETsPointer);
+        tree->Branch(BranchName("METs").c_str(), &storeMETsPointer);
     }
 }
 
 
-void PECGenJetMET::analyze(edm::Event const &event, edm::EventSetup const &setup)
+unique_ptr<PECGenJetMETBuffers> PECGenJetMET::beginStream(edm::StreamID) const
 {
+    return make_unique<PECGenJetMETBuffers>();
+}
+
+
+void PECGenJetMET::analyze(edm::StreamID streamID, edm::Event const &event,
+  edm::EventSetup const &setup) const
+{
+    PECGenJetMETBuffers &buffers = *streamCache(streamID);
+    
+    
     // Read the collection of generator-level jets
     Handle<View<reco::GenJet>> jets;
     event.getByToken(jetToken, jets);
@@ -83,7 +93,7 @@ void PECGenJetMET::analyze(edm::Event const &event, edm::EventSetup const &setup
     
     
     // Loop over the jets
-    storeJets.clear();
+    buffers.jets.clear();
     pec::GenJet storeJet;  // will reuse same object to fill the vector
     
     for (unsigned i = 0; i < jets->size(); ++i)
@@ -185,7 +195,7 @@ void PECGenJetMET::analyze(edm::Event const &event, edm::EventSetup const &setup
             
             
             // Add the jet to the vector
-            storeJets.emplace_back(storeJet);
+            buffers.jets.emplace_back(storeJet);
         }
     }
     
@@ -198,18 +208,37 @@ void PECGenJetMET::analyze(edm::Event const &event, edm::EventSetup const &setup
         pat::MET const &met = metHandle->front();
         
         
-        storeMETs.clear();
+        buffers.METs.clear();
         
         pec::Candidate storeMET;
         storeMET.SetPt(met.genMET()->pt());
         storeMET.SetPhi(met.genMET()->phi());
         
-        storeMETs.emplace_back(storeMET);
+        buffers.METs.emplace_back(storeMET);
     }
     
+    treeFillService->Commit(this, streamID);
+}
+
+
+void PECGenJetMET::AllocateSlots(unsigned numSlots)
+{
+    stagedBuffers.resize(numSlots);
+}
+
+
+void PECGenJetMET::StageEntry(edm::StreamID streamID, unsigned slot)
+{
+    swap(stagedBuffers[slot], *streamCache(streamID));
+}
+
+
+void PECGenJetMET::MoveToTree(unsigned slot)
+{
+    PECGenJetMETBuffers &buffers = stagedBuffers[slot];
     
-    // Fill the output tree
-    tree->Fill();
+    swap(storeJets, buffers.jets);
+    swap(storeMETs, buffers.METs);
 }
 
 
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <Analysis/PECTuples/interface/GenJet.h>
+#include "CompiledSelector.h"
+#include "TreeFillService.h"
 
-#include <FWCore/Framework/interface/EDAnalyzer.h>
+#include <FWCore/Framework/interface/global/EDAnalyzer.h>
 #include <FWCore/Framework/interface/Event.h>
 #include <FWCore/ParameterSet/interface/ParameterSet.h>
 #include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
@@ -10,16 +12,26 @@
 
 #include <DataFormats/JetReco/interface/GenJet.h>
 #include <DataFormats/PatCandidates/interface/MET.h>
-#include <CommonTools/Utils/interface/StringCutObjectSelector.h>
 
 #include <FWCore/ServiceRegistry/interface/Service.h>
-#include <CommonTools/UtilAlgos/interface/TFileService.h>
 
 #include <TTree.h>
 
+#include <memory>
 #include <vector>
 
 
+/**
+ * \struct PECGenJetMETBuffers
+ * \brief Buffers with generator-level jets and MET filled in a single stream
+ */
+struct PECGenJetMETBuffers
+{
+    std::vector<pec::GenJet> jets;
+    std::vector<pec::Candidate> METs;
+};
+
+
 /**
  * \class PECGenJetMET
  * \brief A CMSSW plugin to save generator-level jets and MET
@@ -36,7 +48,8 @@
  * In an optional input tag for reconstructed (sic!) MET is provided, the corresponding
  * generator-level MET is also stored.
  */
-class PECGenJetMET: public edm::EDAnalyzer
+class PECGenJetMET: public edm::global::EDAnalyzer<edm::StreamCache<PECGenJetMETBuffers>>,
+  public TreeFillService::Client
 {
 public:
     /// Constructor from a configuration fragment
@@ -46,11 +59,24 @@ public:
     /// A method to verify plugin's configuration
     static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
     
-    /// Creates the output tree and assigns it branches
+    /// Creates the output tree, assigns it branches, and registers it in TreeFillService
     void beginJob() override;
     
-    /// Fills the output tree with generator-level jets
-    void analyze(edm::Event const &event, edm::EventSetup const &setup) override;
+    /// Creates buffers for the given stream
+    std::unique_ptr<PECGenJetMETBuffers> beginStream(edm::StreamID) const override;
+    
+    /// Writes generator-level jets and MET into the buffers of the stream
+    void analyze(edm::StreamID streamID, edm::Event const &event, edm::EventSetup const &setup)
+      const override;
+    
+    /// Allocates buffers for staging slots of TreeFillService
+    void AllocateSlots(unsigned numSlots) override;
+    
+    /// Moves content of buffers of the given stream into buffers of the given staging slot
+    void StageEntry(edm::StreamID streamID, unsigned slot) override;
+    
+    /// Moves content of buffers of the given staging slot into buffers of the output tree
+    void MoveToTree(unsigned slot) override;
     
 private:
     /// Collection of generator-level jets
@@ -64,7 +90,7 @@ private:
      * 
      * If the string is empty, all jets are saved.
      */
-    StringCutObjectSelector<reco::Candidate> const jetSelector;
+    CompiledSelector<reco::Candidate> const jetSelector;
     
     /// Indicates whether the plugin should store information on flavours of jet constituents
     bool const saveFlavourCounters;
@@ -80,13 +106,16 @@ private:
     bool metGiven;
     
     
-    /// A service to write to ROOT files
-    edm::Service<TFileService> fs;
+    /// Service that fills the output tree
+    edm::Service<TreeFillService> treeFillService;
     
     
     /// The output tree (owned by the TFile service)
     TTree *tree;
     
+    /// Generator-level jets and MET of events queued for writing, indexed with staging slot
+    std::vector<PECGenJetMETBuffers> stagedBuffers;
+    
     /**
      * \brief Trimmed generator-level jets to be stored in the output file
      * 
@@ -108,24 +108,39 @@ void PECGenParticles::fillDescriptions(ConfigurationDescriptions &descriptions)
 
 void PECGenParticles::beginJob()
 {
-    outTree = fileService->make<TTree>("HardInteraction",
+    outTree = treeFillService->BookTree(this, "HardInteraction",
      "Tree contrains generator-level particles from the hard interaction");
     
     storeParticlesPointer = &storeParticles;
-    outTree->Branch("particles", &storeParticlesPointer);
+    outTree->Branch(BranchName("particles").c_str(), &storeParticlesPointer);
 }
 
 
-void PECGenParticles::analyze(edm::Event const &event, edm::EventSetup const &setup)
+unique_ptr<vector<pec::GenParticle>> PECGenParticles::beginStream(StreamID) const
 {
+    return make_unique<vector<pec::GenParticle>>();
+}
+
+
+void PECGenParticles::analyze(StreamID streamID, edm::Event const &event,
+  edm::EventSetup const &setup) const
+{
+    vector<pec::GenParticle> &buffer = *streamCache(streamID);
+    
+    
     #ifdef DEBUG
     cout << "\033[1;34mEvent: " << event.id().run() << ":" << event.id().event() << "\033[0m\n\n";
     #endif
         
     
-    // Clear vectors of particles to be stored
-    bookedParticles.clear();
-    storeParticles.clear();
+    // Particles that are going to be stored. The container is utilised to keep track of paricles
+    //that have been accepted to be stored in the output file and helps to avoid duplicates.
+    //Pointers in elements of the container refer to particles in the collection read via
+    //genPartilcesToken. Original mothers of some of the particles are overridden.
+    vector<ParticleWithMother> bookedParticles;
+    
+    // Clear the buffer with particles to be stored
+    buffer.clear();
     
     
     // Read the generator-level particles
@@ -207,7 +222,7 @@ void PECGenParticles::analyze(edm::Event const &event, edm::EventSetup const &se
                 continue;
             
             
-            BookParticle(mother);
+            BookParticle(bookedParticles, mother);
         }
     }
     
@@ -224,14 +239,14 @@ void PECGenParticles::analyze(edm::Event const &event, edm::EventSetup const &se
     
     // Book particles from the final state
     for (auto const &p: meFinalState)
-        BookParticle(p);
+        BookParticle(bookedParticles, p);
     
     
     // Book additional particles requested by the user
     for (auto const &root: extraPartRoots)
     {
         // The oldest ancestor (the "root") found before
-        BookParticle(root);
+        BookParticle(bookedParticles, root);
                 
         
         // Move along descendants of the root until the youngest descendant of the same type is
@@ -271,7 +286,7 @@ void PECGenParticles::analyze(edm::Event const &event, edm::EventSetup const &se
                 continue;
             
             
-            BookParticle(d, root);
+            BookParticle(bookedParticles, d, root);
         }
     }
     
@@ -290,7 +305,7 @@ void PECGenParticles::analyze(edm::Event const &event, edm::EventSetup const &se
         
         
         // Add the new particle to the storage vector
-        storeParticles.emplace_back(storeParticle);
+        buffer.emplace_back(storeParticle);
     }
     
     
@@ -304,7 +319,7 @@ void PECGenParticles::analyze(edm::Event const &event, edm::EventSetup const &se
     
     
     // Use the map to set up indices of mothers. Note that particles in vectors bookedParticles and
-    //storeParticles are ordered identically
+    //buffer are ordered identically
     for (unsigned iPart = 0; iPart < bookedParticles.size(); ++iPart)
     {
         auto const &p = bookedParticles.at(iPart);
@@ -320,7 +335,7 @@ void PECGenParticles::analyze(edm::Event const &event, edm::EventSetup const &se
             
             if (res != particleToIndex.end())
             {
-                storeParticles.at(iPart).SetFirstMotherIndex(res->second);
+                buffer.at(iPart).SetFirstMotherIndex(res->second);
                 motherFound = true;
             }
         }
@@ -332,7 +347,7 @@ void PECGenParticles::analyze(edm::Event const &event, edm::EventSetup const &se
             
             if (res != particleToIndex.end())
             {
-                storeParticles.at(iPart).SetLastMotherIndex(res->second);
+                buffer.at(iPart).SetLastMotherIndex(res->second);
                 motherFound = true;
             }
         }
@@ -352,7 +367,7 @@ void PECGenParticles::analyze(edm::Event const &event, edm::EventSetup const &se
                 
                 if (res != particleToIndex.end())
                 {
-                    storeParticles.at(iPart).SetFirstMotherIndex(res->second);
+                    buffer.at(iPart).SetFirstMotherIndex(res->second);
                     break;
                 }
             }
@@ -363,9 +378,9 @@ void PECGenParticles::analyze(edm::Event const &event, edm::EventSetup const &se
     #ifdef DEBUG
     cout << "All particles that will be stored:\n";
     
-    for (unsigned iPart = 0; iPart < storeParticles.size(); ++iPart)
+    for (unsigned iPart = 0; iPart < buffer.size(); ++iPart)
     {
-        auto const &p = storeParticles.at(iPart);
+        auto const &p = buffer.at(iPart);
         
         cout << " #" << iPart << ": PDG ID: " << p.PdgId() << ", mothers: " <<
          p.FirstMotherIndex() << ", " << p.LastMotherIndex() << endl;
@@ -375,13 +390,30 @@ void PECGenParticles::analyze(edm::Event const &event, edm::EventSetup const &se
     #endif
     
     
-    // Everything is done. Save the event in the output tree
-    outTree->Fill();
+    treeFillService->Commit(this, streamID);
+}
+
+
+void PECGenParticles::AllocateSlots(unsigned numSlots)
+{
+    stagedParticles.resize(numSlots);
+}
+
+
+void PECGenParticles::StageEntry(StreamID streamID, unsigned slot)
+{
+    swap(stagedParticles[slot], *streamCache(streamID));
+}
+
+
+void PECGenParticles::MoveToTree(unsigned slot)
+{
+    swap(storeParticles, stagedParticles[slot]);
 }
 
 
-bool PECGenParticles::BookParticle(reco::Candidate const *p,
- reco::Candidate const *mother /*= nullptr*/)
+bool PECGenParticles::BookParticle(vector<ParticleWithMother> &bookedParticles,
+ reco::Candidate const *p, reco::Candidate const *mother /*= nullptr*/)
 {
     // Check if the given particle has already been booked for storing
     auto res = find(bookedParticles.begin(), bookedParticles.end(), p);
@@ -1,8 +1,9 @@
 #pragma once
 
 #include <Analysis/PECTuples/interface/GenParticle.h>
+#include "TreeFillService.h"
 
-#include <FWCore/Framework/interface/EDAnalyzer.h>
+#include <FWCore/Framework/interface/global/EDAnalyzer.h>
 #include <FWCore/Framework/interface/Event.h>
 #include <FWCore/ParameterSet/interface/ParameterSet.h>
 #include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
@@ -11,10 +12,10 @@
 #include <DataFormats/HepMCCandidate/interface/GenParticle.h>
 
 #include <FWCore/ServiceRegistry/interface/Service.h>
-#include <CommonTools/UtilAlgos/interface/TFileService.h>
 
 #include <TTree.h>
 
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -40,7 +41,9 @@
  * The plugin is designed for samples produced with Pythia 6 or 8 (possibly, with an external LHE
  * generator). It might not work properly with other showering and hadronization programs.
  */
-class PECGenParticles: public edm::EDAnalyzer
+class PECGenParticles:
+  public edm::global::EDAnalyzer<edm::StreamCache<std::vector<pec::GenParticle>>>,
+  public TreeFillService::Client
 {
 private:
     /**
@@ -113,11 +116,25 @@ public:
     /// A method to verify plugin's configuration
     static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
     
-    /// Creates the output tree
+    /// Creates the output tree and registers it in TreeFillService
     virtual void beginJob() override;
     
-    /// Reads the event and stores the relevant information in the output tree
-    virtual void analyze(edm::Event const &event, edm::EventSetup const &setup) override;
+    /// Creates a buffer for the given stream
+    virtual std::unique_ptr<std::vector<pec::GenParticle>> beginStream(edm::StreamID) const
+      override;
+    
+    /// Reads the event and stores the relevant information in the buffer of the stream
+    virtual void analyze(edm::StreamID streamID, edm::Event const &event,
+      edm::EventSetup const &setup) const override;
+    
+    /// Allocates buffers for staging slots of TreeFillService
+    virtual void AllocateSlots(unsigned numSlots) override;
+    
+    /// Moves content of the buffer of the given stream into the buffer of the given staging slot
+    virtual void StageEntry(edm::StreamID streamID, unsigned slot) override;
+    
+    /// Moves content of the buffer of the given staging slot into the buffer of the output tree
+    virtual void MoveToTree(unsigned slot) override;
     
 private:
     /**
@@ -126,9 +143,10 @@ private:
      * The particle is added if only is has not been added before, i.e. duplicates are avoided. The
      * return value indicates if the particle has been added (if not, it was a duplicate).
      * Regardless of whether the given particle is new or already present in the collection, its
-     * mother is updated if the second argument is not null.
+     * mother is updated if the third argument is not null.
      */
-    bool BookParticle(reco::Candidate const *p, reco::Candidate const *mother = nullptr);
+    static bool BookParticle(std::vector<ParticleWithMother> &bookedParticles,
+      reco::Candidate const *p, reco::Candidate const *mother = nullptr);
     
 private:
     /// Collection of generator-level particles
@@ -137,22 +155,15 @@ private:
     /// (Absolute) PDG IDs of additional particles to be saved
     std::set<int> desiredExtraPartIds;
     
-    /// An object to handle the output ROOT file
-    edm::Service<TFileService> fileService;
-    
-    /**
-     * \brief Particles that are going to be stored
-     * 
-     * The container is utilised to keep track of paricles that have been accepted to be stored in
-     * the output file and helps to avoid duplicates. Pointers in elements of the container refer to
-     * particles in the collection read via genPartilcesToken. Original mothers of some of the
-     * particles are overridden.
-     */
-    std::vector<ParticleWithMother> bookedParticles;
+    /// Service that fills the output tree
+    edm::Service<TreeFillService> treeFillService;
     
     /// Tree to be written in the output ROOT file
     TTree *outTree;
     
+    /// Generator-level particles of events queued for writing, indexed with staging slot
+    std::vector<std::vector<pec::GenParticle>> stagedParticles;
+    
     /// Trimmed generator-level particles to be stored in the output file
     std::vector<pec::GenParticle> storeParticles;
     
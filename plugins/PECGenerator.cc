@@ -5,6 +5,8 @@
 #include <FWCore/Utilities/interface/Exception.h>
 #include <FWCore/Utilities/interface/InputTag.h>
 
+#include <iostream>
+
 
 using namespace edm;
 using namespace std;
@@ -12,7 +14,8 @@ using namespace std;
 
 PECGenerator::PECGenerator(ParameterSet const &cfg):
     lheWeightIndices(cfg.getParameter<std::vector<int>>("saveAltLHEWeights")),
-    psWeightIndices(cfg.getParameter<std::vector<int>>("saveAltPSWeights"))
+    psWeightIndices(cfg.getParameter<std::vector<int>>("saveAltPSWeights")),
+    numEncodedRatios(0), numClampedRatios(0)
 {
     generatorToken = consumes<GenEventInfoProduct>(cfg.getParameter<InputTag>("generator"));
     
@@ -39,6 +42,39 @@ PECGenerator::PECGenerator(ParameterSet const &cfg):
             excp.raise();
         }
     }
+    
+    
+    std::string const storage(cfg.getParameter<std::string>("weightStorage"));
+    
+    if (storage == "absolute")
+        weightStorage = WeightStorage::Absolute;
+    else if (storage == "ratio")
+        weightStorage = WeightStorage::Ratio;
+    else if (storage == "ratio16")
+        weightStorage = WeightStorage::QuantizedRatio;
+    else
+    {
+        cms::Exception excp("Configuration");
+        excp << "Unknown value \"" << storage << "\" for parameter weightStorage.";
+        excp.raise();
+    }
+    
+    
+    auto const ratioRange = cfg.getParameter<std::vector<double>>("ratioRange");
+    
+    if (ratioRange.size() != 2 or not (ratioRange[1] > ratioRange[0]))
+    {
+        cms::Exception excp("Configuration");
+        excp << "Parameter ratioRange must contain exactly two numbers [min, max] with " <<
+          "min < max, while " << ratioRange.size() << " number(s) given.";
+        
+        if (ratioRange.size() == 2)
+            excp << " The given range is [" << ratioRange[0] << ", " << ratioRange[1] << "].";
+        
+        excp.raise();
+    }
+    
+    weightRatios = pec::WeightRatios(ratioRange[0], ratioRange[1]);
 }
 
 
@@ -55,6 +91,12 @@ void PECGenerator::fillDescriptions(ConfigurationDescriptions &descriptions)
     desc.add<std::vector<int>>("saveAltPSWeights", std::vector<int>())->
       setComment("Intervals of indices of alternative PS weights to be stored. "
         "Parsed using class IndexIntervals.");
+    desc.add<std::string>("weightStorage", "absolute")->
+      setComment("Format to store alternative weights. Allowed values are \"absolute\", "
+        "\"ratio\", and \"ratio16\".");
+    desc.add<std::vector<double>>("ratioRange", {-1., 3.})->
+      setComment("Range of ratios of alternative weights to the nominal one for the 16-bit "
+        "format. Ratios outside of the range are clamped.");
     
     descriptions.add("generator", desc);
 }
@@ -62,17 +104,102 @@ void PECGenerator::fillDescriptions(ConfigurationDescriptions &descriptions)
 
 void PECGenerator::beginJob()
 {
-    outTree = fileService->make<TTree>("Generator", "Global generator-level properties");
+    outTree = treeFillService->BookTree(this, "Generator", "Global generator-level properties");
     
     generatorInfoPointer = &generatorInfo;
-    outTree->Branch("generator", &generatorInfoPointer);
+    outTree->Branch(BranchName("generator").c_str(), &generatorInfoPointer);
+    
+    if (weightStorage != WeightStorage::Absolute)
+    {
+        flatLheWeightRatios.reset(new FlatBranches<Float_t>(outTree,
+          BranchName("numAltLheWeights")));
+        flatPsWeightRatios.reset(new FlatBranches<Float_t>(outTree,
+          BranchName("numAltPsWeights")));
+        
+        if (weightStorage == WeightStorage::Ratio)
+        {
+            auto const identity = [](Float_t const &r){return r;};
+            flatLheWeightRatios->AddColumn<Float_t>(BranchName("altLheWeightRatios"), identity);
+            flatPsWeightRatios->AddColumn<Float_t>(BranchName("altPsWeightRatios"), identity);
+        }
+        else
+        {
+            // The encoding is done in MoveToTree, which is serialized, so the counters do not
+            //need to be protected
+            auto const encode = [this](Float_t const &r)
+            {
+                ++numEncodedRatios;
+                
+                if (not (r >= weightRatios.MinRatio() and r <= weightRatios.MaxRatio()))
+                    ++numClampedRatios;
+                
+                return weightRatios.Encode(r);
+            };
+            
+            flatLheWeightRatios->AddColumn<UShort_t>(BranchName("altLheWeightRatios"), encode);
+            flatPsWeightRatios->AddColumn<UShort_t>(BranchName("altPsWeightRatios"), encode);
+        }
+    }
+}
+
+
+void PECGenerator::endJob()
+{
+    if (weightStorage == WeightStorage::QuantizedRatio)
+        cout << "PECGenerator: " << numClampedRatios << " out of " << numEncodedRatios <<
+          " ratios of alternative weights fell outside of the range [" <<
+          weightRatios.MinRatio() << ", " << weightRatios.MaxRatio() << "] and were clamped." <<
+          endl;
+    
+    if (lheWeightIndices.Empty() and psWeightIndices.Empty())
+        return;
+    
+    TTree *tree = fileService->make<TTree>("WeightSchema",
+      "Indices and IDs of stored alternative weights");
+    
+    UInt_t bfRun;
+    std::vector<Int_t> bfLheIndices, bfPsIndices;
+    std::vector<std::string> bfLheIds;
+    Bool_t bfRatios = (weightStorage != WeightStorage::Absolute);
+    Bool_t bfQuantized = (weightStorage == WeightStorage::QuantizedRatio);
+    Float_t bfMinRatio = weightRatios.MinRatio(), bfMaxRatio = weightRatios.MaxRatio();
+    
+    tree->Branch("run", &bfRun);
+    tree->Branch("lheIndices", &bfLheIndices);
+    tree->Branch("lheIds", &bfLheIds);
+    tree->Branch("psIndices", &bfPsIndices);
+    tree->Branch("ratios", &bfRatios);
+    tree->Branch("quantized", &bfQuantized);
+    tree->Branch("minRatio", &bfMinRatio);
+    tree->Branch("maxRatio", &bfMaxRatio);
+    
+    for (auto const &entry: schemas)
+    {
+        bfRun = entry.first;
+        bfLheIndices = entry.second.lheIndices;
+        bfLheIds = entry.second.lheIds;
+        bfPsIndices = entry.second.psIndices;
+        tree->Fill();
+    }
+}
+
+
+unique_ptr<PECGeneratorBuffers> PECGenerator::beginStream(StreamID) const
+{
+    return make_unique<PECGeneratorBuffers>();
 }
 
 
-void PECGenerator::analyze(Event const &event, EventSetup const &)
+void PECGenerator::analyze(StreamID streamID, Event const &event, EventSetup const &) const
 {
-    // Reset the buffer from the previous event
-    generatorInfo.Reset();
+    PECGeneratorBuffers &buffers = *streamCache(streamID);
+    pec::GeneratorInfo &buffer = buffers.generatorInfo;
+    
+    
+    // Reset the buffers from the previous event
+    buffer.Reset();
+    buffers.altLheWeightRatios.clear();
+    buffers.altPsWeightRatios.clear();
     
     
     // Read generator information for the current event and set process ID
@@ -84,19 +211,21 @@ void PECGenerator::analyze(Event const &event, EventSetup const &)
     if (readLHEEventRecord)
     {
         event.getByToken(lheEventInfoToken, lheEventInfo);
-        generatorInfo.SetProcessId(lheEventInfo->hepeup().IDPRUP);
+        buffer.SetProcessId(lheEventInfo->hepeup().IDPRUP);
     }
     else
     {
         // Cannot read process ID as given in the LHE event record. Instead of a default, read one
         //from GenEventInfoProduct
-        generatorInfo.SetProcessId(generator->signalProcessID());
+        buffer.SetProcessId(generator->signalProcessID());
     }
 
     
     
-    // Event weights
-    generatorInfo.SetNominalWeight(generator->weight());
+    // Event weights. When they are stored as ratios, the alternative weights are computed in
+    //exactly the same way, and then divided by the nominal weight
+    buffer.SetNominalWeight(generator->weight());
+    bool const storeRatios = (weightStorage != WeightStorage::Absolute);
     
     if (readLHEEventRecord and not lheWeightIndices.Empty())
     {
@@ -106,35 +235,118 @@ void PECGenerator::analyze(Event const &event, EventSetup const &)
         double const factor = generator->weight() / lheEventInfo->originalXWGTUP();
         
         
-        // Save selected alternative weights
+        // Save selected alternative weights. They are copied interval by interval
         vector<gen::WeightsInfo> const &altWeights = lheEventInfo->weights();
-
-        for (int i: lheWeightIndices.GetIndices(0, altWeights.size() - 1))
-            generatorInfo.AddAltLheWeight(altWeights[i].wgt * factor);
+        double const nominalWeight = generator->weight();
+        
+        if (storeRatios)
+            lheWeightIndices.Gather(altWeights, buffers.altLheWeightRatios,
+              [factor, nominalWeight](gen::WeightsInfo const &w)
+              {return pec::WeightRatios::ComputeRatio(w.wgt * factor, nominalWeight);});
+        else
+            lheWeightIndices.Gather(altWeights, buffer.MutableAltLheWeights(),
+              [factor](gen::WeightsInfo const &w){return w.wgt * factor;});
     }
 
     vector<double> const &genWeights = generator->weights();
 
     if (not psWeightIndices.Empty() and genWeights.size() > 1)
     {
-        for (int i: psWeightIndices.GetIndices(0, genWeights.size() - 1))
-            generatorInfo.AddAltPsWeight(genWeights[i]);
-    }
+        double const nominalWeight = generator->weight();
         
+        if (storeRatios)
+            psWeightIndices.Gather(genWeights, buffers.altPsWeightRatios,
+              [nominalWeight](double w){return pec::WeightRatios::ComputeRatio(w, nominalWeight);});
+        else
+            psWeightIndices.Gather(genWeights, buffer.MutableAltPsWeights());
+    }
+    
+    
+    // Indices and IDs of stored weights only need to be recorded once per run. Checking the run in
+    //the stream buffer first avoids locking the mutex in every event
+    if (buffers.schemaRun != event.id().run())
+    {
+        RecordSchema(event, (readLHEEventRecord) ? lheEventInfo.product() : nullptr, *generator);
+        buffers.schemaRun = event.id().run();
+    }
+    
     
     // PDF information
     GenEventInfoProduct::PDF const *pdf = generator->pdf();
     
     if (pdf)
     {
-        generatorInfo.SetPdfXs(pdf->x.first, pdf->x.second);
-        generatorInfo.SetPdfIds(pdf->id.first, pdf->id.second);
-        generatorInfo.SetPdfQScale(pdf->scalePDF);
+        buffer.SetPdfXs(pdf->x.first, pdf->x.second);
+        buffer.SetPdfIds(pdf->id.first, pdf->id.second);
+        buffer.SetPdfQScale(pdf->scalePDF);
     }
     
+    treeFillService->Commit(this, streamID);
+}
+
+
+void PECGenerator::AllocateSlots(unsigned numSlots)
+{
+    stagedBuffers.resize(numSlots);
+}
+
+
+void PECGenerator::StageEntry(StreamID streamID, unsigned slot)
+{
+    PECGeneratorBuffers &buffers = *streamCache(streamID);
+    PECGeneratorBuffers &staged = stagedBuffers[slot];
+    
+    // The run of the recorded schema stays with the stream
+    swap(staged.generatorInfo, buffers.generatorInfo);
+    swap(staged.altLheWeightRatios, buffers.altLheWeightRatios);
+    swap(staged.altPsWeightRatios, buffers.altPsWeightRatios);
+}
+
+
+void PECGenerator::MoveToTree(unsigned slot)
+{
+    PECGeneratorBuffers &buffers = stagedBuffers[slot];
+    swap(generatorInfo, buffers.generatorInfo);
     
-    // Fill the output tree
-    outTree->Fill();
+    if (weightStorage != WeightStorage::Absolute)
+    {
+        flatLheWeightRatios->Fill(buffers.altLheWeightRatios);
+        flatPsWeightRatios->Fill(buffers.altPsWeightRatios);
+    }
+}
+
+
+void PECGenerator::RecordSchema(Event const &event, LHEEventProduct const *lheEventInfo,
+  GenEventInfoProduct const &generator) const
+{
+    if (lheWeightIndices.Empty() and psWeightIndices.Empty())
+        return;
+    
+    lock_guard<mutex> lock(schemaMutex);
+    
+    if (schemas.count(event.id().run()) > 0)
+        return;
+    
+    WeightSchema &schema = schemas[event.id().run()];
+    
+    if (lheEventInfo and not lheWeightIndices.Empty())
+    {
+        vector<gen::WeightsInfo> const &altWeights = lheEventInfo->weights();
+        
+        for (int i: lheWeightIndices.GetIndices(0, altWeights.size() - 1))
+        {
+            schema.lheIndices.emplace_back(i);
+            schema.lheIds.emplace_back(altWeights[i].id);
+        }
+    }
+    
+    vector<double> const &genWeights = generator.weights();
+    
+    if (not psWeightIndices.Empty() and genWeights.size() > 1)
+    {
+        for (int i: psWeightIndices.GetIndices(0, genWeights.size() - 1))
+            schema.psIndices.emplace_back(i);
+    }
 }
 
 
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <Analysis/PECTuples/interface/GeneratorInfo.h>
+#include <Analysis/PECTuples/interface/WeightRatios.h>
+#include "FlatBranches.h"
 #include "IndexIntervals.h"
+#include "TreeFillService.h"
 
-#include <FWCore/Framework/interface/EDAnalyzer.h>
+#include <FWCore/Framework/interface/global/EDAnalyzer.h>
 #include <FWCore/Framework/interface/Event.h>
 #include <FWCore/ParameterSet/interface/ParameterSet.h>
 #include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
@@ -12,15 +15,40 @@
 #include <SimDataFormats/GeneratorProducts/interface/GenEventInfoProduct.h>
 #include <SimDataFormats/GeneratorProducts/interface/LHEEventProduct.h>
 
-#include <FWCore/ServiceRegistry/interface/Service.h>
 #include <CommonTools/UtilAlgos/interface/TFileService.h>
+#include <DataFormats/Provenance/interface/RunID.h>
+#include <FWCore/ServiceRegistry/interface/Service.h>
 
 #include <TTree.h>
 
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 
+/**
+ * \struct PECGeneratorBuffers
+ * \brief Per-stream buffers of plugin PECGenerator
+ */
+struct PECGeneratorBuffers
+{
+    /// Generator information for the current event
+    pec::GeneratorInfo generatorInfo;
+    
+    /**
+     * \brief Ratios of alternative weights to the nominal one
+     * 
+     * Only filled if alternative weights are stored as ratios.
+     */
+    std::vector<Float_t> altLheWeightRatios, altPsWeightRatios;
+    
+    /// Run for which the weight schema has been recorded by this stream
+    edm::RunNumber_t schemaRun = 0;
+};
+
+
 /**
  * \class PECGenerator
  * \brief Stores global generator-level information
@@ -31,10 +59,44 @@
  * unity. The process ID is read from the LHE record if it is available. If an empty tag is given
  * as lheEventProduct, the process ID is read from GenEventInfoProduct instead.
  * 
+ * Alternative weights are stored according to parameter "weightStorage". With "absolute" they are
+ * included in pec::GeneratorInfo. With "ratio" and "ratio16" the vectors in pec::GeneratorInfo are
+ * left empty, and ratios of alternative weights to the nominal one are written instead in
+ * counter-plus-array leaf branches numAltLheWeights, altLheWeightRatios[numAltLheWeights],
+ * numAltPsWeights, and altPsWeightRatios[numAltPsWeights]. With "ratio16" the ratios are quantized
+ * into 16 bits with class pec::WeightRatios, using the range given by parameter "ratioRange". The
+ * same class reconstructs absolute weights when the tuples are read. The number of ratios that
+ * have been clamped to the range is printed at the end of the job.
+ * 
+ * Indices of stored weights, together with IDs of LHE weights, are recorded for each run from the
+ * first event of the run processed by the job. They are written at the end of the job in the tree
+ * "WeightSchema" in the directory of the plugin, which also describes the storage format.
+ * 
  * This plugin must be only run on simulation.
  */
-class PECGenerator: public edm::EDAnalyzer
+class PECGenerator: public edm::global::EDAnalyzer<edm::StreamCache<PECGeneratorBuffers>>,
+  public TreeFillService::Client
 {
+private:
+    /// Supported formats to store alternative weights
+    enum class WeightStorage
+    {
+        Absolute,
+        Ratio,
+        QuantizedRatio
+    };
+    
+    /**
+     * \struct WeightSchema
+     * \brief Indices and IDs of stored alternative weights in a single run
+     */
+    struct WeightSchema
+    {
+        std::vector<Int_t> lheIndices;
+        std::vector<std::string> lheIds;
+        std::vector<Int_t> psIndices;
+    };
+    
 public:
     /// Constructor
     PECGenerator(edm::ParameterSet const &cfg);
@@ -43,11 +105,36 @@ public:
     /// Verifies configuration of the plugin
     static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
     
-    /// Creates output tree
+    /// Creates output tree and registers it in TreeFillService
     virtual void beginJob() override;
     
-    /// Writes global generator information into the buffer and fills the output tree
-    virtual void analyze(edm::Event const &event, edm::EventSetup const &) override;
+    /// Writes the weight schema
+    virtual void endJob() override;
+    
+    /// Creates a buffer for the given stream
+    virtual std::unique_ptr<PECGeneratorBuffers> beginStream(edm::StreamID) const override;
+    
+    /// Writes global generator information into the buffer of the stream
+    virtual void analyze(edm::StreamID streamID, edm::Event const &event, edm::EventSetup const &)
+      const override;
+    
+    /// Allocates buffers for staging slots of TreeFillService
+    virtual void AllocateSlots(unsigned numSlots) override;
+    
+    /// Moves per-event content of the buffer of the given stream into the given staging slot
+    virtual void StageEntry(edm::StreamID streamID, unsigned slot) override;
+    
+    /// Moves content of the buffer of the given staging slot into the buffer of the output tree
+    virtual void MoveToTree(unsigned slot) override;
+    
+private:
+    /**
+     * \brief Records indices and IDs of alternative weights for the run of the given event
+     * 
+     * Does nothing if the schema for this run has already been recorded.
+     */
+    void RecordSchema(edm::Event const &event, LHEEventProduct const *lheEventInfo,
+      GenEventInfoProduct const &generator) const;
     
 private:
     /// Token to access global generator information
@@ -70,6 +157,29 @@ private:
     /// Indices of PS event weights to be stored
     IndexIntervals psWeightIndices;
     
+    /// Format to store alternative weights
+    WeightStorage weightStorage;
+    
+    /// Object to quantize ratios of weights
+    pec::WeightRatios weightRatios;
+    
+    /**
+     * \brief Numbers of quantized ratios and of ratios clamped to the range
+     * 
+     * Only updated in MoveToTree. Reported at the end of the job.
+     */
+    unsigned long long numEncodedRatios, numClampedRatios;
+    
+    
+    /// Mutex to protect the collection of weight schemas
+    mutable std::mutex schemaMutex;
+    
+    /// Weight schemas for all processed runs
+    mutable std::map<edm::RunNumber_t, WeightSchema> schemas;
+    
+    
+    /// Service that fills the output tree
+    edm::Service<TreeFillService> treeFillService;
     
     /// An object to handle the output ROOT file
     edm::Service<TFileService> fileService;
@@ -88,4 +198,18 @@ private:
      * ROOT needs a variable with a pointer to an object to store the object in a tree.
      */
     pec::GeneratorInfo *generatorInfoPointer;
+    
+    /**
+     * \brief Flat branches for ratios of alternative weights
+     * 
+     * Only created if alternative weights are stored as ratios.
+     */
+    std::unique_ptr<FlatBranches<Float_t>> flatLheWeightRatios, flatPsWeightRatios;
+    
+    /**
+     * \brief Generator information of events queued for writing, indexed with staging slot
+     * 
+     * Member schemaRun is not used.
+     */
+    std::vector<PECGeneratorBuffers> stagedBuffers;
 };
@@ -12,6 +12,7 @@
 #include <array>
 #include <cmath>
 #include <cstdlib>
+#include <utility>
 
 
 using namespace edm;
@@ -20,7 +21,8 @@ using namespace std;
 
 PECJetMET::PECJetMET(edm::ParameterSet const &cfg):
     runOnData(cfg.getParameter<bool>("runOnData")),
-    rawJetMomentaOnly(cfg.getParameter<bool>("rawJetMomentaOnly"))
+    rawJetMomentaOnly(cfg.getParameter<bool>("rawJetMomentaOnly")),
+    flatBranches(cfg.getParameter<bool>("flatBranches"))
 {
     // Register required input data
     jetToken = consumes<edm::View<pat::Jet>>(cfg.getParameter<InputTag>("jets"));
@@ -81,6 +83,8 @@ void PECJetMET::fillDescriptions(edm::ConfigurationDescriptions &descriptions)
     desc.add<InputTag>("met")->setComment("MET.");
     desc.add<vector<InputTag>>("metCorrToUndo", vector<InputTag>())->
       setComment("MET corrections to undo for (partly) uncorreted METs.");
+    desc.add<bool>("flatBranches", false)->
+      setComment("Requests storing jets and MET in counter-plus-array leaf branches.");
     
     descriptions.add("jetMET", desc);
 }
@@ -88,24 +92,129 @@ void PECJetMET::fillDescriptions(edm::ConfigurationDescriptions &descriptions)
 
 void PECJetMET::beginJob()
 {
-    outTree = fileService->make<TTree>("JetMET", "Properties of reconstructed jets and MET");
+    outTree = treeFillService->BookTree(this, "JetMET", "Properties of reconstructed jets and MET");
     
     
-    storeJetsPointer = &storeJets;
-    outTree->Branch("jets", &storeJetsPointer);
-    
-    storeMETsPointer = &storeMETs;
-    outTree->Branch("METs", &storeMETsPointer);
-    
-    storeUncorrMETsPointer = &storeUncorrMETs;
-    outTree->Branch("uncorrMETs", &storeUncorrMETsPointer);
+    if (not flatBranches)
+    {
+        storeJetsPointer = &storeJets;
+        outTree->Branch(BranchName("jets").c_str(), &storeJetsPointer);
+        
+        storeMETsPointer = &storeMETs;
+        outTree->Branch(BranchName("METs").c_str(), &storeMETsPointer);
+        
+        storeUncorrMETsPointer = &storeUncorrMETs;
+        outTree->Branch(BranchName("uncorrMETs").c_str(), &storeUncorrMETsPointer);
+    }
+    else
+    {
+        using Jet = pec::Jet;
+        flatJets.reset(new FlatBranches<Jet>(outTree, "nJet"));
+        
+        flatJets->AddMemberColumn("Jet_pt", "pt", [](Jet const &j){return j.Pt();});
+        flatJets->AddMemberColumn("Jet_eta", "eta", [](Jet const &j){return j.Eta();});
+        flatJets->AddMemberColumn("Jet_phi", "phi", [](Jet const &j){return j.Phi();});
+        flatJets->AddMemberColumn("Jet_mass", "mass", [](Jet const &j){return j.M();});
+        flatJets->AddMemberColumn<UChar_t>("Jet_bits", "id", [](Jet const &j)
+        {
+            UChar_t bits = 0;
+            
+            for (unsigned i = 0; i < 8; ++i)
+                bits |= (j.TestBit(i) << i);
+            
+            return bits;
+        });
+        
+        if (not rawJetMomentaOnly)
+        {
+            flatJets->AddMemberColumn("Jet_corrFactor", "corrFactor",
+              [](Jet const &j){return j.CorrFactor();});
+            flatJets->AddMemberColumn("Jet_jecUncertainty", "jecUncertainty",
+              [](Jet const &j){return j.JECUncertainty();});
+            flatJets->AddMemberColumn("Jet_jerUncertainty", "jerUncertainty",
+              [](Jet const &j){return j.JERUncertainty();});
+        }
+        
+        flatJets->AddMemberColumn("Jet_bTagCMVA", "bTags",
+          [](Jet const &j){return j.BTag(Jet::BTagAlgo::CMVA);});
+        
+        for (auto const &dnnType: {make_pair(Jet::BTagDNNType::BB, "bb"),
+          make_pair(Jet::BTagDNNType::B, "b"), make_pair(Jet::BTagDNNType::CC, "cc"),
+          make_pair(Jet::BTagDNNType::C, "c"), make_pair(Jet::BTagDNNType::UDSG, "udsg")})
+        {
+            // The UDSG discriminator is not stored in the class but computed from the others. It
+            //is given the same precision
+            Jet::BTagDNNType const type = dnnType.first;
+            flatJets->AddMemberColumn(string("Jet_bTagDNN_") + dnnType.second,
+              "bTagsDNN", [type](Jet const &j){return j.BTagDNN(type);});
+        }
+        
+        flatJets->AddMemberColumn("Jet_pileUpID", "pileUpMVA",
+          [](Jet const &j){return j.PileUpID();});
+        flatJets->AddMemberColumn("Jet_area", "area",
+          [](Jet const &j){return j.Area();});
+        flatJets->AddMemberColumn("Jet_charge", "charge",
+          [](Jet const &j){return j.Charge();});
+        flatJets->AddMemberColumn("Jet_pullAngle", "pullAngle",
+          [](Jet const &j){return j.PullAngle();});
+        
+        if (not runOnData)
+        {
+            flatJets->AddMemberColumn<Int_t>("Jet_hadronFlavour", "flavours",
+              [](Jet const &j){return j.Flavour(Jet::FlavourType::Hadron);});
+            flatJets->AddMemberColumn<Int_t>("Jet_partonFlavour", "flavours",
+              [](Jet const &j){return j.Flavour(Jet::FlavourType::Parton);});
+            flatJets->AddMemberColumn<Int_t>("Jet_meFlavour", "flavours",
+              [](Jet const &j){return j.Flavour(Jet::FlavourType::ME);});
+        }
+        
+        
+        // Discriminators that this plugin never sets (c-tagging, quark-gluon) are not stored. The
+        //CSV discriminator is never set either, but it shares array bTags with CMVA
+        vector<string> skippedJetMembers{"cTags", "qgTag"};
+        
+        if (rawJetMomentaOnly)
+            skippedJetMembers.insert(skippedJetMembers.end(),
+              {"corrFactor", "jecUncertainty", "jerUncertainty"});
+        
+        if (runOnData)
+            skippedJetMembers.emplace_back("flavours");
+        
+        flatJets->CheckMembers(skippedJetMembers);
+        
+        
+        // MET is stored with its transverse components only
+        using Candidate = pec::Candidate;
+        flatMETs.reset(new FlatBranches<Candidate>(outTree, "nMET"));
+        flatMETs->AddMemberColumn("MET_pt", "pt",
+          [](Candidate const &m){return m.Pt();});
+        flatMETs->AddMemberColumn("MET_phi", "phi",
+          [](Candidate const &m){return m.Phi();});
+        flatMETs->CheckMembers({"eta", "mass"});
+        
+        flatUncorrMETs.reset(new FlatBranches<Candidate>(outTree, "nUncorrMET"));
+        flatUncorrMETs->AddMemberColumn("UncorrMET_pt", "pt",
+          [](Candidate const &m){return m.Pt();});
+        flatUncorrMETs->AddMemberColumn("UncorrMET_phi", "phi",
+          [](Candidate const &m){return m.Phi();});
+        flatUncorrMETs->CheckMembers({"eta", "mass"});
+    }
     
-    outTree->Branch("METSignificance", &storeMETSignificance);
+    outTree->Branch(BranchName("METSignificance").c_str(), &storeMETSignificance);
 }
 
 
-void PECJetMET::analyze(Event const &event, EventSetup const &)
+unique_ptr<PECJetMETBuffers> PECJetMET::beginStream(StreamID) const
 {
+    return make_unique<PECJetMETBuffers>();
+}
+
+
+void PECJetMET::analyze(StreamID streamID, Event const &event, EventSetup const &) const
+{
+    PECJetMETBuffers &buffers = *streamCache(streamID);
+    
+    
     // Read the jet collection
     Handle<View<pat::Jet>> srcJets;
     event.getByToken(jetToken, srcJets);
@@ -124,7 +233,7 @@ void PECJetMET::analyze(Event const &event, EventSetup const &)
     
     
     // Loop through the collection and store relevant properties of jets
-    storeJets.clear();
+    buffers.jets.clear();
     pec::Jet storeJet;  // will reuse this object to fill the vector
     
     for (unsigned int i = 0; i < srcJets->size(); ++i)
@@ -297,7 +406,7 @@ void PECJetMET::analyze(Event const &event, EventSetup const &)
         
         
         // The jet is set up. Add it to the vector
-        storeJets.emplace_back(storeJet);
+        buffers.jets.emplace_back(storeJet);
         
         
         // Update the partial T1 MET correction
@@ -319,9 +428,9 @@ void PECJetMET::analyze(Event const &event, EventSetup const &)
         event.getByToken(metCorrectorTokens.at(i), metCorrectors.at(i));
     
     
-    storeMETSignificance = met.metSignificance();
+    buffers.METSignificance = met.metSignificance();
     
-    storeMETs.clear();
+    buffers.METs.clear();
     pec::Candidate storeMET;
     //^ Will reuse this object to fill the vector of METs
     
@@ -329,7 +438,7 @@ void PECJetMET::analyze(Event const &event, EventSetup const &)
     storeMET.Reset();
     storeMET.SetPt(met.shiftedPt(pat::MET::NoShift, pat::MET::Type1));
     storeMET.SetPhi(met.shiftedPhi(pat::MET::NoShift, pat::MET::Type1));
-    storeMETs.emplace_back(storeMET);
+    buffers.METs.emplace_back(storeMET);
     
     
     // Save MET with systematical variations
@@ -343,19 +452,19 @@ void PECJetMET::analyze(Event const &event, EventSetup const &)
             storeMET.Reset();
             storeMET.SetPt(met.shiftedPt(var, pat::MET::Type1));
             storeMET.SetPhi(met.shiftedPhi(var, pat::MET::Type1));
-            storeMETs.emplace_back(storeMET);
+            buffers.METs.emplace_back(storeMET);
         }
     }
     
     
     // Save variants of uncorrected MET
-    storeUncorrMETs.clear();
+    buffers.uncorrMETs.clear();
     
     // Raw MET
     storeMET.Reset();
     storeMET.SetPt(met.shiftedPt(pat::MET::NoShift, pat::MET::Raw));
     storeMET.SetPhi(met.shiftedPhi(pat::MET::NoShift, pat::MET::Raw));
-    storeUncorrMETs.emplace_back(storeMET);
+    buffers.uncorrMETs.emplace_back(storeMET);
     
     // MET with partly undone T1 correction
     TVector2 const metUncorrT1(met.shiftedPx(pat::MET::NoShift, pat::MET::Type1) - metT1Corr.Px(),
@@ -363,7 +472,7 @@ void PECJetMET::analyze(Event const &event, EventSetup const &)
     storeMET.Reset();
     storeMET.SetPt(metUncorrT1.Mod());
     storeMET.SetPhi(metUncorrT1.Phi());
-    storeUncorrMETs.emplace_back(storeMET);
+    buffers.uncorrMETs.emplace_back(storeMET);
     
     // (Partly) uncorrected MET for each given corrector
     for (auto const &metCorrector: metCorrectors)
@@ -374,12 +483,43 @@ void PECJetMET::analyze(Event const &event, EventSetup const &)
         storeMET.Reset();
         storeMET.SetPt(uncorrMET.Mod());
         storeMET.SetPhi(uncorrMET.Phi());
-        storeUncorrMETs.emplace_back(storeMET);
+        buffers.uncorrMETs.emplace_back(storeMET);
     }
     
+    treeFillService->Commit(this, streamID);
+}
+
+
+void PECJetMET::AllocateSlots(unsigned numSlots)
+{
+    stagedBuffers.resize(numSlots);
+}
+
+
+void PECJetMET::StageEntry(StreamID streamID, unsigned slot)
+{
+    swap(stagedBuffers[slot], *streamCache(streamID));
+}
+
+
+void PECJetMET::MoveToTree(unsigned slot)
+{
+    PECJetMETBuffers &buffers = stagedBuffers[slot];
+    
+    if (not flatBranches)
+    {
+        swap(storeJets, buffers.jets);
+        swap(storeMETs, buffers.METs);
+        swap(storeUncorrMETs, buffers.uncorrMETs);
+    }
+    else
+    {
+        flatJets->Fill(buffers.jets);
+        flatMETs->Fill(buffers.METs);
+        flatUncorrMETs->Fill(buffers.uncorrMETs);
+    }
     
-    // Fill the output tree
-    outTree->Fill();
+    storeMETSignificance = buffers.METSignificance;
 }
 
 
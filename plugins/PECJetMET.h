@@ -1,8 +1,11 @@
 #pragma once
 
 #include <Analysis/PECTuples/interface/Jet.h>
+#include "CompiledSelector.h"
+#include "FlatBranches.h"
+#include "TreeFillService.h"
 
-#include <FWCore/Framework/interface/EDAnalyzer.h>
+#include <FWCore/Framework/interface/global/EDAnalyzer.h>
 #include <FWCore/Framework/interface/Event.h>
 #include <FWCore/ParameterSet/interface/ParameterSet.h>
 #include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
@@ -11,10 +14,8 @@
 #include <DataFormats/METReco/interface/CorrMETData.h>
 #include <DataFormats/PatCandidates/interface/Jet.h>
 #include <DataFormats/PatCandidates/interface/MET.h>
-#include <CommonTools/Utils/interface/StringCutObjectSelector.h>
 
 #include <FWCore/ServiceRegistry/interface/Service.h>
-#include <CommonTools/UtilAlgos/interface/TFileService.h>
 
 #include <TTree.h>
 
@@ -23,6 +24,21 @@
 #include <memory>
 
 
+/**
+ * \struct PECJetMETBuffers
+ * \brief Buffers with jets and MET filled in a single stream
+ * 
+ * See documentation of corresponding members of class PECJetMET.
+ */
+struct PECJetMETBuffers
+{
+    std::vector<pec::Jet> jets;
+    std::vector<pec::Candidate> METs;
+    std::vector<pec::Candidate> uncorrMETs;
+    Float_t METSignificance;
+};
+
+
 /**
  * \class PECJetMET
  * \brief Stores reconstructed jets and MET
@@ -43,8 +59,20 @@
  * corrections induced by stored jets are removed. User can provide a list of MET correction
  * objects (same as used by the standard MET tool); for each of them the plugin stores fully
  * corrected MET from which that correction is undone.
+ * 
+ * If parameter "flatBranches" is set, jets and MET are not written as object branches. Instead,
+ * their properties are stored in counter-plus-array leaf branches (nJet, Jet_pt[nJet], etc.) with
+ * the help of class FlatBranches, which allows to read them without the dictionary for PEC
+ * classes. Floating-point properties are rounded to the same precision as in the object branches.
+ * When the branches are booked, the plugin checks that all data members of pec::Jet, apart from
+ * those it never sets, are stored. The names of these branches already contain their own prefixes
+ * and are not changed when the output tree is shared (see PECOutput).
+ * 
+ * Jets and MET, together with the MET significance, are collected in buffers of the current
+ * stream.
  */
-class PECJetMET: public edm::EDAnalyzer
+class PECJetMET: public edm::global::EDAnalyzer<edm::StreamCache<PECJetMETBuffers>>,
+  public TreeFillService::Client
 {
 private:
     /// Supported versions of jet ID
@@ -66,16 +94,29 @@ public:
     /// Verifies configuration of the plugin
     static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
     
-    /// Creates output tree
+    /// Creates output tree and registers it in TreeFillService
     virtual void beginJob() override;
     
+    /// Creates buffers for the given stream
+    virtual std::unique_ptr<PECJetMETBuffers> beginStream(edm::StreamID) const override;
+    
     /**
      * \brief Analyses current event
      * 
-     * Copies jets and MET into the buffers, evaluates string-based selections for jets, fills the
-     * output tree.
+     * Copies jets and MET into the buffers of the stream and evaluates string-based selections for
+     * jets.
      */
-    virtual void analyze(edm::Event const &event, edm::EventSetup const &) override;
+    virtual void analyze(edm::StreamID streamID, edm::Event const &event, edm::EventSetup const &)
+      const override;
+    
+    /// Allocates buffers for staging slots of TreeFillService
+    virtual void AllocateSlots(unsigned numSlots) override;
+    
+    /// Moves content of buffers of the given stream into buffers of the given staging slot
+    virtual void StageEntry(edm::StreamID streamID, unsigned slot) override;
+    
+    /// Moves content of buffers of the given staging slot into buffers of the output tree
+    virtual void MoveToTree(unsigned slot) override;
     
 private:
     /// Collection of jets
@@ -94,7 +135,7 @@ private:
      * Details on implementation are documented in [1].
      * [1] https://twiki.cern.ch/twiki/bin/view/CMSPublic/SWGuidePhysicsCutParser
      */
-    std::vector<StringCutObjectSelector<pat::Jet>> jetSelectors;
+    std::vector<CompiledSelector<pat::Jet>> jetSelectors;
     
     /// Maps with real-valued IDs
     std::vector<edm::EDGetTokenT<edm::ValueMap<float>>> contIDMapTokens;
@@ -116,17 +157,23 @@ private:
     /// Version of jet ID to be evaluated
     JetID jetIDVersion;
     
+    /// Requests storing jets and MET in flat branches instead of object branches
+    bool const flatBranches;
+    
     // MET corrections to undo when computing uncorrected METs
     std::vector<edm::EDGetTokenT<CorrMETData>> metCorrectorTokens;
     
     
-    /// An object to handle the output ROOT file
-    edm::Service<TFileService> fileService;
+    /// Service that fills the output tree
+    edm::Service<TreeFillService> treeFillService;
     
     
     /// Output tree
     TTree *outTree;
     
+    /// Jets and MET of events queued for writing, indexed with staging slot
+    std::vector<PECJetMETBuffers> stagedBuffers;
+    
     /**
      * \brief Buffer to store jets
      * 
@@ -183,4 +230,13 @@ private:
     
     /// Buffer to store MET significance
     Float_t storeMETSignificance;
+    
+    /**
+     * \brief Flat branches for jets, nominal and uncorrected MET
+     * 
+     * Only created if flat branches are requested. Branches are filled from the buffers of the
+     * stream directly, and the buffers of objects above are not used in this case.
+     */
+    std::unique_ptr<FlatBranches<pec::Jet>> flatJets;
+    std::unique_ptr<FlatBranches<pec::Candidate>> flatMETs, flatUncorrMETs;
 };
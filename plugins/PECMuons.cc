@@ -12,7 +12,8 @@ using namespace edm;
 using namespace std;
 
 
-PECMuons::PECMuons(ParameterSet const &cfg)
+PECMuons::PECMuons(ParameterSet const &cfg):
+    flatBranches(cfg.getParameter<bool>("flatBranches"))
 {
     // Register required input data
     muonToken = consumes<View<pat::Muon>>(cfg.getParameter<InputTag>("src"));
@@ -35,6 +36,8 @@ void PECMuons::fillDescriptions(ConfigurationDescriptions &descriptions)
      "tree.");
     desc.add<InputTag>("primaryVertices")->
      setComment("Collection of reconstructed primary vertices.");
+    desc.add<bool>("flatBranches", false)->
+     setComment("Requests storing muons in counter-plus-array leaf branches.");
     
     descriptions.add("eventContent", desc);
 }
@@ -42,15 +45,54 @@ void PECMuons::fillDescriptions(ConfigurationDescriptions &descriptions)
 
 void PECMuons::beginJob()
 {
-    outTree = fileService->make<TTree>("Muons", "Properties of selected muons");
+    outTree = treeFillService->BookTree(this, "Muons", "Properties of selected muons");
     
-    storeMuonsPointer = &storeMuons;
-    outTree->Branch("muons", &storeMuonsPointer);
+    if (not flatBranches)
+    {
+        storeMuonsPointer = &storeMuons;
+        outTree->Branch(BranchName("muons").c_str(), &storeMuonsPointer);
+    }
+    else
+    {
+        using Muon = pec::Muon;
+        flatMuons.reset(new FlatBranches<Muon>(outTree, "nMuon"));
+        
+        flatMuons->AddMemberColumn("Muon_pt", "pt", [](Muon const &l){return l.Pt();});
+        flatMuons->AddMemberColumn("Muon_eta", "eta",
+          [](Muon const &l){return l.Eta();});
+        flatMuons->AddMemberColumn("Muon_phi", "phi",
+          [](Muon const &l){return l.Phi();});
+        flatMuons->AddMemberColumn<Int_t>("Muon_charge", "charge",
+          [](Muon const &l){return l.Charge();});
+        flatMuons->AddMemberColumn("Muon_relIso", "relIso",
+          [](Muon const &l){return l.RelIso();});
+        flatMuons->AddMemberColumn<UChar_t>("Muon_bits", "id", [](Muon const &l)
+        {
+            UChar_t bits = 0;
+            
+            for (unsigned i = 0; i < 8; ++i)
+                bits |= (l.TestBit(i) << i);
+            
+            return bits;
+        });
+        
+        // The mass of leptons is never set, and it is not stored
+        flatMuons->CheckMembers({"mass"});
+    }
 }
 
 
-void PECMuons::analyze(Event const &event, EventSetup const &)
+unique_ptr<vector<pec::Muon>> PECMuons::beginStream(StreamID) const
 {
+    return make_unique<vector<pec::Muon>>();
+}
+
+
+void PECMuons::analyze(StreamID streamID, Event const &event, EventSetup const &) const
+{
+    vector<pec::Muon> &buffer = *streamCache(streamID);
+    
+    
     // First read primary vertices
     Handle<reco::VertexCollection> vertices;
     event.getByToken(primaryVerticesToken, vertices);
@@ -69,7 +111,7 @@ void PECMuons::analyze(Event const &event, EventSetup const &)
     
     
     // Loop through the collection and store relevant properties of muons
-    storeMuons.clear();
+    buffer.clear();
     pec::Muon storeMuon;  // will reuse this object to fill the vector
     
     for (unsigned i = 0; i < srcMuons->size(); ++i)
@@ -108,12 +150,31 @@ void PECMuons::analyze(Event const &event, EventSetup const &)
         
         
         // The muon is set up. Add it to the vector
-        storeMuons.emplace_back(storeMuon);
+        buffer.emplace_back(storeMuon);
     }
     
-    
-    // Fill the output tree
-    outTree->Fill();
+    treeFillService->Commit(this, streamID);
+}
+
+
+void PECMuons::AllocateSlots(unsigned numSlots)
+{
+    stagedMuons.resize(numSlots);
+}
+
+
+void PECMuons::StageEntry(StreamID streamID, unsigned slot)
+{
+    swap(stagedMuons[slot], *streamCache(streamID));
+}
+
+
+void PECMuons::MoveToTree(unsigned slot)
+{
+    if (not flatBranches)
+        swap(storeMuons, stagedMuons[slot]);
+    else
+        flatMuons->Fill(stagedMuons[slot]);
 }
 
 
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <Analysis/PECTuples/interface/Muon.h>
+#include "CompiledSelector.h"
+#include "FlatBranches.h"
+#include "TreeFillService.h"
 
-#include <FWCore/Framework/interface/EDAnalyzer.h>
+#include <FWCore/Framework/interface/global/EDAnalyzer.h>
 #include <FWCore/Framework/interface/Event.h>
 #include <FWCore/ParameterSet/interface/ParameterSet.h>
 #include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
@@ -10,13 +13,12 @@
 
 #include <DataFormats/PatCandidates/interface/Muon.h>
 #include <DataFormats/VertexReco/interface/VertexFwd.h>
-#include <CommonTools/Utils/interface/StringCutObjectSelector.h>
 
 #include <FWCore/ServiceRegistry/interface/Service.h>
-#include <CommonTools/UtilAlgos/interface/TFileService.h>
 
 #include <TTree.h>
 
+#include <memory>
 #include <vector>
 
 
@@ -28,8 +30,15 @@
  * isolation, quality flags, etc. The mass in the four-momentum is always set to zero
  * to facilitate file compression. Bit flags of stored objects include the flag for tight muon
  * according to the official definition and results of custom selections specifed by the user.
+ * 
+ * If parameter "flatBranches" is set, muons are written in counter-plus-array leaf branches (nMuon,
+ * Muon_pt[nMuon], etc.) instead of an object branch. They can be read without the dictionary for
+ * PEC classes. Floating-point properties keep the reduced precision declared in pec::Muon.
+ * 
+ * Each stream has its own buffer of selected muons.
  */
-class PECMuons: public edm::EDAnalyzer
+class PECMuons: public edm::global::EDAnalyzer<edm::StreamCache<std::vector<pec::Muon>>>,
+  public TreeFillService::Client
 {
 public:
     /**
@@ -43,15 +52,28 @@ public:
     /// Verifies configuration of the plugin
     static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
     
-    /// Creates output tree
+    /// Creates output tree and registers it in TreeFillService
     virtual void beginJob() override;
     
+    /// Creates a buffer for the given stream
+    virtual std::unique_ptr<std::vector<pec::Muon>> beginStream(edm::StreamID) const override;
+    
     /**
      * \brief Analyses current event
      * 
-     * Copies muons into the buffers, evaluates string-based selections, fills the output tree.
+     * Copies muons into the buffer of the stream and evaluates string-based selections.
      */
-    virtual void analyze(edm::Event const &event, edm::EventSetup const &) override;
+    virtual void analyze(edm::StreamID streamID, edm::Event const &event, edm::EventSetup const &)
+      const override;
+    
+    /// Allocates buffers for staging slots of TreeFillService
+    virtual void AllocateSlots(unsigned numSlots) override;
+    
+    /// Moves content of the buffer of the given stream into the buffer of the given staging slot
+    virtual void StageEntry(edm::StreamID streamID, unsigned slot) override;
+    
+    /// Moves content of the buffer of the given staging slot into the buffer of the output tree
+    virtual void MoveToTree(unsigned slot) override;
     
 private:
     /// Source collection of muons
@@ -67,19 +89,25 @@ private:
      * Details on implementation are documented in [1].
      * [1] https://twiki.cern.ch/twiki/bin/view/CMSPublic/SWGuidePhysicsCutParser
      */
-    std::vector<StringCutObjectSelector<pat::Muon>> muSelectors;
+    std::vector<CompiledSelector<pat::Muon>> muSelectors;
+    
+    /// Requests storing muons in flat branches instead of an object branch
+    bool const flatBranches;
     
     /// Collection of reconstructed primary vertices
     edm::EDGetTokenT<reco::VertexCollection> primaryVerticesToken;
     
     
-    /// An object to handle the output ROOT file
-    edm::Service<TFileService> fileService;
+    /// Service that fills the output tree
+    edm::Service<TreeFillService> treeFillService;
     
     
     /// Output tree
     TTree *outTree;
     
+    /// Muons of events queued for writing, indexed with staging slot
+    std::vector<std::vector<pec::Muon>> stagedMuons;
+    
     /// Buffer to store muons
     std::vector<pec::Muon> storeMuons;
     
@@ -89,4 +117,12 @@ private:
      * ROOT needs a variable with a pointer to an object to store the object in a tree.
      */
     std::vector<pec::Muon> *storeMuonsPointer;
+    
+    /**
+     * \brief Flat branches for muons
+     * 
+     * Only created if flat branches are requested. In this case the buffer of objects above is not
+     * used.
+     */
+    std::unique_ptr<FlatBranches<pec::Muon>> flatMuons;
 };
@@ -0,0 +1,48 @@
+#include "PECOutput.h"
+
+#include <FWCore/Framework/interface/MakerMacros.h>
+#include <FWCore/ParameterSet/interface/ParameterSetDescription.h>
+#include <FWCore/ServiceRegistry/interface/ModuleCallingContext.h>
+#include <FWCore/ServiceRegistry/interface/StreamContext.h>
+
+#include <TTree.h>
+
+#include <string>
+
+
+PECOutput::PECOutput(edm::ParameterSet const &cfg):
+    edm::one::OutputModuleBase(cfg),
+    edm::one::OutputModule<>(cfg)
+{
+    // Create the shared tree. This must be done before PEC plugins book their trees in beginJob
+    std::string const treeName(cfg.getParameter<std::string>("treeName"));
+    TTree *tree = fileService->make<TTree>(treeName.c_str(), "Content of PEC tuples");
+    treeFillService->SetSharedTree(tree);
+}
+
+
+void PECOutput::fillDescriptions(edm::ConfigurationDescriptions &descriptions)
+{
+    edm::ParameterSetDescription desc;
+    desc.add<std::string>("treeName", "Events")->setComment("Name of the output tree.");
+    edm::one::OutputModule<>::fillDescription(desc);
+    
+    descriptions.add("pecOutput", desc);
+}
+
+
+void PECOutput::write(edm::EventForOutput const &event)
+{
+    treeFillService->Write(event.moduleCallingContext()->getStreamContext()->streamID());
+}
+
+
+void PECOutput::writeLuminosityBlock(edm::LuminosityBlockForOutput const &)
+{}
+
+
+void PECOutput::writeRun(edm::RunForOutput const &)
+{}
+
+
+DEFINE_FWK_MODULE(PECOutput);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "TreeFillService.h"
+
+#include <FWCore/Framework/interface/one/OutputModule.h>
+#include <FWCore/Framework/interface/EventForOutput.h>
+#include <FWCore/Framework/interface/LuminosityBlockForOutput.h>
+#include <FWCore/Framework/interface/RunForOutput.h>
+#include <FWCore/ParameterSet/interface/ParameterSet.h>
+#include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
+
+#include <FWCore/ServiceRegistry/interface/Service.h>
+#include <CommonTools/UtilAlgos/interface/TFileService.h>
+
+
+/**
+ * \class PECOutput
+ * \brief An output module that writes content of all PEC plugins into a single tree
+ * 
+ * When this module is included in the configuration, the PEC plugins do not create separate trees.
+ * Instead, all of them book their branches in a single tree created by this module. Names of the
+ * branches are prefixed with names of the trees that would be created otherwise, e.g. the jets
+ * written by PECJetMET are stored in branch "JetMET_jets". Flat branches, such as "nJet" and
+ * "Jet_pt", already carry their own prefixes and keep their names. The tree is filled once per
+ * event selected by this module, so all branches share the same cluster boundaries. The filling is
+ * delegated to TreeFillService.
+ * 
+ * The module must be placed in an EndPath. Events to be written are chosen with the standard
+ * parameter SelectEvents. Only paths that include all PEC plugins must be selected.
+ */
+class PECOutput: public edm::one::OutputModule<>
+{
+public:
+    /// Constructor
+    PECOutput(edm::ParameterSet const &cfg);
+    
+public:
+    /// Verifies configuration of the plugin
+    static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
+    
+private:
+    /// Fills the output tree with the current event
+    virtual void write(edm::EventForOutput const &event) override;
+    
+    /// Does nothing
+    virtual void writeLuminosityBlock(edm::LuminosityBlockForOutput const &) override;
+    
+    /// Does nothing
+    virtual void writeRun(edm::RunForOutput const &) override;
+    
+private:
+    /// An object to handle the output ROOT file
+    edm::Service<TFileService> fileService;
+    
+    /// Service that fills the output tree
+    edm::Service<TreeFillService> treeFillService;
+};
@@ -54,17 +54,26 @@ void PECPileUp::fillDescriptions(ConfigurationDescriptions &descriptions)
 
 void PECPileUp::beginJob()
 {
-    outTree = fileService->make<TTree>("PileUp", "Information about pile-up");
+    outTree = treeFillService->BookTree(this, "PileUp", "Information about pile-up");
     
     puInfoPointer = &puInfo;
-    outTree->Branch("puInfo", &puInfoPointer);
+    outTree->Branch(BranchName("puInfo").c_str(), &puInfoPointer);
 }
 
 
-void PECPileUp::analyze(Event const &event, EventSetup const &)
+unique_ptr<pec::PileUpInfo> PECPileUp::beginStream(StreamID) const
 {
+    return make_unique<pec::PileUpInfo>();
+}
+
+
+void PECPileUp::analyze(StreamID streamID, Event const &event, EventSetup const &) const
+{
+    pec::PileUpInfo &buffer = *streamCache(streamID);
+    
+    
     // Reset the buffer from the previous event
-    puInfo.Reset();
+    buffer.Reset();
     
     
     // Save the number of primary vertices
@@ -78,17 +87,17 @@ void PECPileUp::analyze(Event const &event, EventSetup const &)
         excp.raise();
     }
     
-    puInfo.SetNumPV(vertices->size());
+    buffer.SetNumPV(vertices->size());
     
     
     // Save rho
     Handle<double> rho, rhoCentral;
     
     event.getByToken(rhoToken, rho);
-    puInfo.SetRho(*rho);
+    buffer.SetRho(*rho);
     
     event.getByToken(rhoCentralToken, rhoCentral);
-    puInfo.SetRhoCentral(*rhoCentral);
+    buffer.SetRhoCentral(*rhoCentral);
     
     
     // Save pile-up information as simulated
@@ -97,31 +106,47 @@ void PECPileUp::analyze(Event const &event, EventSetup const &)
         Handle<View<PileupSummaryInfo>> puSummary;
         event.getByToken(puSummaryToken, puSummary);
         
-        puInfo.SetTrueNumPU(puSummary->front().getTrueNumInteractions());
+        buffer.SetTrueNumPU(puSummary->front().getTrueNumInteractions());
         //^ The "true" number of interactions is same for all bunch crossings
         
         for (unsigned i = 0; i < puSummary->size(); ++i)
             if (puSummary->at(i).getBunchCrossing() == 0)
             {
-                puInfo.SetInTimePU(puSummary->at(i).getPU_NumInteractions());
+                buffer.SetInTimePU(puSummary->at(i).getPU_NumInteractions());
                 
                 if (saveMaxPtHat)
                 {
                     auto const &ptHats = puSummary->at(i).getPU_pT_hats();
                     
                     if (ptHats.size() > 0)
-                        puInfo.SetMaxPtHat(*max_element(ptHats.begin(), ptHats.end()));
+                        buffer.SetMaxPtHat(*max_element(ptHats.begin(), ptHats.end()));
                     else
-                        puInfo.SetMaxPtHat(0.);
+                        buffer.SetMaxPtHat(0.);
                 }
                 
                 break;
             }
     }
     
-    
-    // Fill the output tree
-    outTree->Fill();
+    treeFillService->Commit(this, streamID);
+}
+
+
+void PECPileUp::AllocateSlots(unsigned numSlots)
+{
+    stagedPUInfos.resize(numSlots);
+}
+
+
+void PECPileUp::StageEntry(StreamID streamID, unsigned slot)
+{
+    stagedPUInfos[slot] = *streamCache(streamID);
+}
+
+
+void PECPileUp::MoveToTree(unsigned slot)
+{
+    puInfo = stagedPUInfos[slot];
 }
 
 
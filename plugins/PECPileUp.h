@@ -1,8 +1,9 @@
 #pragma once
 
 #include <Analysis/PECTuples/interface/PileUpInfo.h>
+#include "TreeFillService.h"
 
-#include <FWCore/Framework/interface/EDAnalyzer.h>
+#include <FWCore/Framework/interface/global/EDAnalyzer.h>
 #include <FWCore/Framework/interface/Event.h>
 #include <FWCore/ParameterSet/interface/ParameterSet.h>
 #include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
@@ -12,10 +13,10 @@
 #include <SimDataFormats/PileupSummaryInfo/interface/PileupSummaryInfo.h>
 
 #include <FWCore/ServiceRegistry/interface/Service.h>
-#include <CommonTools/UtilAlgos/interface/TFileService.h>
 
 #include <TTree.h>
 
+#include <memory>
 #include <vector>
 
 
@@ -26,7 +27,8 @@
  * Main properties are the number of primary vertices and the density rho. In case of simulation,
  * the number of additional pp collisions is also stored.
  */
-class PECPileUp: public edm::EDAnalyzer
+class PECPileUp: public edm::global::EDAnalyzer<edm::StreamCache<pec::PileUpInfo>>,
+  public TreeFillService::Client
 {
 public:
     /// Constructor
@@ -36,11 +38,24 @@ public:
     /// Verifies configuration of the plugin
     static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
     
-    /// Creates output tree
+    /// Creates output tree and registers it in TreeFillService
     virtual void beginJob() override;
     
-    /// Writes information about pile-up into buffers and fills the output tree
-    virtual void analyze(edm::Event const &event, edm::EventSetup const &) override;
+    /// Creates a buffer for the given stream
+    virtual std::unique_ptr<pec::PileUpInfo> beginStream(edm::StreamID) const override;
+    
+    /// Writes information about pile-up into the buffer of the stream
+    virtual void analyze(edm::StreamID streamID, edm::Event const &event, edm::EventSetup const &)
+      const override;
+    
+    /// Allocates buffers for staging slots of TreeFillService
+    virtual void AllocateSlots(unsigned numSlots) override;
+    
+    /// Copies content of the buffer of the given stream into the buffer of the given staging slot
+    virtual void StageEntry(edm::StreamID streamID, unsigned slot) override;
+    
+    /// Copies content of the buffer of the given staging slot into the buffer of the output tree
+    virtual void MoveToTree(unsigned slot) override;
     
 private:
     /// Collection of reconstructed primary vertices
@@ -63,13 +78,16 @@ private:
     bool saveMaxPtHat;
     
     
-    /// An object to handle the output ROOT file
-    edm::Service<TFileService> fileService;
+    /// Service that fills the output tree
+    edm::Service<TreeFillService> treeFillService;
     
     
     /// Output tree
     TTree *outTree;
     
+    /// Pile-up information in events queued for writing, indexed with staging slot
+    std::vector<pec::PileUpInfo> stagedPUInfos;
+    
     /**
      * \brief Buffer to store pile-up information
      * 
@@ -1,15 +1,23 @@
 #include "PECTriggerObjects.h"
 
 #include <FWCore/Framework/interface/MakerMacros.h>
+#include <FWCore/Utilities/interface/EDMException.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 
 
 PECTriggerObjects::FilterBuffer::FilterBuffer(std::string const &name_):
     name(name_),
-    objectsPointer(&objects)
+    objectsPointer(&objects),
+    indicesPointer(&indices)
 {}
 
 
-PECTriggerObjects::PECTriggerObjects(edm::ParameterSet const &cfg)
+PECTriggerObjects::PECTriggerObjects(edm::ParameterSet const &cfg):
+    deduplicate(cfg.getParameter<bool>("deduplicate")),
+    uniqueObjectsPointer(&uniqueObjects)
 {
     triggerObjectsToken = consumes<edm::View<pat::TriggerObjectStandAlone>>(
       cfg.getParameter<edm::InputTag>("triggerObjects"));
@@ -22,14 +30,34 @@ PECTriggerObjects::PECTriggerObjects(edm::ParameterSet const &cfg)
     //^ This is important in order to set up pointers in FilterBuffer properly
     
     for (auto const filterName: filterNames)
+    {
+        if (not filterIndices.emplace(filterName, buffers.size()).second)
+        {
+            edm::Exception excp(edm::errors::Configuration);
+            excp << "Filter \"" << filterName << "\" is given more than once.\n";
+            excp.raise();
+        }
+        
+        if (filterName.find('*') != std::string::npos)
+            wildcardFilterIndices.emplace_back(buffers.size());
+        
         buffers.emplace_back(filterName);
+    }
 }
 
 
-void PECTriggerObjects::analyze(edm::Event const &event, edm::EventSetup const &)
+void PECTriggerObjects::analyze(edm::StreamID streamID, edm::Event const &event,
+  edm::EventSetup const &) const
 {
-    for (auto &buffer: buffers)
-        buffer.objects.clear();
+    auto &streamBuffers = *streamCache(streamID);
+    
+    for (auto &objects: streamBuffers.objectsByFilter)
+        objects.clear();
+    
+    for (auto &indices: streamBuffers.indicesByFilter)
+        indices.clear();
+    
+    streamBuffers.uniqueObjects.clear();
     
     
     edm::Handle<edm::View<pat::TriggerObjectStandAlone>> triggerObjects;
@@ -38,31 +66,154 @@ void PECTriggerObjects::analyze(edm::Event const &event, edm::EventSetup const &
     edm::Handle<edm::TriggerResults> triggerRes;
     event.getByToken(triggerResToken, triggerRes);
     
+    
+    // Each selected filter is represented by a bit in the mask
+    std::vector<std::uint64_t> filterMask((buffers.size() + 63) / 64);
+    
     for (auto const &obj: *triggerObjects)
     {
+        // Find which of selected filters the object has passed, looking up each of its labels once
+        std::fill(filterMask.begin(), filterMask.end(), 0);
+        bool passedAny = false;
+        
+        for (auto const &label: obj.filterLabels())
+        {
+            auto const res = filterIndices.find(label);
+            
+            if (res != filterIndices.end())
+            {
+                filterMask[res->second / 64] |= std::uint64_t(1) << (res->second % 64);
+                passedAny = true;
+            }
+        }
+        
+        // Names with wildcards are not found by the exact lookup above
+        for (unsigned const i: wildcardFilterIndices)
+        {
+            if (obj.hasFilterLabel(buffers[i].name))
+            {
+                filterMask[i / 64] |= std::uint64_t(1) << (i % 64);
+                passedAny = true;
+            }
+        }
+        
+        if (not passedAny)
+            continue;
+        
+        
         pec::Candidate cand;
         cand.SetPt(obj.pt());
         cand.SetEta(obj.eta());
         cand.SetPhi(obj.phi());
         cand.SetM(obj.mass());
         
-        for (auto &buffer: buffers)
+        
+        // Add the object to buffers of all filters it has passed, visiting only the set bits. In
+        //the deduplicated layout the object is stored once, and only its index is added
+        if (deduplicate)
         {
-            if (obj.hasFilterLabel(buffer.name))
-                buffer.objects.emplace_back(cand);
+            if (streamBuffers.uniqueObjects.size() > std::numeric_limits<UShort_t>::max())
+            {
+                edm::Exception excp(edm::errors::LogicError);
+                excp << "Too many trigger objects to index them with UShort_t.\n";
+                excp.raise();
+            }
+            
+            UShort_t const index = streamBuffers.uniqueObjects.size();
+            streamBuffers.uniqueObjects.emplace_back(cand);
+            
+            for (unsigned w = 0; w < filterMask.size(); ++w)
+            {
+                for (std::uint64_t bits = filterMask[w]; bits != 0; bits &= bits - 1)
+                    streamBuffers.indicesByFilter[w * 64 + __builtin_ctzll(bits)].emplace_back(
+                      index);
+            }
+        }
+        else
+        {
+            for (unsigned w = 0; w < filterMask.size(); ++w)
+            {
+                for (std::uint64_t bits = filterMask[w]; bits != 0; bits &= bits - 1)
+                    streamBuffers.objectsByFilter[w * 64 + __builtin_ctzll(bits)].emplace_back(
+                      cand);
+            }
         }
     }
     
-    outTree->Fill();
+    treeFillService->Commit(this, streamID);
 }
 
 
 void PECTriggerObjects::beginJob()
 {
-    outTree = fileService->make<TTree>("TriggerObjects", "Trigger objects by filters");
+    outTree = treeFillService->BookTree(this, "TriggerObjects", "Trigger objects by filters");
     
-    for (auto &buffer: buffers)
-        outTree->Branch(buffer.name.c_str(), &buffer.objectsPointer);
+    if (deduplicate)
+    {
+        outTree->Branch(BranchName("objects").c_str(), &uniqueObjectsPointer);
+        
+        for (auto &buffer: buffers)
+            outTree->Branch(BranchName(buffer.name).c_str(), &buffer.indicesPointer);
+    }
+    else
+    {
+        for (auto &buffer: buffers)
+            outTree->Branch(BranchName(buffer.name).c_str(), &buffer.objectsPointer);
+    }
+}
+
+
+std::unique_ptr<PECTriggerObjectsBuffers> PECTriggerObjects::beginStream(edm::StreamID) const
+{
+    auto streamBuffers = std::make_unique<PECTriggerObjectsBuffers>();
+    
+    if (deduplicate)
+        streamBuffers->indicesByFilter.resize(buffers.size());
+    else
+        streamBuffers->objectsByFilter.resize(buffers.size());
+    
+    return streamBuffers;
+}
+
+
+void PECTriggerObjects::AllocateSlots(unsigned numSlots)
+{
+    stagedBuffers.resize(numSlots);
+    
+    for (auto &staged: stagedBuffers)
+    {
+        if (deduplicate)
+            staged.indicesByFilter.resize(buffers.size());
+        else
+            staged.objectsByFilter.resize(buffers.size());
+    }
+}
+
+
+void PECTriggerObjects::StageEntry(edm::StreamID streamID, unsigned slot)
+{
+    // Buffers of the stream and of the slot have the same structure, so they can be swapped as a
+    //whole
+    std::swap(stagedBuffers[slot], *streamCache(streamID));
+}
+
+
+void PECTriggerObjects::MoveToTree(unsigned slot)
+{
+    auto &staged = stagedBuffers[slot];
+    
+    if (deduplicate)
+    {
+        std::swap(uniqueObjects, staged.uniqueObjects);
+        
+        for (unsigned i = 0; i < buffers.size(); ++i)
+            std::swap(buffers[i].indices, staged.indicesByFilter[i]);
+    }
+    else
+    {
+        for (unsigned i = 0; i < buffers.size(); ++i)
+            std::swap(buffers[i].objects, staged.objectsByFilter[i]);
+    }
 }
 
 
@@ -72,7 +223,10 @@ void PECTriggerObjects::fillDescriptions(edm::ConfigurationDescriptions &descrip
     desc.add<edm::InputTag>("triggerResults", edm::InputTag("TriggerResults"))->
       setComment("Trigger results.");
     desc.add<edm::InputTag>("triggerObjects")->setComment("PAT trigger objects.");
-    desc.add<std::vector<std::string>>("filters")->setComment("Filters to be stored.");
+    desc.add<std::vector<std::string>>("filters")->
+      setComment("Filters to be stored. Names can contain wildcards \"*\".");
+    desc.add<bool>("deduplicate", false)->
+      setComment("Store each trigger object once and indices of objects for each filter.");
     descriptions.add("triggerObjects", desc);
 }
 
@@ -1,23 +1,42 @@
 #pragma once
 
 #include <Analysis/PECTuples/interface/Candidate.h>
+#include "TreeFillService.h"
 
 #include <DataFormats/Common/interface/TriggerResults.h>
 #include <DataFormats/PatCandidates/interface/TriggerObjectStandAlone.h>
 
-#include <FWCore/Framework/interface/EDAnalyzer.h>
+#include <FWCore/Framework/interface/global/EDAnalyzer.h>
 #include <FWCore/Framework/interface/Event.h>
 #include <FWCore/ParameterSet/interface/ParameterSet.h>
 #include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
 #include <FWCore/ParameterSet/interface/ParameterSetDescription.h>
 
 #include <FWCore/ServiceRegistry/interface/Service.h>
-#include <CommonTools/UtilAlgos/interface/TFileService.h>
 
 #include <TTree.h>
 
-#include <vector>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/**
+ * \struct PECTriggerObjectsBuffers
+ * \brief Per-stream buffers of plugin PECTriggerObjects
+ */
+struct PECTriggerObjectsBuffers
+{
+    /// Trigger objects that pass each filter. Used in the default layout
+    std::vector<std::vector<pec::Candidate>> objectsByFilter;
+    
+    /// Trigger objects that pass at least one filter. Used in the deduplicated layout
+    std::vector<pec::Candidate> uniqueObjects;
+    
+    /// Indices of objects in uniqueObjects that pass each filter. Used in the deduplicated layout
+    std::vector<std::vector<UShort_t>> indicesByFilter;
+};
 
 
 /**
@@ -26,8 +45,24 @@
  * 
  * For each selected HLT filter stores a vector of trigger objects that pass it. Tree branches are
  * named after the filters, trigger objects are stored as instances of pec::Candidate.
+ * 
+ * Objects that pass several filters are stored once per filter in this layout. If parameter
+ * "deduplicate" is set, an alternative layout is used instead. Branch "objects" contains each
+ * trigger object that passes at least one of the selected filters exactly once, and the branch for
+ * each filter contains a vector of indices into it (of type UShort_t).
+ * 
+ * Trigger objects are collected in buffers of the current stream, one vector per filter.
+ * 
+ * Names of selected filters are interned once per job: each of them is assigned a bit. In each
+ * event, filter labels of every trigger object are looked up once and converted into a bit mask,
+ * which is then used to assign the object to buffers. Thus the cost grows with the number of
+ * labels of the objects rather than with their product with the number of selected filters.
+ * Names that contain wildcards "*" cannot be matched in this way. For each of them, every object is
+ * checked with pat::TriggerObjectStandAlone::hasFilterLabel, which supports wildcards.
  */
-class PECTriggerObjects: public edm::EDAnalyzer
+class PECTriggerObjects:
+  public edm::global::EDAnalyzer<edm::StreamCache<PECTriggerObjectsBuffers>>,
+  public TreeFillService::Client
 {
 private:
     /// Auxiliary structure to aggregate information about an HLT filter
@@ -48,6 +83,12 @@ private:
          * ROOT needs it to store the vector in a tree.
          */
         std::vector<pec::Candidate> *objectsPointer;
+        
+        /// Indices of corresponding trigger objects in the deduplicated layout
+        std::vector<UShort_t> indices;
+        
+        /// Pointer to the vector of indices
+        std::vector<UShort_t> *indicesPointer;
     };
     
 public:
@@ -55,12 +96,25 @@ public:
     PECTriggerObjects(edm::ParameterSet const &cfg);
     
 public:
-    /// Fills the output tree for each event
-    virtual void analyze(edm::Event const &event, edm::EventSetup const &) override;
+    /// Fills buffers of the stream with trigger objects for each event
+    virtual void analyze(edm::StreamID streamID, edm::Event const &event, edm::EventSetup const &)
+      const override;
     
-    /// Creates the output tree
+    /// Creates the output tree and registers it in TreeFillService
     virtual void beginJob() override;
     
+    /// Creates buffers for the given stream, one for each filter
+    virtual std::unique_ptr<PECTriggerObjectsBuffers> beginStream(edm::StreamID) const override;
+    
+    /// Allocates buffers for staging slots of TreeFillService, one for each filter
+    virtual void AllocateSlots(unsigned numSlots) override;
+    
+    /// Moves content of buffers of the given stream into buffers of the given staging slot
+    virtual void StageEntry(edm::StreamID streamID, unsigned slot) override;
+    
+    /// Moves content of buffers of the given staging slot into buffers of the output tree
+    virtual void MoveToTree(unsigned slot) override;
+    
 public:
     /// A method to verify plugin's configuration
     static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
@@ -75,9 +129,25 @@ private:
     /// Buffers to store trigger objects that pass selected filters
     std::vector<FilterBuffer> buffers;
     
-    /// An object to handle the output ROOT file
-    edm::Service<TFileService> fileService;
+    /// Indices of selected filters in the vector of buffers, keyed by names of the filters
+    std::unordered_map<std::string, unsigned> filterIndices;
+    
+    /// Indices of selected filters whose names contain wildcards
+    std::vector<unsigned> wildcardFilterIndices;
+    
+    /// Specifies whether the deduplicated layout is used
+    bool const deduplicate;
+    
+    /// Buffer with trigger objects in the deduplicated layout and a pointer to it
+    std::vector<pec::Candidate> uniqueObjects;
+    std::vector<pec::Candidate> *uniqueObjectsPointer;
+    
+    /// Service that fills the output tree
+    edm::Service<TreeFillService> treeFillService;
     
     /// Output tree
     TTree *outTree;
+    
+    /// Trigger objects of events queued for writing, indexed with staging slot
+    std::vector<PECTriggerObjectsBuffers> stagedBuffers;
 };
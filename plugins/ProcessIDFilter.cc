@@ -54,7 +54,7 @@ void ProcessIDFilter::fillDescriptions(edm::ConfigurationDescriptions &descripti
 }
 
 
-bool ProcessIDFilter::filter(edm::Event &event, edm::EventSetup const &)
+bool ProcessIDFilter::filter(edm::StreamID, edm::Event &event, edm::EventSetup const &) const
 {
     int processID;
     
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <FWCore/Framework/interface/EDFilter.h>
+#include <FWCore/Framework/interface/global/EDFilter.h>
 #include <FWCore/Framework/interface/Event.h>
 #include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
 #include <FWCore/ParameterSet/interface/ParameterSet.h>
@@ -19,7 +19,7 @@
  * input tag parameters is provided. The other input tag must not be set. Accepted are events whose
  * process IDs are found in the provided list.
  */
-class ProcessIDFilter: public edm::EDFilter
+class ProcessIDFilter: public edm::global::EDFilter<>
 {
 public:
     /// Constructor
@@ -30,7 +30,7 @@ public:
     static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
     
     /// Checks if the event stems from a process with allowed ID
-    virtual bool filter(edm::Event &event, edm::EventSetup const &) override;
+    virtual bool filter(edm::StreamID, edm::Event &event, edm::EventSetup const &) const override;
     
 private:
     /// Token to access global generator information
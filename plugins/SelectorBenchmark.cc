@@ -0,0 +1,199 @@
+#include "SelectorBenchmark.h"
+
+#include <FWCore/Framework/interface/MakerMacros.h>
+#include <FWCore/Utilities/interface/Exception.h>
+#include <FWCore/Utilities/interface/InputTag.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+
+using namespace std;
+
+
+template<typename T>
+SelectorBenchmark::Measurement<T>::Measurement(string const &cut_):
+    cut(cut_),
+    reference(cut_), compiled(cut_),
+    referenceTime(0.), compiledTime(0.),
+    numObjects(0), numMismatches(0)
+{}
+
+
+SelectorBenchmark::SelectorBenchmark(edm::ParameterSet const &cfg):
+    numRepetitions(cfg.getParameter<unsigned>("numRepetitions")),
+    failOnMismatch(cfg.getParameter<bool>("failOnMismatch"))
+{
+    electronToken = consumes<edm::View<pat::Electron>>(
+      cfg.getParameter<edm::InputTag>("electrons"));
+    muonToken = consumes<edm::View<pat::Muon>>(cfg.getParameter<edm::InputTag>("muons"));
+    jetToken = consumes<edm::View<pat::Jet>>(cfg.getParameter<edm::InputTag>("jets"));
+    vertexToken = consumes<edm::View<reco::Vertex>>(cfg.getParameter<edm::InputTag>("vertices"));
+    
+    Book(electronMeasurements, cfg.getParameter<vector<string>>("electronCuts"));
+    Book(muonMeasurements, cfg.getParameter<vector<string>>("muonCuts"));
+    Book(jetMeasurements, cfg.getParameter<vector<string>>("jetCuts"));
+    Book(vertexMeasurements, cfg.getParameter<vector<string>>("vertexCuts"));
+}
+
+
+void SelectorBenchmark::analyze(edm::Event const &event, edm::EventSetup const &)
+{
+    edm::Handle<edm::View<pat::Electron>> electrons;
+    event.getByToken(electronToken, electrons);
+    Run(electronMeasurements, *electrons);
+    
+    edm::Handle<edm::View<pat::Muon>> muons;
+    event.getByToken(muonToken, muons);
+    Run(muonMeasurements, *muons);
+    
+    edm::Handle<edm::View<pat::Jet>> jets;
+    event.getByToken(jetToken, jets);
+    Run(jetMeasurements, *jets);
+    
+    edm::Handle<edm::View<reco::Vertex>> vertices;
+    event.getByToken(vertexToken, vertices);
+    Run(vertexMeasurements, *vertices);
+}
+
+
+void SelectorBenchmark::endJob()
+{
+    cout << "\nComparison of CompiledSelector and StringCutObjectSelector, " << numRepetitions <<
+      " evaluation(s) per object\n";
+    cout << " " << setw(10) << left << "type" << setw(14) << right << "objects" <<
+      setw(18) << "string, ns/obj" << setw(18) << "compiled, ns/obj" << setw(10) << "speedup" <<
+      setw(12) << "mismatches" << "  cut\n";
+    
+    Print("electron", electronMeasurements);
+    Print("muon", muonMeasurements);
+    Print("jet", jetMeasurements);
+    Print("vertex", vertexMeasurements);
+    
+    cout << endl;
+    
+    
+    unsigned long const numMismatches = CountMismatches(electronMeasurements) +
+      CountMismatches(muonMeasurements) + CountMismatches(jetMeasurements) +
+      CountMismatches(vertexMeasurements);
+    
+    if (failOnMismatch and numMismatches > 0)
+    {
+        cms::Exception excp("SelectorBenchmark");
+        excp << "CompiledSelector and StringCutObjectSelector disagree for " << numMismatches <<
+          " object(s). See the summary table for the affected selections.\n";
+        excp.raise();
+    }
+}
+
+
+void SelectorBenchmark::fillDescriptions(edm::ConfigurationDescriptions &descriptions)
+{
+    edm::ParameterSetDescription desc;
+    desc.add<edm::InputTag>("electrons", edm::InputTag("slimmedElectrons"))->
+      setComment("Collection of electrons.");
+    desc.add<edm::InputTag>("muons", edm::InputTag("slimmedMuons"))->
+      setComment("Collection of muons.");
+    desc.add<edm::InputTag>("jets", edm::InputTag("slimmedJets"))->
+      setComment("Collection of jets.");
+    desc.add<edm::InputTag>("vertices", edm::InputTag("offlineSlimmedPrimaryVertices"))->
+      setComment("Collection of vertices.");
+    desc.add<vector<string>>("electronCuts", vector<string>())->
+      setComment("Selections to evaluate on electrons.");
+    desc.add<vector<string>>("muonCuts", vector<string>())->
+      setComment("Selections to evaluate on muons.");
+    desc.add<vector<string>>("jetCuts", vector<string>())->
+      setComment("Selections to evaluate on jets.");
+    desc.add<vector<string>>("vertexCuts", vector<string>())->
+      setComment("Selections to evaluate on vertices.");
+    desc.add<unsigned>("numRepetitions", 100)->
+      setComment("Number of times each selection is evaluated for each object.");
+    desc.add<bool>("failOnMismatch", false)->
+      setComment("Throw an exception at the end of the job if the two selectors disagree.");
+    
+    descriptions.add("selectorBenchmark", desc);
+}
+
+
+template<typename T>
+void SelectorBenchmark::Book(vector<unique_ptr<Measurement<T>>> &measurements,
+  vector<string> const &cuts)
+{
+    for (string const &cut: cuts)
+        measurements.emplace_back(new Measurement<T>(cut));
+}
+
+
+template<typename T>
+void SelectorBenchmark::Run(vector<unique_ptr<Measurement<T>>> &measurements,
+  edm::View<T> const &objects) const
+{
+    using Clock = chrono::steady_clock;
+    
+    for (auto &m: measurements)
+    {
+        // Decisions are not used in the timed loops, but the compiler cannot remove the calls since
+        //both selectors evaluate the expression through indirect calls
+        auto start = Clock::now();
+        
+        for (unsigned r = 0; r < numRepetitions; ++r)
+            for (T const &object: objects)
+                m->reference(object);
+        
+        m->referenceTime += chrono::duration<double>(Clock::now() - start).count();
+        
+        start = Clock::now();
+        
+        for (unsigned r = 0; r < numRepetitions; ++r)
+            for (T const &object: objects)
+                m->compiled(object);
+        
+        m->compiledTime += chrono::duration<double>(Clock::now() - start).count();
+        
+        
+        // Compare decisions outside of the timed loops
+        for (T const &object: objects)
+        {
+            if (m->reference(object) != m->compiled(object))
+                ++m->numMismatches;
+        }
+        
+        m->numObjects += objects.size();
+    }
+}
+
+
+template<typename T>
+void SelectorBenchmark::Print(string const &label,
+  vector<unique_ptr<Measurement<T>>> const &measurements) const
+{
+    for (auto const &m: measurements)
+    {
+        double const numEvaluations = double(m->numObjects) * numRepetitions;
+        double const norm = (numEvaluations > 0.) ? 1e9 / numEvaluations : 0.;
+        
+        cout << " " << setw(10) << left << label << setw(14) << right << m->numObjects <<
+          fixed << setprecision(2) << setw(18) << m->referenceTime * norm << setw(18) <<
+          m->compiledTime * norm << setw(10) << setprecision(1) <<
+          ((m->compiledTime > 0.) ? m->referenceTime / m->compiledTime : 0.) << setw(12) <<
+          m->numMismatches << "  " << m->cut << (m->compiled.IsCompiled() ? "" : " (fallback)") <<
+          '\n';
+    }
+}
+
+
+template<typename T>
+unsigned long SelectorBenchmark::CountMismatches(
+  vector<unique_ptr<Measurement<T>>> const &measurements)
+{
+    unsigned long numMismatches = 0;
+    
+    for (auto const &m: measurements)
+        numMismatches += m->numMismatches;
+    
+    return numMismatches;
+}
+
+
+DEFINE_FWK_MODULE(SelectorBenchmark);
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "CompiledSelector.h"
+
+#include <FWCore/Framework/interface/one/EDAnalyzer.h>
+#include <FWCore/Framework/interface/Event.h>
+#include <FWCore/ParameterSet/interface/ParameterSet.h>
+#include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
+#include <FWCore/ParameterSet/interface/ParameterSetDescription.h>
+
+#include <DataFormats/Common/interface/View.h>
+#include <DataFormats/PatCandidates/interface/Electron.h>
+#include <DataFormats/PatCandidates/interface/Jet.h>
+#include <DataFormats/PatCandidates/interface/Muon.h>
+#include <DataFormats/VertexReco/interface/Vertex.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/**
+ * \class SelectorBenchmark
+ * \brief Compares CompiledSelector with StringCutObjectSelector on real events
+ * 
+ * For each configured selection string and each object in the corresponding input collection,
+ * the plugin evaluates the selection with both StringCutObjectSelector and CompiledSelector and
+ * measures the time spent in each of them. Each evaluation is repeated the given number of times
+ * to make the measurement less sensitive to the overhead of the timer. Decisions of the two
+ * selectors are compared, and the number of disagreements is reported. A summary table is printed
+ * at the end of the job. If requested, an exception is thrown at the end of the job when any
+ * disagreement has been found, which allows to use the plugin as a test of CompiledSelector.
+ * 
+ * The plugin is meant to be run single-threaded and does not write any output file.
+ */
+class SelectorBenchmark: public edm::one::EDAnalyzer<>
+{
+private:
+    /**
+     * \struct Measurement
+     * \brief Selectors and accumulated timing for a single selection string
+     */
+    template<typename T>
+    struct Measurement
+    {
+        /// Constructor
+        Measurement(std::string const &cut);
+        
+        /// Selection string
+        std::string cut;
+        
+        /// Reference selector
+        StringCutObjectSelector<T> reference;
+        
+        /// Selector under test
+        CompiledSelector<T> compiled;
+        
+        /// Total time spent in the two selectors, s
+        double referenceTime, compiledTime;
+        
+        /// Number of evaluated objects and number of disagreements between the selectors
+        unsigned long numObjects, numMismatches;
+    };
+    
+public:
+    /// Constructor
+    SelectorBenchmark(edm::ParameterSet const &cfg);
+    
+public:
+    /// Evaluates all selections on objects in the current event
+    virtual void analyze(edm::Event const &event, edm::EventSetup const &) override;
+    
+    /// Prints the summary table
+    virtual void endJob() override;
+    
+    /// Verifies configuration of the plugin
+    static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
+    
+private:
+    /// Constructs measurements for the given selection strings
+    template<typename T>
+    static void Book(std::vector<std::unique_ptr<Measurement<T>>> &measurements,
+      std::vector<std::string> const &cuts);
+    
+    /// Evaluates all selections of the same type on the given collection
+    template<typename T>
+    void Run(std::vector<std::unique_ptr<Measurement<T>>> &measurements,
+      edm::View<T> const &objects) const;
+    
+    /// Prints results for the given selections
+    template<typename T>
+    void Print(std::string const &label,
+      std::vector<std::unique_ptr<Measurement<T>>> const &measurements) const;
+    
+    /// Counts disagreements between the selectors summed over the given selections
+    template<typename T>
+    static unsigned long CountMismatches(
+      std::vector<std::unique_ptr<Measurement<T>>> const &measurements);
+    
+private:
+    /// Input collections
+    edm::EDGetTokenT<edm::View<pat::Electron>> electronToken;
+    edm::EDGetTokenT<edm::View<pat::Muon>> muonToken;
+    edm::EDGetTokenT<edm::View<pat::Jet>> jetToken;
+    edm::EDGetTokenT<edm::View<reco::Vertex>> vertexToken;
+    
+    /// Number of times each selection is evaluated for each object
+    unsigned numRepetitions;
+    
+    /// Requests that the job fails if the two selectors disagree
+    bool failOnMismatch;
+    
+    /// Measurements for all configured selections
+    std::vector<std::unique_ptr<Measurement<pat::Electron>>> electronMeasurements;
+    std::vector<std::unique_ptr<Measurement<pat::Muon>>> muonMeasurements;
+    std::vector<std::unique_ptr<Measurement<pat::Jet>>> jetMeasurements;
+    std::vector<std::unique_ptr<Measurement<reco::Vertex>>> vertexMeasurements;
+};
@@ -0,0 +1,49 @@
+#include "SignedKahanSum.h"
+
+
+SignedKahanSum::SignedKahanSum() noexcept:
+    posSum(0.), negSum(0.),
+    posCompensation(0.), negCompensation(0.)
+{}
+
+
+void SignedKahanSum::Fill(double x)
+{
+    if (x >= 0.)
+        KahanAdd(posSum, posCompensation, x);
+    else
+    {
+        // Run the standard Kahan algorithm with the inverted input
+        KahanAdd(negSum, negCompensation, -x);
+    }
+}
+
+
+double SignedKahanSum::GetSum() const
+{
+    // Since there might be a catastrophic cancellation between the positive and negative sums,
+    //take into account also the correction from the compensations
+    return (posSum - negSum) - (posCompensation - negCompensation);
+}
+
+
+void SignedKahanSum::Merge(SignedKahanSum const &other)
+{
+    // The compensations hold the small parts that have been lost in the sums and will be
+    //subtracted from the next added numbers. Carry over the compensations of the other summator
+    //and then add its sums as regular numbers
+    posCompensation += other.posCompensation;
+    negCompensation += other.negCompensation;
+    
+    KahanAdd(posSum, posCompensation, other.posSum);
+    KahanAdd(negSum, negCompensation, other.negSum);
+}
+
+
+void SignedKahanSum::KahanAdd(double &sum, double &compensation, double x)
+{
+    double const xCompensated = x - compensation;
+    double const newSum = sum + xCompensated;
+    compensation = (newSum - sum) - xCompensated;
+    sum = newSum;
+}
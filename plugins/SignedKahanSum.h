@@ -0,0 +1,46 @@
+#pragma once
+
+
+/**
+ * \class SignedKahanSum
+ * \brief Implements compensated summation for positive and negative numbers separately
+ * 
+ * This class computes a sum of the given sequence of numbers on the fly. It tries to compensate
+ * for errors arising from the floating-point arithmetic using the Kahan summation algorithm [1].
+ * Summation is done independently for positive and negative numbers in order to prevent a
+ * catastrophic cancellation. Partial sums computed independently (for instance, in different
+ * streams) can be combined with method Merge.
+ * [1] https://en.wikipedia.org/wiki/Kahan_summation_algorithm
+ */
+class SignedKahanSum
+{
+public:
+    /// Trivial constructor
+    SignedKahanSum() noexcept;
+    
+public:
+    /// Adds a new number to the sum
+    void Fill(double x);
+    
+    /// Returns the current sum
+    double GetSum() const;
+    
+    /**
+     * \brief Adds another sum to this one
+     * 
+     * Positive and negative parts are combined separately, and their compensations are carried
+     * over, so the result is equivalent to filling all numbers into a single summator.
+     */
+    void Merge(SignedKahanSum const &other);
+    
+private:
+    /// Adds a number to the given sum using the Kahan algorithm
+    static void KahanAdd(double &sum, double &compensation, double x);
+    
+private:
+    /// Current sums of positive and negative numbers
+    double posSum, negSum;
+    
+    /// Compensation values for the two sums, which are used in the Kahan algorithm
+    double posCompensation, negCompensation;
+};
@@ -7,6 +7,9 @@
 
 #include <boost/algorithm/string/predicate.hpp>
 
+#include <algorithm>
+#include <iterator>
+#include <string>
 #include <vector>
 
 
@@ -14,17 +17,21 @@ using namespace std;
 
 
 TriggerState::TriggerState():
-    inMenu(false),
-    index(0),
     wasRun(false),
     accept(false),
     prescale(0)
 {}
 
 
+SlimTriggerResultsStreamState::SlimTriggerResultsStreamState():
+    menuIndices(nullptr)
+{}
+
+
 SlimTriggerResults::SlimTriggerResults(edm::ParameterSet const &cfg):
     filterOn(cfg.getParameter<bool>("filter")),
-    savePrescales(cfg.getParameter<bool>("savePrescales"))
+    savePrescales(cfg.getParameter<bool>("savePrescales")),
+    packBits(cfg.getParameter<bool>("packBits"))
 {
     // Push trigger names provided by the user into a map
     auto const &triggerNames = cfg.getParameter<vector<string>>("triggers");
@@ -62,32 +69,98 @@ SlimTriggerResults::SlimTriggerResults(edm::ParameterSet const &cfg):
 void SlimTriggerResults::beginJob()
 {
     // Create the output tree
-    triggerTree = fileService->make<TTree>("TriggerInfo", "States of selected triggers");
+    triggerTree = treeFillService->BookTree(this, "TriggerInfo", "States of selected triggers");
+    
+    
+    // In the packed layout, states of all triggers are written into three array branches of a
+    //fixed size, and names of triggers are written once into a separate tree
+    if (packBits)
+    {
+        unsigned const numWords = (triggers.size() + 63) / 64;
+        wasRunBits.assign(numWords, 0);
+        acceptBits.assign(numWords, 0);
+        
+        string const wordsSuffix("[" + to_string(numWords) + "]/l");
+        triggerTree->Branch(BranchName("wasRunBits").c_str(), wasRunBits.data(),
+          (BranchName("wasRunBits") + wordsSuffix).c_str());
+        triggerTree->Branch(BranchName("acceptBits").c_str(), acceptBits.data(),
+          (BranchName("acceptBits") + wordsSuffix).c_str());
+        
+        if (savePrescales)
+        {
+            prescales.assign(triggers.size(), 0);
+            triggerTree->Branch(BranchName("prescales").c_str(), prescales.data(),
+              (BranchName("prescales") + "[" + to_string(triggers.size()) + "]/i").c_str());
+        }
+        
+        
+        TTree *namesTree = fileService->make<TTree>("TriggerBits",
+          "Names of triggers for each bit in the packed layout");
+        
+        UInt_t bfBit = 0;
+        string bfName;
+        namesTree->Branch("bit", &bfBit);
+        namesTree->Branch("name", &bfName);
+        
+        for (auto const &t: triggers)
+        {
+            bfName = t.first;
+            namesTree->Fill();
+            ++bfBit;
+        }
+        
+        return;
+    }
+    
     
-    // Assign branches to it
+    // Assign branches for each trigger
     for (auto &t: triggers)
     {
-        triggerTree->Branch((t.first + "__wasRun").c_str(), &t.second.wasRun);
-        triggerTree->Branch((t.first + "__accept").c_str(), &t.second.accept);
+        triggerTree->Branch(BranchName(t.first + "__wasRun").c_str(), &t.second.wasRun);
+        triggerTree->Branch(BranchName(t.first + "__accept").c_str(), &t.second.accept);
         
         if (savePrescales)
-            triggerTree->Branch((t.first + "__prescale").c_str(), &t.second.prescale);
+            triggerTree->Branch(BranchName(t.first + "__prescale").c_str(), &t.second.prescale);
     }
 }
 
 
-bool SlimTriggerResults::filter(edm::Event &event, edm::EventSetup const &setup)
+unique_ptr<SlimTriggerResultsStreamState> SlimTriggerResults::beginStream(edm::StreamID) const
+{
+    auto state = make_unique<SlimTriggerResultsStreamState>();
+    state->triggers.resize(triggers.size());
+    return state;
+}
+
+
+bool SlimTriggerResults::filter(edm::StreamID streamID, edm::Event &event,
+  edm::EventSetup const &setup) const
 {
+    SlimTriggerResultsStreamState &state = *streamCache(streamID);
+    
+    
     // Read trigger decisions for the current event
     edm::Handle<edm::TriggerResults> triggerBits;
     event.getByToken(triggerBitsToken, triggerBits);
     
     
-    // Check if the trigger configuration has changed and update trigger indices if needed
-    if (triggerBits->parameterSetID() != prevTriggerParameterSetID)
+    // Check if the trigger configuration has changed and update trigger indices if needed. Indices
+    //are only resolved from trigger names for menus that have not been seen in this stream before
+    if (triggerBits->parameterSetID() != state.triggerParameterSetID or not state.menuIndices)
     {
-        UpdateMenu(event.triggerNames(*triggerBits));
-        prevTriggerParameterSetID = triggerBits->parameterSetID();
+        auto res = state.menuIndicesCache.find(triggerBits->parameterSetID());
+        
+        if (res == state.menuIndicesCache.end())
+            res = state.menuIndicesCache.emplace(triggerBits->parameterSetID(),
+              ResolveMenu(event.triggerNames(*triggerBits))).first;
+        
+        state.menuIndices = &res->second;
+        state.triggerParameterSetID = triggerBits->parameterSetID();
+        
+        
+        // Reset all trigger buffers since some triggers might be missing in the new menu
+        for (auto &t: state.triggers)
+            t = TriggerState();
     }
     
     
@@ -108,36 +181,92 @@ bool SlimTriggerResults::filter(edm::Event &event, edm::EventSetup const &setup)
     
     
     // Fill buffers for all selected triggers
-    for (auto &t: triggers)
+    vector<int> const &menuIndices = *state.menuIndices;
+    
+    for (unsigned i = 0; i < state.triggers.size(); ++i)
     {
         // Continue to the next trigger if the current one is not in the current menu
-        if (not t.second.inMenu)
+        int const index = menuIndices[i];
+        
+        if (index < 0)
             continue;
         
         
         // Update state of the current trigger
-        t.second.wasRun = triggerBits->wasrun(t.second.index);
-        t.second.accept = triggerBits->accept(t.second.index);
+        TriggerState &t = state.triggers[i];
+        t.wasRun = triggerBits->wasrun(index);
+        t.accept = triggerBits->accept(index);
         
         if (savePrescales)
-            t.second.prescale = hltPrescales->getPrescaleForIndex(t.second.index) *
-              l1tPrescales->getPrescaleForIndex(t.second.index);
+            t.prescale = hltPrescales->getPrescaleForIndex(index) *
+              l1tPrescales->getPrescaleForIndex(index);
         
         
-        if (t.second.wasRun and t.second.accept)
+        if (t.wasRun and t.accept)
             result = true;
     }
     
     
-    // Fill the output tree if the event is accepted
+    // Fill the output tree if the event is accepted. This is done by TreeFillService once all
+    //PEC plugins have processed the event
     if (result or not filterOn)
-        triggerTree->Fill();
+        treeFillService->Commit(this, streamID);
     
     
     return (filterOn) ? result : true;
 }
 
 
+void SlimTriggerResults::AllocateSlots(unsigned numSlots)
+{
+    stagedTriggers.assign(numSlots, vector<TriggerState>(triggers.size()));
+}
+
+
+void SlimTriggerResults::StageEntry(edm::StreamID streamID, unsigned slot)
+{
+    stagedTriggers[slot] = streamCache(streamID)->triggers;
+}
+
+
+void SlimTriggerResults::MoveToTree(unsigned slot)
+{
+    auto const &triggerStates = stagedTriggers[slot];
+    
+    if (packBits)
+    {
+        fill(wasRunBits.begin(), wasRunBits.end(), 0);
+        fill(acceptBits.begin(), acceptBits.end(), 0);
+        
+        for (unsigned i = 0; i < triggerStates.size(); ++i)
+        {
+            ULong64_t const mask = ULong64_t(1) << (i % 64);
+            
+            if (triggerStates[i].wasRun)
+                wasRunBits[i / 64] |= mask;
+            
+            if (triggerStates[i].accept)
+                acceptBits[i / 64] |= mask;
+            
+            if (savePrescales)
+                prescales[i] = triggerStates[i].prescale;
+        }
+        
+        return;
+    }
+    
+    unsigned i = 0;
+    
+    for (auto &t: triggers)
+    {
+        t.second.wasRun = triggerStates[i].wasRun;
+        t.second.accept = triggerStates[i].accept;
+        t.second.prescale = triggerStates[i].prescale;
+        ++i;
+    }
+}
+
+
 void SlimTriggerResults::fillDescriptions(edm::ConfigurationDescriptions &descriptions)
 {
     // Documentation for descriptions of the configuration is available in [1]
@@ -151,6 +280,9 @@ void SlimTriggerResults::fillDescriptions(edm::ConfigurationDescriptions &descri
       "rejected.");
     desc.add<bool>("savePrescales", true)->
       setComment("Specifies whether trigger prescales should be saved.");
+    desc.add<bool>("packBits", false)->
+      setComment("Specifies whether states of triggers should be packed into bit words instead of "
+      "being stored in separate branches.");
     desc.add<edm::InputTag>("triggerBits", edm::InputTag("TriggerResults"))->
       setComment("Trigger decisions.");
     desc.add<edm::InputTag>("hltPrescales", edm::InputTag("patTrigger"))->
@@ -194,32 +326,22 @@ string SlimTriggerResults::GetTriggerBasename(string const &name)
 }
 
 
-void SlimTriggerResults::UpdateMenu(edm::TriggerNames const &triggerNames)
+vector<int> SlimTriggerResults::ResolveMenu(edm::TriggerNames const &triggerNames) const
 {
-    // Reset all trigger buffers
-    for (auto &t: triggers)
-    {
-        t.second.inMenu = false;
-        t.second.index = 0;
-        t.second.wasRun = false;
-        t.second.accept = false;
-        t.second.prescale = 0;
-    }
+    vector<int> menuIndices(triggers.size(), -1);
     
     
     // Loop over names of all triggers in the menu
     for (unsigned i = 0; i < triggerNames.size(); ++i)
     {
-        // Update the full trigger name in the associated TriggerState object if the
-        //current trigger's name is among the names of selected triggers
+        // Record the index of the trigger if its name is among the names of selected triggers
         auto res = triggers.find(GetTriggerBasename(triggerNames.triggerName(i)));
         
         if (res != triggers.end())
-        {
-            res->second.inMenu = true;
-            res->second.index = i;
-        }
+            menuIndices[distance(triggers.begin(), res)] = i;
     }
+    
+    return menuIndices;
 }
 
 
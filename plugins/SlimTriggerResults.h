@@ -1,10 +1,12 @@
 #pragma once
 
+#include "TreeFillService.h"
+
 #include <DataFormats/Common/interface/TriggerResults.h>
 #include <FWCore/Common/interface/TriggerNames.h>
 #include <DataFormats/PatCandidates/interface/PackedTriggerPrescales.h>
 
-#include <FWCore/Framework/interface/EDFilter.h>
+#include <FWCore/Framework/interface/global/EDFilter.h>
 #include <FWCore/Framework/interface/Event.h>
 #include <FWCore/ParameterSet/interface/ParameterSet.h>
 #include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
@@ -15,33 +17,27 @@
 
 #include <TTree.h>
 
-#include <string>
 #include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
 
 /**
  * \struct TriggerState
  * \brief An auxiliary structure to represent a state of a trigger path in the current event
  * 
- * It contains a fully-qualified name of the trigger in the current menu, which can change over time
- * (due to the change in version number). The structure also host several buffers, which are used to
- * fill the output tree in the SlimTriggerResults class.
+ * The structure hosts several buffers, which are used to fill the output tree in the
+ * SlimTriggerResults class.
+ * 
+ * Each stream keeps its own copy of these structures. Copies owned by the plugin itself only serve
+ * as buffers for the output tree.
  */
 struct TriggerState
 {
     /// Default constructor
     TriggerState();
     
-    /**
-     * \brief Indicates if the trigger is present in the current menu
-     * 
-     * It might happen that some of triggers requested by user are missing in some of menus.
-     */
-    bool inMenu;
-    
-    /// Index of the trigger in the (current) menu
-    unsigned index;
-    
     /**
      * \brief A buffer to indicate whether the trigger was run in the current event
      * 
@@ -65,6 +61,40 @@ struct TriggerState
 };
 
 
+/**
+ * \struct SlimTriggerResultsStreamState
+ * \brief States of selected triggers in a single stream
+ */
+struct SlimTriggerResultsStreamState
+{
+    /// Constructor
+    SlimTriggerResultsStreamState();
+    
+    /**
+     * \brief ID of the previous trigger configuration
+     * 
+     * It is used to discover updates in the trigger menu.
+     */
+    edm::ParameterSetID triggerParameterSetID;
+    
+    /**
+     * \brief Indices of selected triggers in all menus seen in this stream
+     * 
+     * The key is the ID of the trigger configuration. Indices are ordered in the same way as in
+     * SlimTriggerResults::triggers. A trigger that is missing in the menu has index -1. When the
+     * configuration switches back to a menu that has already been seen, indices are taken from
+     * here and trigger names are not read again.
+     */
+    std::map<edm::ParameterSetID, std::vector<int>> menuIndicesCache;
+    
+    /// Indices of selected triggers in the current menu. Points to an element of menuIndicesCache
+    std::vector<int> const *menuIndices;
+    
+    /// States of selected triggers, ordered in the same way as in SlimTriggerResults::triggers
+    std::vector<TriggerState> triggers;
+};
+
+
 /**
  * \class SlimTriggerResults
  * \brief An EDM plugin to save information about selected trigger paths
@@ -79,6 +109,13 @@ struct TriggerState
  * trigger: a boolean indicating if the trigger was executed in the current event, a boolean showing
  * if the current event was accepted by the trigger, and an integer with the trigger prescale.
  * 
+ * If parameter "packBits" is set, a compact layout is used instead, with three branches in total.
+ * Branches "wasRunBits" and "acceptBits" are fixed-size arrays of 64-bit words, and bit (i % 64)
+ * of word (i / 64) describes the trigger with index i. Branch "prescales" is a fixed-size array
+ * with a prescale for each trigger. The mapping from indices to trigger names (without the "HLT_"
+ * prefix and version postfix) is stored in a separate tree "TriggerBits". Triggers are indexed in
+ * the alphabetical order of their names.
+ * 
  * The prescale is computed as the product of the given L1T and HLT prescale factors. Since a single
  * HLT path can be seeded by multiple L1T bits, minimal and maximal prescales of the exploited
  * seeds are stored in MiniAOD [1]. User is normally expected to provide the tag of the collection
@@ -87,20 +124,43 @@ struct TriggerState
  * The plugin can be configured in such a way that it rejects an event if it is not accepted by any
  * of the selected triggers. The default behaviour is to reject no events.
  * 
+ * If the plugin rejects an event, it does not commit it to TreeFillService, and the event is then
+ * not written into the trees of any PEC plugin.
+ * 
  * [1] https://twiki.cern.ch/twiki/bin/view/CMSPublic/WorkBookMiniAOD2015?rev=96#Trigger
  */
-class SlimTriggerResults: public edm::EDFilter
+class SlimTriggerResults:
+  public edm::global::EDFilter<edm::StreamCache<SlimTriggerResultsStreamState>>,
+  public TreeFillService::Client
 {
 public:
     /// Constructor from a configuration
     SlimTriggerResults(edm::ParameterSet const &cfg);
     
 public:
-    /// Creates the output tree
+    /**
+     * \brief Creates the output tree and registers it in TreeFillService
+     * 
+     * With the packed layout, also writes the tree with names of triggers.
+     */
     virtual void beginJob() override;
     
-    /// Fills the output tree for each event
-    virtual bool filter(edm::Event &event, edm::EventSetup const &setup) override;
+    /// Creates trigger states for the given stream
+    virtual std::unique_ptr<SlimTriggerResultsStreamState> beginStream(edm::StreamID) const
+      override;
+    
+    /// Updates trigger states of the stream for each event
+    virtual bool filter(edm::StreamID streamID, edm::Event &event, edm::EventSetup const &setup)
+      const override;
+    
+    /// Allocates buffers for staging slots of TreeFillService
+    virtual void AllocateSlots(unsigned numSlots) override;
+    
+    /// Copies trigger states of the given stream into the given staging slot
+    virtual void StageEntry(edm::StreamID streamID, unsigned slot) override;
+    
+    /// Copies trigger states from the given staging slot into buffers of the output tree
+    virtual void MoveToTree(unsigned slot) override;
     
 public:
     /// A method to verify plugin's configuration
@@ -111,12 +171,13 @@ private:
     static std::string GetTriggerBasename(std::string const &name);
     
     /**
-     * \brief Updates indices of selected triggers in the menu
+     * \brief Finds indices of selected triggers in the menu
      * 
-     * Should be called when the trigger menu changes as it might invalidate trigger indices. It is
-     * the only method that reads trigger names.
+     * Should be called when the trigger menu changes to a menu that has not been seen in the
+     * stream yet. It is the only method that reads trigger names. The indices are ordered in the
+     * same way as in the map of triggers, and -1 is used for triggers missing in the menu.
      */
-    void UpdateMenu(edm::TriggerNames const &triggerNames);
+    std::vector<int> ResolveMenu(edm::TriggerNames const &triggerNames) const;
     
 private:
     /**
@@ -143,20 +204,26 @@ private:
     /// Specifies whether prescale column should be saved
     bool const savePrescales;
     
-    /// An object to handle the output ROOT file
+    /// Specifies whether states of triggers are packed into bit words
+    bool const packBits;
+    
+    /// Buffers for the packed layout
+    std::vector<ULong64_t> wasRunBits, acceptBits;
+    std::vector<UInt_t> prescales;
+    
+    /// Service that fills the output tree
+    edm::Service<TreeFillService> treeFillService;
+    
+    /// Service to create the tree with names of triggers in the packed layout
     edm::Service<TFileService> fileService;
     
     /**
      * \brief The output tree
      * 
-     * The tree is managed by the fileService object and will be deleted by its descructor.
+     * The tree is managed by TFileService and will be deleted by its descructor.
      */
     TTree *triggerTree;
     
-    /**
-     * \brief ID of the previous trigger configuration
-     * 
-     * It is used to discover updates in the trigger menu.
-     */
-    edm::ParameterSetID prevTriggerParameterSetID;
+    /// States of selected triggers in events queued for writing, indexed with staging slot
+    std::vector<std::vector<TriggerState>> stagedTriggers;
 };
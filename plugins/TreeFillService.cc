@@ -0,0 +1,333 @@
+#include "TreeFillService.h"
+
+#include <DataFormats/Provenance/interface/ModuleDescription.h>
+#include <FWCore/ParameterSet/interface/ParameterSetDescription.h>
+#include <FWCore/ServiceRegistry/interface/ServiceMaker.h>
+#include <FWCore/ServiceRegistry/interface/SystemBounds.h>
+#include <FWCore/Utilities/interface/EDMException.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+
+using namespace std;
+
+
+string TreeFillService::Client::BranchName(string const &name) const
+{
+    return branchPrefix + name;
+}
+
+
+TreeFillService::TreeFillService(edm::ParameterSet const &cfg, edm::ActivityRegistry &registry):
+    implicitMT(cfg.getParameter<bool>("implicitMT")),
+    autoFlush(cfg.getParameter<long long>("autoFlush")),
+    reportTiming(cfg.getParameter<bool>("reportTiming")),
+    sharedTree(nullptr),
+    numSlots(0),
+    stopWriter(false),
+    numFills(0),
+    fillTime(0.), blockedTime(0.)
+{
+    registry.watchPreallocate([this](edm::service::SystemBounds const &bounds)
+    {
+        committed.assign(bounds.maxNumberOfStreams(), vector<bool>(clients.size(), false));
+        numCommits.assign(bounds.maxNumberOfStreams(), 0);
+        numSlots = 2 * bounds.maxNumberOfStreams();
+    });
+    
+    // Clients book their trees in beginJob, so the slots can only be allocated after it
+    registry.watchPostBeginJob([this](){StartWriter();});
+    
+    // Clients might use their trees in endJob, so all entries must be written by then
+    registry.watchPreModuleEndJob([this](edm::ModuleDescription const &){Drain();});
+    
+    if (reportTiming)
+        registry.watchPostEndJob([this](){PrintTimingSummary();});
+}
+
+
+TreeFillService::~TreeFillService()
+{
+    // Entries that are still queued are dropped. This only happens if the job is aborted
+    {
+        lock_guard<mutex> lock(fillMutex);
+        stopWriter = true;
+    }
+    
+    queueUpdated.notify_all();
+    
+    if (writer.joinable())
+        writer.join();
+}
+
+
+void TreeFillService::fillDescriptions(edm::ConfigurationDescriptions &descriptions)
+{
+    edm::ParameterSetDescription desc;
+    desc.add<bool>("implicitMT", false)->
+      setComment("Enables ROOT implicit multithreading for output trees.");
+    desc.add<long long>("autoFlush", 0)->
+      setComment("Value for TTree::SetAutoFlush. Zero means the default of ROOT.");
+    desc.add<bool>("reportTiming", false)->
+      setComment("Requests printing of time spent filling the trees and time saved by writing "
+      "them asynchronously at the end of the job.");
+    
+    descriptions.add("TreeFillService", desc);
+}
+
+
+TTree *TreeFillService::BookTree(Client *client, string const &name, string const &title)
+{
+    lock_guard<mutex> lock(fillMutex);
+    TTree *tree;
+    
+    if (sharedTree)
+    {
+        tree = sharedTree;
+        client->branchPrefix = name + "_";
+    }
+    else
+    {
+        tree = fileService->make<TTree>(name.c_str(), title.c_str());
+        ConfigureTree(tree);
+    }
+    
+    clients.emplace_back(client);
+    
+    for (auto &streamCommitted: committed)
+        streamCommitted.assign(clients.size(), false);
+    
+    if (find(trees.begin(), trees.end(), tree) == trees.end())
+        trees.emplace_back(tree);
+    
+    return tree;
+}
+
+
+void TreeFillService::Commit(Client const *client, edm::StreamID streamID)
+{
+    auto const start = chrono::steady_clock::now();
+    unique_lock<mutex> lock(fillMutex);
+    CheckWriter();
+    
+    unsigned const iClient = find(clients.begin(), clients.end(), client) - clients.begin();
+    
+    if (iClient == clients.size())
+    {
+        edm::Exception excp(edm::errors::LogicError);
+        excp << "A client that has not been registered attempts to commit an event.";
+        excp.raise();
+    }
+    
+    vector<bool> &streamCommitted = committed.at(streamID.value());
+    unsigned &n = numCommits.at(streamID.value());
+    
+    
+    // If this client has already committed in this stream, the previous event has not reached
+    //some other clients. Drop it
+    if (streamCommitted[iClient])
+    {
+        streamCommitted.assign(clients.size(), false);
+        n = 0;
+    }
+    
+    streamCommitted[iClient] = true;
+    ++n;
+    
+    // When all clients have processed the current event in this stream, queue it for writing
+    //unless this is done by the output module
+    if (n == clients.size() and not sharedTree)
+        StageEntry(streamID, lock);
+    
+    AddElapsedTime(start, blockedTime);
+}
+
+
+void TreeFillService::SetSharedTree(TTree *tree)
+{
+    lock_guard<mutex> lock(fillMutex);
+    
+    if (not clients.empty())
+    {
+        edm::Exception excp(edm::errors::LogicError);
+        excp << "Shared tree is set after some clients have booked their trees.";
+        excp.raise();
+    }
+    
+    sharedTree = tree;
+    ConfigureTree(sharedTree);
+}
+
+
+void TreeFillService::Write(edm::StreamID streamID)
+{
+    auto const start = chrono::steady_clock::now();
+    unique_lock<mutex> lock(fillMutex);
+    CheckWriter();
+    
+    unsigned const n = numCommits.at(streamID.value());
+    
+    if (n != clients.size())
+    {
+        edm::Exception excp(edm::errors::LogicError);
+        excp << "An event selected for output has been processed by only " << n << " out of " <<
+          clients.size() << " clients of TreeFillService. Make sure that the output module " <<
+          "only selects paths that include all PEC plugins.";
+        excp.raise();
+    }
+    
+    StageEntry(streamID, lock);
+    AddElapsedTime(start, blockedTime);
+}
+
+
+void TreeFillService::AddElapsedTime(chrono::steady_clock::time_point start, double &counter)
+{
+    counter += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+
+void TreeFillService::CheckWriter() const
+{
+    if (writerException)
+        rethrow_exception(writerException);
+}
+
+
+void TreeFillService::ConfigureTree(TTree *tree) const
+{
+    // Only enable implicit multithreading if requested. Otherwise keep the default of the tree,
+    //which follows the global setting of ROOT
+    if (implicitMT)
+        tree->SetImplicitMT(true);
+    
+    if (autoFlush != 0)
+        tree->SetAutoFlush(autoFlush);
+}
+
+
+void TreeFillService::Drain()
+{
+    unique_lock<mutex> lock(fillMutex);
+    slotReleased.wait(lock, [this](){return queuedSlots.empty() or writerException;});
+    CheckWriter();
+}
+
+
+void TreeFillService::PrintTimingSummary() const
+{
+    // Trees are flushed when the file is written, which is done after this summary. Time spent on
+    //the final flush is therefore not included
+    double const msFillPerEvent = (numFills > 0) ? 1e3 * fillTime / numFills : 0.;
+    double const msBlockedPerEvent = (numFills > 0) ? 1e3 * blockedTime / numFills : 0.;
+    
+    ostringstream summary;
+    summary << "TreeFillService timing summary:\n";
+    summary << " Implicit multithreading for output trees: " <<
+      (implicitMT ? "on" : "default of ROOT") << '\n';
+    summary << " Entries filled: " << numFills << '\n';
+    summary << fixed << setprecision(4);
+    summary << " Time to fill an entry in the writer thread: " << msFillPerEvent <<
+      " ms (total " << fillTime << " s)\n";
+    summary << " Time event processing was blocked: " << msBlockedPerEvent << " ms per entry " <<
+      "(total " << blockedTime << " s)\n";
+    summary << " Time saved by writing asynchronously: " << msFillPerEvent - msBlockedPerEvent <<
+      " ms per entry (total " << fillTime - blockedTime << " s)\n";
+    
+    cout << summary.str() << flush;
+}
+
+
+void TreeFillService::RunWriter()
+{
+    unique_lock<mutex> lock(fillMutex);
+    
+    while (true)
+    {
+        queueUpdated.wait(lock, [this](){return stopWriter or not queuedSlots.empty();});
+        
+        if (stopWriter)
+            break;
+        
+        unsigned const slot = queuedSlots.front();
+        
+        
+        // Clients and trees are not modified during the event loop, so they can be accessed
+        //without the lock. Each client only touches the given slot and its tree buffers here
+        lock.unlock();
+        auto const start = chrono::steady_clock::now();
+        exception_ptr excp;
+        
+        try
+        {
+            for (Client *client: clients)
+                client->MoveToTree(slot);
+            
+            for (TTree *tree: trees)
+                tree->Fill();
+        }
+        catch (...)
+        {
+            excp = current_exception();
+        }
+        
+        AddElapsedTime(start, fillTime);
+        ++numFills;
+        lock.lock();
+        
+        
+        queuedSlots.pop_front();
+        freeSlots.emplace_back(slot);
+        
+        // The exception will be rethrown in the next commit, and no more entries are written
+        if (excp)
+        {
+            writerException = excp;
+            stopWriter = true;
+        }
+        
+        slotReleased.notify_all();
+    }
+}
+
+
+void TreeFillService::StageEntry(edm::StreamID streamID, unique_lock<mutex> &lock)
+{
+    committed.at(streamID.value()).assign(clients.size(), false);
+    numCommits.at(streamID.value()) = 0;
+    
+    // Only wait for the writer if all slots are occupied
+    slotReleased.wait(lock, [this](){return not freeSlots.empty() or writerException;});
+    CheckWriter();
+    
+    unsigned const slot = freeSlots.back();
+    freeSlots.pop_back();
+    
+    for (Client *client: clients)
+        client->StageEntry(streamID, slot);
+    
+    queuedSlots.emplace_back(slot);
+    queueUpdated.notify_one();
+}
+
+
+void TreeFillService::StartWriter()
+{
+    lock_guard<mutex> lock(fillMutex);
+    
+    for (Client *client: clients)
+        client->AllocateSlots(numSlots);
+    
+    freeSlots.clear();
+    
+    for (unsigned slot = 0; slot < numSlots; ++slot)
+        freeSlots.emplace_back(slot);
+    
+    writer = thread(&TreeFillService::RunWriter, this);
+}
+
+
+DEFINE_FWK_SERVICE(TreeFillService);
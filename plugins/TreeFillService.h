@@ -0,0 +1,289 @@
+#pragma once
+
+#include <FWCore/ParameterSet/interface/ParameterSet.h>
+#include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
+#include <FWCore/ServiceRegistry/interface/ActivityRegistry.h>
+#include <FWCore/ServiceRegistry/interface/Service.h>
+#include <FWCore/Utilities/interface/StreamID.h>
+#include <CommonTools/UtilAlgos/interface/TFileService.h>
+
+#include <TTree.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/**
+ * \class TreeFillService
+ * \brief Keeps output trees of PEC plugins aligned when events are processed concurrently
+ * 
+ * PEC plugins write their outputs into separate trees, which are later used as friends of each
+ * other. When the framework processes several events concurrently, different plugins might see
+ * these events in different order, and if each plugin filled its tree on its own, the alignment
+ * between the trees would be lost. This service solves the problem, and all PEC plugins that write
+ * per-event trees rely on it.
+ * 
+ * Plugins register themselves as clients of the service in their beginJob methods by booking
+ * their output trees with method BookTree. In each event a client converts its inputs into
+ * buffers owned by the current stream and then calls method Commit. When all registered clients
+ * have committed for a given stream, the service asks each of them to move the content of the
+ * stream buffers into a staging slot, which only involves swapping or copying a few containers.
+ * Then the slot is queued for a dedicated writer thread, and the stream proceeds with the next
+ * event. The writer thread takes the slots in the order in which they have been queued, asks the
+ * clients to move their content into the buffers attached to the output trees, and fills the trees.
+ * Thus the filling of the trees, including the compression of baskets, does not block event
+ * processing. A stream only has to wait for the writer if all staging slots are occupied, which
+ * bounds the memory used by queued events. There are twice as many slots as streams.
+ * 
+ * An entry is written only for events that have been committed by all clients. If a client commits
+ * a new event in a stream while some other clients have not committed the previous one (which
+ * happens when the previous event has been rejected by a filter placed between the clients), the
+ * previous event is dropped.
+ * 
+ * By default each client gets its own tree, which is created with TFileService in the directory of
+ * the client. If a shared tree is provided with method SetSharedTree (this is done by the output
+ * module PECOutput), all clients write into that tree instead, and names of their branches are
+ * prefixed with names of the trees they have requested. In this mode events are not queued on
+ * commits. Instead, the output module calls method Write for each event it selects.
+ * 
+ * All queued entries are written before the first module's endJob is called, so clients can use
+ * the content of their trees there.
+ * 
+ * The service can enable ROOT implicit multithreading for the output trees (parameter
+ * "implicitMT"). Then baskets are compressed in parallel by ROOT tasks when the trees are flushed.
+ * Implicit multithreading must also be enabled globally, which is done with service
+ * InitRootHandlers. If the parameter is not set, the setting of the trees is not changed. The
+ * number of entries between flushes can be set with parameter "autoFlush". If parameter
+ * "reportTiming" is set, a summary is printed at the end of the job. It compares the time spent by
+ * the writer thread filling the trees with the time during which event processing was blocked by
+ * the service, and reports the difference per event as the time saved by writing asynchronously.
+ */
+class TreeFillService
+{
+public:
+    /**
+     * \class Client
+     * \brief Interface for plugins that use this service
+     */
+    class Client
+    {
+    public:
+        /// Default virtual destructor
+        virtual ~Client() = default;
+        
+    public:
+        /**
+         * \brief Allocates the given number of staging slots
+         * 
+         * Called once before the event loop, after the client has booked its tree.
+         */
+        virtual void AllocateSlots(unsigned numSlots) = 0;
+        
+        /**
+         * \brief Moves content of buffers filled for the given stream into the given staging slot
+         * 
+         * Called by the service under the lock, so the implementation must be cheap. The stream
+         * buffers are reused for the next event in the stream right after this method returns.
+         */
+        virtual void StageEntry(edm::StreamID streamID, unsigned slot) = 0;
+        
+        /**
+         * \brief Moves content of the given staging slot into buffers of output tree
+         * 
+         * Called by the writer thread of the service right before the output trees are filled.
+         * Calls of this method are serialized, but they are not synchronized with StageEntry for
+         * other slots.
+         */
+        virtual void MoveToTree(unsigned slot) = 0;
+        
+    protected:
+        /**
+         * \brief Returns full name for a branch of the output tree of this client
+         * 
+         * Should be used for all branches of the tree returned by BookTree.
+         */
+        std::string BranchName(std::string const &name) const;
+        
+    private:
+        friend class TreeFillService;
+        
+        /// Prefix added to names of all branches of this client
+        std::string branchPrefix;
+    };
+    
+public:
+    /// Constructor
+    TreeFillService(edm::ParameterSet const &cfg, edm::ActivityRegistry &registry);
+    
+    /// Stops the writer thread
+    ~TreeFillService();
+    
+public:
+    /// Verifies configuration of the service
+    static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
+    
+    /**
+     * \brief Creates output tree for the given client and registers the client
+     * 
+     * Returns the shared tree if it has been set. Otherwise a new tree with the given name and
+     * title is created with TFileService. Must be called before the event loop, normally from
+     * beginJob of the client.
+     */
+    TTree *BookTree(Client *client, std::string const &name, std::string const &title);
+    
+    /**
+     * \brief Notifies that the client has processed the current event in the given stream
+     * 
+     * If this is the last client to commit for the stream and there is no shared tree, the event
+     * is queued for writing.
+     */
+    void Commit(Client const *client, edm::StreamID streamID);
+    
+    /**
+     * \brief Sets a tree to be shared by all clients
+     * 
+     * Must be called before any client books its tree, normally from the constructor of the output
+     * module.
+     */
+    void SetSharedTree(TTree *tree);
+    
+    /**
+     * \brief Queues the current event in the given stream for writing into the shared tree
+     * 
+     * Throws an exception if some of the clients have not committed the event.
+     */
+    void Write(edm::StreamID streamID);
+    
+private:
+    /// Applies settings from the configuration to a new output tree
+    void ConfigureTree(TTree *tree) const;
+    
+    /// Allocates staging slots in all clients and starts the writer thread
+    void StartWriter();
+    
+    /**
+     * \brief Moves buffers of all clients for the given stream into a free slot and queues it
+     * 
+     * Waits if there are no free slots. Must be called with the given lock holding fillMutex.
+     */
+    void StageEntry(edm::StreamID streamID, std::unique_lock<std::mutex> &lock);
+    
+    /// Fills the output trees with queued entries until the writer is stopped
+    void RunWriter();
+    
+    /// Waits until all queued entries have been written
+    void Drain();
+    
+    /**
+     * \brief Rethrows the exception thrown in the writer thread, if any
+     * 
+     * Must be called with fillMutex locked.
+     */
+    void CheckWriter() const;
+    
+    /// Prints time spent filling the trees and time during which event processing was blocked
+    void PrintTimingSummary() const;
+    
+    /// Adds time elapsed since the given moment to the given counter
+    static void AddElapsedTime(std::chrono::steady_clock::time_point start, double &counter);
+    
+private:
+    /// An object to handle the output ROOT file
+    edm::Service<TFileService> fileService;
+    
+    /// Indicates whether ROOT implicit multithreading should be enabled for output trees
+    bool const implicitMT;
+    
+    /**
+     * \brief Value for TTree::SetAutoFlush
+     * 
+     * If zero, the default value of ROOT is kept.
+     */
+    long long const autoFlush;
+    
+    /// Indicates whether timing summary should be printed at the end of the job
+    bool const reportTiming;
+    
+    
+    /**
+     * \brief Mutex to protect the bookkeeping of commits and staging slots
+     * 
+     * It is never held while the trees are filled.
+     */
+    std::mutex fillMutex;
+    
+    /// Notifies the writer thread about new entries in the queue and about requests to stop
+    std::condition_variable queueUpdated;
+    
+    /// Notifies streams and Drain that an entry has been written and its slot released
+    std::condition_variable slotReleased;
+    
+    /// Registered clients
+    std::vector<Client *> clients;
+    
+    /// Distinct output trees of all clients
+    std::vector<TTree *> trees;
+    
+    /**
+     * \brief Tree shared by all clients
+     * 
+     * Null unless set by the output module.
+     */
+    TTree *sharedTree;
+    
+    /**
+     * \brief Flags showing which clients have committed the current event
+     * 
+     * The outer index is the stream ID, the inner one is the index of the client.
+     */
+    std::vector<std::vector<bool>> committed;
+    
+    /// Number of clients that have committed the current event, indexed with stream ID
+    std::vector<unsigned> numCommits;
+    
+    /// Total number of staging slots
+    unsigned numSlots;
+    
+    /// Indices of staging slots that are not in use
+    std::vector<unsigned> freeSlots;
+    
+    /**
+     * \brief Indices of staging slots queued for writing, in the order of queueing
+     * 
+     * The slot being written by the writer thread stays at the front until the trees are filled.
+     */
+    std::deque<unsigned> queuedSlots;
+    
+    /// Writer thread that fills the output trees
+    std::thread writer;
+    
+    /// Flag requesting the writer thread to stop
+    bool stopWriter;
+    
+    /// Exception thrown in the writer thread, which is rethrown in the next commit or write
+    std::exception_ptr writerException;
+    
+    
+    /// Number of times the trees have been filled
+    unsigned long long numFills;
+    
+    /**
+     * \brief Total time spent by the writer thread filling the trees, in seconds
+     * 
+     * Includes moving of buffers and compression of baskets.
+     */
+    double fillTime;
+    
+    /**
+     * \brief Total time during which event processing was blocked by the service, in seconds
+     * 
+     * Includes waiting for the lock and for free staging slots, and staging itself.
+     */
+    double blockedTime;
+};
@@ -39,6 +39,10 @@ options.register(
     'labelLHEInfoProduct', 'externalLHEProducer', VarParsing.multiplicity.singleton,
     VarParsing.varType.string, 'Label to access LHEEventProduct'
 )
+options.register(
+    'numThreads', 1, VarParsing.multiplicity.singleton, VarParsing.varType.int,
+    'Number of threads and streams to use'
+)
 
 # Override defaults for automatically defined options
 options.setType('outputFile', VarParsing.varType.string)
@@ -47,6 +51,14 @@ options.setDefault('outputFile', 'eventWeights.root')
 options.parseArguments()
 
 
+# Run the job in several threads if requested.  Setting the number of
+# streams to zero makes it equal to the number of threads.
+process.options = cms.untracked.PSet(
+    numberOfThreads = cms.untracked.uint32(options.numThreads),
+    numberOfStreams = cms.untracked.uint32(0)
+)
+
+
 # Specify the input file
 if len(options.inputFiles) == 0:
     raise RuntimeError, 'No input file is provided'
@@ -69,6 +81,7 @@ if options.storeWeights:
     
     process.TFileService = cms.Service('TFileService',
         fileName = cms.string(outputBaseName + postfix + '.root'))
+    process.TreeFillService = cms.Service('TreeFillService')
 
 
 # The plugin to read and store weights
@@ -75,6 +75,10 @@ options.register(
 #     'isPromptReco', False, VarParsing.multiplicity.singleton, VarParsing.varType.bool,
 #     'In case of data, distinguishes PromptReco and ReReco. Ignored for simulation'
 # )
+options.register(
+    'lumiMask', '', VarParsing.multiplicity.singleton, VarParsing.varType.string,
+    'Luminosity mask in JSON format to apply to data'
+)
 options.register(
     'disableTriggerFilter', False, VarParsing.multiplicity.singleton, VarParsing.varType.bool,
     'Switch off filtering on selected triggers'
@@ -91,6 +95,10 @@ options.register(
     'labelLHEEventProduct', 'externalLHEProducer', VarParsing.multiplicity.singleton,
     VarParsing.varType.string, 'Label to access LHEEventProduct'
 )
+options.register(
+    'weightStorage', 'absolute', VarParsing.multiplicity.singleton, VarParsing.varType.string,
+    'Format to store alternative generator weights: "absolute", "ratio", or "ratio16"'
+)
 options.register(
     'saveGenParticles', False, VarParsing.multiplicity.singleton, VarParsing.varType.bool,
     'Save information about the hard(est) interaction and certain particles'
@@ -99,6 +107,30 @@ options.register(
     'saveGenJets', False, VarParsing.multiplicity.singleton, VarParsing.varType.bool,
     'Save information about generator-level jets'
 )
+options.register(
+    'singleTree', True, VarParsing.multiplicity.singleton, VarParsing.varType.bool,
+    'Write all PEC plugins into a single tree instead of separate ones'
+)
+options.register(
+    'flatBranches', False, VarParsing.multiplicity.singleton, VarParsing.varType.bool,
+    'Store jets, MET, and leptons in counter-plus-array leaf branches instead of object branches'
+)
+options.register(
+    'packTriggerBits', False, VarParsing.multiplicity.singleton, VarParsing.varType.bool,
+    'Store trigger decisions as packed bit words instead of separate branches per trigger'
+)
+options.register(
+    'numThreads', 1, VarParsing.multiplicity.singleton, VarParsing.varType.int,
+    'Number of threads and streams to use'
+)
+options.register(
+    'parallelCompression', False, VarParsing.multiplicity.singleton, VarParsing.varType.bool,
+    'Compress baskets of output trees in parallel with ROOT implicit multithreading'
+)
+options.register(
+    'reportTiming', False, VarParsing.multiplicity.singleton, VarParsing.varType.bool,
+    'Print time spent filling output trees and waiting for them at the end of the job'
+)
 
 # Override defaults for automatically defined options
 options.setDefault('maxEvents', 100)
@@ -108,6 +140,12 @@ options.setDefault('outputFile', 'sample.root')
 options.parseArguments()
 
 
+# Run the job in several threads if requested.  Setting the number of
+# streams to zero makes it equal to the number of threads.
+process.options.numberOfThreads = cms.untracked.uint32(options.numThreads)
+process.options.numberOfStreams = cms.untracked.uint32(0)
+
+
 # Check provided data-taking period.  At the moment only '2017' is
 # supported.
 if options.period not in ['2016', '2017']:
@@ -260,6 +298,14 @@ from Analysis.PECTuples.Utils_cff import PathManager
 paths = PathManager(process.elPath, process.muPath)
 
 
+# Apply the luminosity mask
+if runOnData and options.lumiMask:
+    process.lumiMaskFilter = cms.EDFilter('LumiMaskFilter',
+        lumiMask = cms.string(options.lumiMask)
+    )
+    paths.append(process.lumiMaskFilter)
+
+
 # Apply filtering on process IDs
 if not runOnData and options.processIDs:
     process.processIDFilter = cms.EDFilter('ProcessIDFilter',
@@ -388,6 +434,7 @@ if runOnData:
         triggers = cms.vstring(triggerNames),
         filter = cms.bool(not options.disableTriggerFilter),
         savePrescales = cms.bool(True),
+        packBits = cms.bool(options.packTriggerBits),
         triggerBits = cms.InputTag('TriggerResults', processName=options.triggerProcessName),
         hltPrescales = cms.InputTag('patTrigger'),
         l1tPrescales = cms.InputTag('patTrigger', 'l1min')
@@ -397,6 +444,7 @@ else:
         triggers = cms.vstring(triggerNames),
         filter = cms.bool(not options.disableTriggerFilter),
         savePrescales = cms.bool(False),
+        packBits = cms.bool(options.packTriggerBits),
         triggerBits = cms.InputTag('TriggerResults', processName=options.triggerProcessName)
     )
 
@@ -426,7 +474,9 @@ if not runOnData and options.period in ['2016', '2017']:
 
 
 # Save event ID and basic event content
-process.pecEventID = cms.EDAnalyzer('PECEventID')
+process.pecEventID = cms.EDAnalyzer('PECEventID',
+    generator = cms.InputTag('' if runOnData else 'generator')
+)
 
 effAreasTemplate = 'RecoEgamma/ElectronIdentification/data/{}/effAreaElectrons_cone03_pfNeuHadronsAndPhotons_{}.txt'
 
@@ -446,13 +496,15 @@ process.pecElectrons = cms.EDAnalyzer('PECElectrons',
     boolIDMaps = cms.VInputTag(ele_cut_based_id_maps),
     embeddedContIDs = cms.vstring(ele_embedded_mva_id_labels),
     contIDMaps = cms.VInputTag(ele_mva_id_maps),
-    selection = ele_quality_cuts
+    selection = ele_quality_cuts,
+    flatBranches = cms.bool(options.flatBranches)
 )
 
 process.pecMuons = cms.EDAnalyzer('PECMuons',
     src = cms.InputTag('analysisPatMuons'),
     selection = muQualityCuts,
-    primaryVertices = cms.InputTag('offlineSlimmedPrimaryVertices')
+    primaryVertices = cms.InputTag('offlineSlimmedPrimaryVertices'),
+    flatBranches = cms.bool(options.flatBranches)
 )
 
 process.pecJetMET = cms.EDAnalyzer('PECJetMET',
@@ -460,8 +512,9 @@ process.pecJetMET = cms.EDAnalyzer('PECJetMET',
     jets = cms.InputTag('analysisPatJets'),
     jetSelection = jetQualityCuts,
     jetIDVersion = cms.string(options.period),
-    met = metTag
-    # metCorrToUndo = cms.VInputTag(cms.InputTag('patPFMetT1T2Corr', 'type1'))
+    met = metTag,
+    # metCorrToUndo = cms.VInputTag(cms.InputTag('patPFMetT1T2Corr', 'type1')),
+    flatBranches = cms.bool(options.flatBranches)
 )
 
 process.pecPileUp = cms.EDAnalyzer('PECPileUp',
@@ -482,7 +535,8 @@ if not runOnData:
         generator = cms.InputTag('generator'),
         saveAltLHEWeights = alt_lhe_weight_indices,
         lheEventProduct = cms.InputTag(options.labelLHEEventProduct),
-        saveAltPSWeights = alt_ps_weight_indices
+        saveAltPSWeights = alt_ps_weight_indices,
+        weightStorage = cms.string(options.weightStorage)
     )
     paths.append(process.pecGenerator)
 
@@ -534,3 +588,33 @@ else:
 
 process.TFileService = cms.Service('TFileService',
     fileName = cms.string(outputBaseName + postfix + '.root'))
+
+# Service to keep output trees of all PEC plugins aligned when several
+# streams are used.  If requested, time spent filling the trees is
+# reported at the end of the job.
+process.TreeFillService = cms.Service('TreeFillService',
+    implicitMT = cms.bool(options.parallelCompression),
+    reportTiming = cms.bool(options.reportTiming)
+)
+
+if options.parallelCompression:
+    process.InitRootHandlers = cms.Service('InitRootHandlers',
+        EnableIMT = cms.untracked.bool(True)
+    )
+
+
+# If requested, collect outputs of all PEC plugins in a single tree.  It
+# is filled by an output module, which only selects events that have
+# passed one of the paths for requested channels.
+if options.singleTree:
+    selectedPaths = []
+    
+    if elChan:
+        selectedPaths.append('elPath')
+    if muChan:
+        selectedPaths.append('muPath')
+    
+    process.pecOutput = cms.OutputModule('PECOutput',
+        SelectEvents = cms.untracked.PSet(SelectEvents = cms.vstring(selectedPaths))
+    )
+    process.outPath = cms.EndPath(process.pecOutput)
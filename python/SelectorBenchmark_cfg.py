@@ -0,0 +1,72 @@
+"""Configuration for cmsRun to benchmark string-based selections.
+
+Evaluates selections used in the PEC configuration with both
+StringCutObjectSelector and CompiledSelector on objects from MiniAOD
+files, and prints the time per object and the number of disagreements
+between the two at the end of the job.  Selections are copied from
+ObjectsDefinitions_cff.py, Utils_cff.py, and MiniAOD_cfg.py.
+
+The job is run in a single thread to make the timing reproducible.
+"""
+
+
+# Create a process
+import FWCore.ParameterSet.Config as cms
+process = cms.Process('SelectorBenchmark')
+
+
+# Enable MessageLogger and reduce its verbosity
+process.load('FWCore.MessageLogger.MessageLogger_cfi')
+process.MessageLogger.cerr.FwkReport.reportEvery = 100
+
+
+# Parse command-line options
+from FWCore.ParameterSet.VarParsing import VarParsing
+options = VarParsing('python')
+
+options.register(
+    'numRepetitions', 100, VarParsing.multiplicity.singleton, VarParsing.varType.int,
+    'Number of times each selection is evaluated for each object'
+)
+
+options.parseArguments()
+
+
+# Specify the input file
+if len(options.inputFiles) == 0:
+    raise RuntimeError('No input file is provided')
+
+process.source = cms.Source('PoolSource',
+    fileNames = cms.untracked.vstring(options.inputFiles)
+)
+
+process.maxEvents = cms.untracked.PSet(input = cms.untracked.int32(options.maxEvents))
+
+
+# The benchmark
+process.selectorBenchmark = cms.EDAnalyzer('SelectorBenchmark',
+    electrons = cms.InputTag('slimmedElectrons'),
+    muons = cms.InputTag('slimmedMuons'),
+    jets = cms.InputTag('slimmedJets'),
+    vertices = cms.InputTag('offlineSlimmedPrimaryVertices'),
+    electronCuts = cms.vstring(
+        'pt > 15. & (abs(eta) < 2.5 | abs(superCluster.eta) < 2.5)',
+        'pt > 23. & (abs(eta) < 2.5 | abs(superCluster.eta) < 2.5)',
+        '(abs(superCluster.eta) < 1.4442 | abs(superCluster.eta) > 1.5660)'
+    ),
+    muonCuts = cms.vstring(
+        'pt > 10. & abs(eta) < 2.5',
+        'pt > 20. & abs(eta) < 2.5'
+    ),
+    jetCuts = cms.vstring(
+        'pt > 8.',
+        'bDiscriminator("pfCombinedInclusiveSecondaryVertexV2BJetTags") > 0.8484'
+    ),
+    vertexCuts = cms.vstring(
+        '!isFake & ndof > 4. & abs(z) < 24. & position.rho < 2.',
+        '!isFake & ndof >= 4. & abs(z) < 24. & position.Rho < 2.'
+    ),
+    numRepetitions = cms.uint32(options.numRepetitions)
+)
+
+process.p = cms.Path(process.selectorBenchmark)
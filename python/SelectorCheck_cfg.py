@@ -0,0 +1,72 @@
+"""Configuration for cmsRun to check CompiledSelector.
+
+Evaluates selection strings that exercise the precedence of operators
+with both StringCutObjectSelector and CompiledSelector on objects from
+MiniAOD files.  The job fails at the end if the two selectors disagree
+for any object.  Strings that CompiledSelector could not compile are
+marked in the summary table with "(fallback)" and are not tested
+effectively.  Timing printed in the table is not meaningful since each
+selection is evaluated only once per object.
+"""
+
+
+# Create a process
+import FWCore.ParameterSet.Config as cms
+process = cms.Process('SelectorCheck')
+
+
+# Enable MessageLogger and reduce its verbosity
+process.load('FWCore.MessageLogger.MessageLogger_cfi')
+process.MessageLogger.cerr.FwkReport.reportEvery = 100
+
+
+# Parse command-line options
+from FWCore.ParameterSet.VarParsing import VarParsing
+options = VarParsing('python')
+options.setDefault('maxEvents', 1000)
+options.parseArguments()
+
+
+# Specify the input file
+if len(options.inputFiles) == 0:
+    raise RuntimeError('No input file is provided')
+
+process.source = cms.Source('PoolSource',
+    fileNames = cms.untracked.vstring(options.inputFiles)
+)
+
+process.maxEvents = cms.untracked.PSet(input = cms.untracked.int32(options.maxEvents))
+
+
+# The check.  Operator ! applies to a whole comparison, and thus
+# "!abs(eta) < 2.5" means "!(abs(eta) < 2.5)".
+process.selectorCheck = cms.EDAnalyzer('SelectorBenchmark',
+    electrons = cms.InputTag('slimmedElectrons'),
+    muons = cms.InputTag('slimmedMuons'),
+    jets = cms.InputTag('slimmedJets'),
+    vertices = cms.InputTag('offlineSlimmedPrimaryVertices'),
+    electronCuts = cms.vstring(
+        '!abs(eta) < 1.5',
+        '!abs(superCluster.eta) > 1.4442 & pt > 10.',
+        'pt > 15. & !(abs(eta) < 2.5 | abs(superCluster.eta) < 2.5)'
+    ),
+    muonCuts = cms.vstring(
+        '!abs(eta) < 2.5',
+        '!(pt > 20. && abs(eta) < 2.4)',
+        'pt > 10. && !abs(eta) > 2.4',
+        '!!(pt > 20.) || !pt < 5.',
+        '-eta < 0. & !pt - 10. > 5.'
+    ),
+    jetCuts = cms.vstring(
+        '!pt > 30.',
+        '!abs(eta) > 2.4 & !(pt < 20. | abs(eta) < 1.)'
+    ),
+    vertexCuts = cms.vstring(
+        '!isFake & !ndof < 4. & !abs(z) > 24.',
+        '!(isFake | ndof < 4.) & !position.rho >= 2.'
+    ),
+    numRepetitions = cms.uint32(1),
+    failOnMismatch = cms.bool(True)
+)
+
+process.p = cms.Path(process.selectorCheck)
@@ -0,0 +1,198 @@
+#!/usr/bin/env python
+
+"""Converts a list of event IDs into the binary format for EventIDFilter.
+
+The input list can be given in any format accepted by EventIDFilter:
+a text file with lines "run:lumi:event" or a ROOT file with a tree
+"EventID" with branches "run", "lumi", and "event".  The output file is
+written in the binary format described in plugins/BinaryEventList.h and
+must have extension ".evl" for EventIDFilter to recognize it.  In this
+format events are sorted and delta-encoded, and the file is mapped into
+memory read-only, so jobs running on the same machine share a single
+copy of the list.
+"""
+
+from __future__ import print_function
+import argparse
+from collections import defaultdict
+import os
+import struct
+import sys
+
+
+# Version of the format and the number of events between two restart
+# points.  They must be consistent with plugins/BinaryEventList.h.
+magic, version = b'PECEVL01', 1
+restartInterval = 16
+headerFormat, runEntryFormat, restartFormat = '<8sIIQQ', '<IIQQQ', '<IIQ'
+
+
+def read_text_file(fileName, events):
+    """Read event IDs from a text file and add them to the dictionary.
+    
+    Reading stops at the first empty line, as in EventIDFilter.
+    """
+    
+    with open(fileName) as inputFile:
+        for lineNumber, line in enumerate(inputFile, start=1):
+            line = line.rstrip('\r\n')
+            
+            if not line:
+                break
+            
+            try:
+                run, lumi, event = (int(x) for x in line.split(':'))
+            except ValueError:
+                raise RuntimeError('Failed to parse line {} "{}" of file "{}".'.format(
+                    lineNumber, line, fileName
+                ))
+            
+            events[run].append((lumi, event))
+
+
+def read_root_file(fileName, events):
+    """Read event IDs from tree EventID in a ROOT file."""
+    
+    import ROOT
+    ROOT.PyConfig.IgnoreCommandLineOptions = True
+    
+    inputFile = ROOT.TFile(fileName)
+    
+    if inputFile.IsZombie():
+        raise RuntimeError('Cannot open file "{}".'.format(fileName))
+    
+    tree = inputFile.Get('EventID')
+    
+    if not tree:
+        raise RuntimeError('File "{}" does not contain tree "EventID".'.format(fileName))
+    
+    for entry in tree:
+        events[entry.run].append((entry.lumi, entry.event))
+    
+    inputFile.Close()
+
+
+def encode_varint(value, buf):
+    """Append a variable-length encoding of a non-negative integer."""
+    
+    while value >= 0x80:
+        buf.append((value & 0x7F) | 0x80)
+        value >>= 7
+    
+    buf.append(value)
+
+
+def write_binary_file(fileName, events):
+    """Write the binary file and return the number of distinct events."""
+    
+    runs = sorted(events.keys())
+    
+    for run in runs:
+        if run <= 0 or run > 0xFFFFFFFF:
+            raise RuntimeError('Run number {} is not allowed.'.format(run))
+    
+    
+    # Encode events of each run
+    restarts, data, counts = [], [], []
+    
+    for run in runs:
+        ids = sorted(set(events[run]))
+        runRestarts, buf = [], bytearray()
+        prevLumi, prevEvent = None, None
+        
+        for i, (lumi, event) in enumerate(ids):
+            if i % restartInterval == 0:
+                if lumi > 0xFFFFFFFF or len(buf) > 0xFFFFFFFF:
+                    raise RuntimeError('Event {}:{}:{} cannot be encoded.'.format(
+                        run, lumi, event
+                    ))
+                
+                runRestarts.append((lumi, len(buf), event))
+            elif lumi == prevLumi:
+                encode_varint(0, buf)
+                encode_varint(event - prevEvent, buf)
+            else:
+                encode_varint(lumi - prevLumi, buf)
+                encode_varint(event, buf)
+            
+            prevLumi, prevEvent = lumi, event
+        
+        restarts.append(runRestarts)
+        data.append(buf)
+        counts.append(len(ids))
+    
+    
+    # Compute offsets.  Restart points of all runs follow the table of
+    # runs, and encoded events follow them.
+    headerSize = struct.calcsize(headerFormat)
+    runEntrySize, restartSize = struct.calcsize(runEntryFormat), struct.calcsize(restartFormat)
+    
+    offset = headerSize + runEntrySize * len(runs)
+    restartsOffsets = []
+    
+    for runRestarts in restarts:
+        restartsOffsets.append(offset)
+        offset += restartSize * len(runRestarts)
+    
+    dataOffsets = []
+    
+    for buf in data:
+        dataOffsets.append(offset)
+        offset += len(buf)
+    
+    
+    numEvents = sum(counts)
+    
+    with open(fileName, 'wb') as outputFile:
+        outputFile.write(struct.pack(
+            headerFormat, magic, version, restartInterval, len(runs), numEvents
+        ))
+        
+        for entry in zip(runs, counts, restartsOffsets, dataOffsets):
+            run, numRunEvents, restartsOffset, dataOffset = entry
+            outputFile.write(struct.pack(
+                runEntryFormat, run, 0, numRunEvents, restartsOffset, dataOffset
+            ))
+        
+        for runRestarts in restarts:
+            for point in runRestarts:
+                outputFile.write(struct.pack(restartFormat, *point))
+        
+        for buf in data:
+            outputFile.write(buf)
+    
+    return numEvents
+
+
+
+if __name__ == '__main__':
+    
+    argParser = argparse.ArgumentParser(
+        epilog=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter
+    )
+    argParser.add_argument(
+        'inputs', nargs='+', metavar='events.txt',
+        help='Input lists of event IDs in text or ROOT format.  They are merged.'
+    )
+    argParser.add_argument(
+        '-o', '--output', required=True, metavar='events.evl', help='Output binary file.'
+    )
+    args = argParser.parse_args()
+    
+    if not args.output.endswith('.evl'):
+        print('Warning: EventIDFilter only recognizes files with extension ".evl".',
+              file=sys.stderr)
+    
+    
+    events = defaultdict(list)
+    
+    for fileName in args.inputs:
+        if fileName.endswith('.root'):
+            read_root_file(fileName, events)
+        else:
+            read_text_file(fileName, events)
+    
+    numEvents = write_binary_file(args.output, events)
+    print('{} events in {} runs written to {} ({} bytes)'.format(
+        numEvents, len(events), args.output, os.path.getsize(args.output)
+    ))
@@ -0,0 +1,467 @@
+#!/usr/bin/env python
+
+"""Builds and queries indices of events in PEC files.
+
+Plugin PECEventID writes a tree EventIndex, which maps run, luminosity
+block, and event number to the number of the entry in the tree with
+event ID, with records sorted by event ID.  This allows to find a given
+event without scanning the whole file.  It also writes a tree
+LumiBlocks with ranges of entries that belong to each luminosity block.
+Entry numbers are only valid in the file written by the job, and after
+files have been merged with hadd both trees must be rebuilt with
+command "build" of this script.
+
+Command "find" looks up events, given as run:lumi:event, in a list of
+files.  In each file a binary search is performed directly on the index
+tree, so only O(log N) entries of it are read.  For each event found
+the file name and the entry number are printed.  The event ID stored in
+the entry found is checked against the requested one, and a mismatch,
+which means that the index is stale, is reported as an error.
+
+Command "mask" applies a luminosity mask in the standard JSON format
+(run -> list of [first, last] ranges of luminosity blocks) using only
+the LumiBlocks trees.  It prints the selected ranges of entries in each
+file, [first, last), together with the number of selected events, and
+can save them as TEntryList objects, which can be attached to a TChain
+with SetEntryList.  The sum of nominal weights printed only includes
+events written to the files, i.e. ones that passed the event selection,
+and cannot be used to normalize simulation.
+"""
+
+from __future__ import print_function
+import argparse
+from array import array
+from collections import defaultdict
+import json
+import sys
+
+import ROOT
+ROOT.PyConfig.IgnoreCommandLineOptions = True
+
+
+# Locations of the tree with event ID and the index
+sharedTreeName, sharedBranchName = 'pecOutput/Events', 'EventID_eventId'
+eventIDTreeName, eventIDBranchName = 'pecEventID/EventID', 'eventId'
+generatorTreeName, generatorBranchName = 'pecGenerator/Generator', 'generator'
+sharedGeneratorBranchName = 'Generator_generator'
+indexDirName, indexTreeName, lumiTreeName = 'pecEventID', 'EventIndex', 'LumiBlocks'
+
+
+def find_event_id_tree(inputFile):
+    """Return the tree and the branch that contain event ID.
+    
+    Both the layout with a single tree written by PECOutput and the
+    layout with separate trees are supported.
+    """
+    
+    tree = inputFile.Get(sharedTreeName)
+    
+    if tree:
+        return tree, sharedBranchName
+    
+    tree = inputFile.Get(eventIDTreeName)
+    
+    if tree:
+        return tree, eventIDBranchName
+    
+    raise RuntimeError('File "{}" does not contain event ID.'.format(inputFile.GetName()))
+
+
+def find_generator_tree(inputFile):
+    """Return the tree and the branch with generator information.
+    
+    Return (None, None) if the file does not contain it, e.g. for data.
+    """
+    
+    tree = inputFile.Get(sharedTreeName)
+    
+    if tree and tree.GetBranch(sharedGeneratorBranchName):
+        return tree, sharedGeneratorBranchName
+    
+    tree = inputFile.Get(generatorTreeName)
+    
+    if tree:
+        return tree, generatorBranchName
+    
+    return None, None
+
+
+def build_index(fileName):
+    """Rebuild the index and the summary of lumi blocks in the given file.
+    
+    Existing trees are replaced.  Returns the number of indexed events.
+    """
+    
+    inputFile = ROOT.TFile(fileName, 'update')
+    
+    if inputFile.IsZombie():
+        raise RuntimeError('Cannot open file "{}".'.format(fileName))
+    
+    tree, branchName = find_event_id_tree(inputFile)
+    genTree, genBranchName = find_generator_tree(inputFile)
+    
+    # In the single-tree layout the generator information is stored in the
+    # same tree as event ID, and both branches must stay enabled.  Compare
+    # the layouts rather than Python proxies, which need not be identical
+    # for the same TTree.
+    separateGenTree = genTree and genBranchName != sharedGeneratorBranchName
+    
+    if genTree and not separateGenTree:
+        genTree = tree
+    
+    tree.SetBranchStatus('*', False)
+    tree.SetBranchStatus(branchName + '*', True)
+    
+    if separateGenTree:
+        genTree.SetBranchStatus('*', False)
+    
+    if genTree:
+        genTree.SetBranchStatus(genBranchName + '*', True)
+    
+    records, blocks = [], []
+    
+    for entry in range(tree.GetEntries()):
+        tree.GetEntry(entry)
+        eventID = getattr(tree, branchName)
+        run, lumi = eventID.RunNumber(), eventID.LumiSectionNumber()
+        records.append((run, lumi, eventID.EventNumber(), entry))
+        
+        weight = 0.
+        
+        if genTree:
+            if separateGenTree:
+                genTree.GetEntry(entry)
+            
+            weight = getattr(genTree, genBranchName).NominalWeight()
+        
+        # Blocks are [run, lumi, firstEntry, numEntries, sumSelectedWeights]
+        if blocks and blocks[-1][0] == run and blocks[-1][1] == lumi:
+            blocks[-1][3] += 1
+            blocks[-1][4] += weight
+        else:
+            blocks.append([run, lumi, entry, 1, weight])
+    
+    records.sort()
+    
+    
+    # Replace all cycles of the old trees, including ones merged by hadd
+    directory = inputFile.GetDirectory(indexDirName)
+    
+    if not directory:
+        directory = inputFile.mkdir(indexDirName)
+    
+    directory.cd()
+    directory.Delete(indexTreeName + ';*')
+    directory.Delete(lumiTreeName + ';*')
+    
+    run, lumi = array('I', [0]), array('I', [0])
+    event, entry = array('L', [0]), array('l', [0])
+    
+    indexTree = ROOT.TTree(
+        indexTreeName, 'Entries of events in the EventID tree, sorted by event ID'
+    )
+    indexTree.Branch('run', run, 'run/i')
+    indexTree.Branch('lumi', lumi, 'lumi/i')
+    indexTree.Branch('event', event, 'event/l')
+    indexTree.Branch('entry', entry, 'entry/L')
+    
+    for record in records:
+        run[0], lumi[0], event[0], entry[0] = record
+        indexTree.Fill()
+    
+    indexTree.Write()
+    
+    
+    firstEntry, numEntries = array('l', [0]), array('l', [0])
+    sumSelectedWeights = array('d', [0.])
+    
+    lumiTree = ROOT.TTree(
+        lumiTreeName, 'Ranges of entries in the EventID tree for luminosity blocks'
+    )
+    lumiTree.Branch('run', run, 'run/i')
+    lumiTree.Branch('lumi', lumi, 'lumi/i')
+    lumiTree.Branch('firstEntry', firstEntry, 'firstEntry/L')
+    lumiTree.Branch('numEntries', numEntries, 'numEntries/L')
+    lumiTree.Branch('sumSelectedWeights', sumSelectedWeights, 'sumSelectedWeights/D')
+    
+    for block in blocks:
+        run[0], lumi[0], firstEntry[0], numEntries[0], sumSelectedWeights[0] = block
+        lumiTree.Fill()
+    
+    lumiTree.Write()
+    inputFile.Close()
+    
+    return len(records)
+
+
+class IndexTree:
+    """Index in a single file that is searched without reading it fully."""
+    
+    def __init__(self, fileName):
+        self.file = ROOT.TFile(fileName)
+        
+        if self.file.IsZombie():
+            raise RuntimeError('Cannot open file "{}".'.format(fileName))
+        
+        self.tree = self.file.Get(indexDirName + '/' + indexTreeName)
+        
+        if not self.tree:
+            raise RuntimeError(
+                'File "{}" does not contain the event index. Rebuild it with command '
+                '"build".'.format(fileName)
+            )
+        
+        self.fileName = fileName
+        self.eventIDTree, self.eventIDBranchName = find_event_id_tree(self.file)
+        
+        # Equal numbers of entries do not guarantee that the index is up to
+        # date since they still match after hadd.  Entries found are
+        # verified in method find.
+        if self.tree.GetEntries() != self.eventIDTree.GetEntries():
+            raise RuntimeError(
+                'Event index in file "{}" is not consistent with the tree with event ID. The file '
+                'has probably been merged, and the index must be rebuilt with command '
+                '"build".'.format(fileName)
+            )
+        
+        self.eventIDTree.SetBranchStatus('*', False)
+        self.eventIDTree.SetBranchStatus(self.eventIDBranchName + '*', True)
+        
+        self.run, self.lumi = array('I', [0]), array('I', [0])
+        self.event, self.entry = array('L', [0]), array('l', [0])
+        self.tree.SetBranchAddress('run', self.run)
+        self.tree.SetBranchAddress('lumi', self.lumi)
+        self.tree.SetBranchAddress('event', self.event)
+        self.tree.SetBranchAddress('entry', self.entry)
+    
+    
+    def find(self, eventID):
+        """Return the entry for the given (run, lumi, event) or None.
+        
+        Raise an exception if the entry found does not contain the
+        requested event, i.e. the index is stale.
+        """
+        
+        low, high = 0, self.tree.GetEntries()
+        
+        while low < high:
+            mid = (low + high) // 2
+            self.tree.GetEntry(mid)
+            
+            if (self.run[0], self.lumi[0], self.event[0]) < eventID:
+                low = mid + 1
+            else:
+                high = mid
+        
+        if low == self.tree.GetEntries():
+            return None
+        
+        self.tree.GetEntry(low)
+        
+        if (self.run[0], self.lumi[0], self.event[0]) != eventID:
+            return None
+        
+        entry = self.entry[0]
+        
+        if entry < 0 or entry >= self.eventIDTree.GetEntries():
+            storedID = None
+        else:
+            self.eventIDTree.GetEntry(entry)
+            storedID = getattr(self.eventIDTree, self.eventIDBranchName)
+            storedID = (
+                storedID.RunNumber(), storedID.LumiSectionNumber(), storedID.EventNumber()
+            )
+        
+        if storedID != eventID:
+            raise RuntimeError(
+                'Entry {} found in the event index of file "{}" does not contain event '
+                '{}:{}:{}. The index is stale and must be rebuilt with command '
+                '"build".'.format(entry, self.fileName, *eventID)
+            )
+        
+        return entry
+
+
+class LumiMask:
+    """Luminosity mask read from a JSON file in the standard format."""
+    
+    def __init__(self, fileName):
+        with open(fileName) as f:
+            content = json.load(f)
+        
+        self.ranges = defaultdict(list)
+        
+        for run, lumiRanges in content.items():
+            self.ranges[int(run)] = sorted(tuple(r) for r in lumiRanges)
+    
+    
+    def contains(self, run, lumi):
+        """Check if the given luminosity block is included."""
+        
+        for first, last in self.ranges.get(run, []):
+            if first <= lumi <= last:
+                return True
+        
+        return False
+
+
+def select_entries(fileName, lumiMask):
+    """Return ranges of entries selected by the mask and their sum of weights.
+    
+    Ranges are given as half-open intervals [first, last).  Adjacent
+    ranges are merged.  The name of the tree with event ID, to which the
+    entries refer, is returned as well.  The sum of weights only includes
+    events that passed the event selection.
+    """
+    
+    inputFile = ROOT.TFile(fileName)
+    
+    if inputFile.IsZombie():
+        raise RuntimeError('Cannot open file "{}".'.format(fileName))
+    
+    lumiTree = inputFile.Get(indexDirName + '/' + lumiTreeName)
+    
+    if not lumiTree:
+        raise RuntimeError(
+            'File "{}" does not contain the summary of luminosity blocks. Rebuild it with command '
+            '"build".'.format(fileName)
+        )
+    
+    if find_event_id_tree(inputFile)[1] == sharedBranchName:
+        treeName = sharedTreeName
+    else:
+        treeName = eventIDTreeName
+    
+    ranges, sumSelectedWeights = [], 0.
+    
+    for block in lumiTree:
+        if not lumiMask.contains(block.run, block.lumi):
+            continue
+        
+        sumSelectedWeights += block.sumSelectedWeights
+        
+        if ranges and ranges[-1][1] == block.firstEntry:
+            ranges[-1][1] += block.numEntries
+        else:
+            ranges.append([block.firstEntry, block.firstEntry + block.numEntries])
+    
+    inputFile.Close()
+    
+    return ranges, sumSelectedWeights, treeName
+
+
+def parse_event_id(text):
+    """Parse event ID given as run:lumi:event."""
+    
+    try:
+        run, lumi, event = (int(x) for x in text.split(':'))
+    except ValueError:
+        raise argparse.ArgumentTypeError(
+            'Event ID "{}" is not in format run:lumi:event.'.format(text)
+        )
+    
+    return (run, lumi, event)
+
+
+
+if __name__ == '__main__':
+    
+    argParser = argparse.ArgumentParser(
+        epilog=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter
+    )
+    subParsers = argParser.add_subparsers(dest='command')
+    
+    buildParser = subParsers.add_parser('build', help='Rebuild the index in given files')
+    buildParser.add_argument('files', nargs='+', metavar='pec.root', help='PEC files.')
+    
+    findParser = subParsers.add_parser('find', help='Find given events in given files')
+    findParser.add_argument(
+        '-e', '--event', action='append', type=parse_event_id, required=True, dest='events',
+        help='Event ID in format run:lumi:event. Can be given several times.'
+    )
+    findParser.add_argument('files', nargs='+', metavar='pec.root', help='PEC files.')
+    
+    maskParser = subParsers.add_parser(
+        'mask', help='Find ranges of entries selected by a luminosity mask'
+    )
+    maskParser.add_argument(
+        '-j', '--json', required=True, dest='json', help='Luminosity mask in JSON format.'
+    )
+    maskParser.add_argument(
+        '-o', '--output', metavar='entryLists.root', default=None,
+        help='ROOT file to save the selection as TEntryList objects, one per input file.'
+    )
+    maskParser.add_argument('files', nargs='+', metavar='pec.root', help='PEC files.')
+    
+    args = argParser.parse_args()
+    
+    ROOT.gROOT.SetBatch(True)
+    
+    
+    if args.command == 'build':
+        ROOT.gSystem.Load('libAnalysisPECTuples.so')
+        
+        for fileName in args.files:
+            numEvents = build_index(fileName)
+            print('{}: {} events indexed'.format(fileName, numEvents))
+    
+    elif args.command == 'find':
+        # Needed to read event ID when entries found are verified
+        ROOT.gSystem.Load('libAnalysisPECTuples.so')
+        notFound = set(args.events)
+        
+        for fileName in args.files:
+            index = IndexTree(fileName)
+            
+            for eventID in args.events:
+                entry = index.find(eventID)
+                
+                if entry is not None:
+                    print('{}:{}:{}'.format(*eventID), fileName, entry)
+                    notFound.discard(eventID)
+        
+        for eventID in args.events:
+            if eventID in notFound:
+                print('{}:{}:{}'.format(*eventID), 'not found', file=sys.stderr)
+        
+        if notFound:
+            sys.exit(1)
+    
+    elif args.command == 'mask':
+        lumiMask = LumiMask(args.json)
+        entryLists = []
+        
+        for fileName in args.files:
+            ranges, sumSelectedWeights, treeName = select_entries(fileName, lumiMask)
+            numSelected = sum(last - first for first, last in ranges)
+            
+            print('{}: {} events selected in {} ranges, sum of their weights {:g}'.format(
+                fileName, numSelected, len(ranges), sumSelectedWeights
+            ))
+            
+            for first, last in ranges:
+                print(' [{}, {})'.format(first, last))
+            
+            if args.output:
+                # The entry list refers to the tree with event ID.  Trees
+                # written by other plugins are aligned with it.
+                entryList = ROOT.TEntryList('', '', treeName, fileName)
+                
+                for first, last in ranges:
+                    for entry in range(first, last):
+                        entryList.Enter(entry)
+                
+                entryLists.append(entryList)
+        
+        if args.output:
+            outputFile = ROOT.TFile(args.output, 'recreate')
+            
+            for i, entryList in enumerate(entryLists):
+                entryList.SetName('entryList{}'.format(i))
+                entryList.Write()
+            
+            outputFile.Close()
+    
+    else:
+        argParser.print_usage()
+        sys.exit(1)
@@ -16,6 +16,10 @@ a single act.
 The result of merging is validated by counting events in a given tree in
 the output files and comparing it to the total number of events in input
 files.
+
+Indices of events written by PECEventID refer to entries in the original
+files and become invalid after merging.  They are rebuilt in the merged
+files with script eventIndex.py unless this is disabled.
 """
 
 import argparse
@@ -144,19 +148,31 @@ class Partitioner(object):
         return self.parts
 
 
-def count_events(inputFiles, treeName):
-    """Count events in the given tree in all input files."""
+def count_events(inputFiles, treeName=None):
+    """Count events in the given tree in all input files.
+    
+    If the name of the tree is not given, the tree written by PECOutput
+    in the single-tree layout is used, and if it is not found, the tree
+    written by PECEventID in the layout with separate trees.
+    """
     
     counter = 0
+    treeNames = [treeName] if treeName else ['pecOutput/Events', 'pecEventID/EventID']
     
     for inputFile in inputFiles:
         f = ROOT.TFile(inputFile)
-        tree = f.Get(treeName)
+        tree = None
+        
+        for name in treeNames:
+            tree = f.Get(name)
+            
+            if tree:
+                break
         
         if not tree:
-            raise RuntimeError(
-                'File "{}" does not contain requested tree "{}".'.format(inputFile, treeName)
-            )
+            raise RuntimeError('File "{}" does not contain any of requested trees {}.'.format(
+                inputFile, ', '.join('"{}"'.format(name) for name in treeNames)
+            ))
         
         counter += tree.GetEntries()
         f.Close()
@@ -228,8 +244,14 @@ if __name__ == '__main__':
         type=int, default=256, dest='max_files_to_merge'
     )
     argParser.add_argument(
-        '-t', '--tree-name', help='Name of a tree to count events',
-        default='pecEventID/EventID', dest='tree_name'
+        '-t', '--tree-name',
+        help='Name of a tree to count events.  By default, pecOutput/Events or, if '
+        'it is absent, pecEventID/EventID is used',
+        default=None, dest='tree_name'
+    )
+    argParser.add_argument(
+        '--no-index', help='Do not rebuild indices of events in merged files',
+        action='store_true', dest='no_index'
     )
     argParser.add_argument(
         '-k', '--keep-tmp-files', help='Do not delete temporary files',
@@ -367,3 +389,11 @@ if __name__ == '__main__':
         )
     else:
         print 'Total number of events in these files:', nEventMerged
+    
+    
+    # Rebuild indices of events, which refer to entries in the input files
+    if not args.no_index:
+        indexScript = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'eventIndex.py')
+        
+        if call([sys.executable, indexScript, 'build'] + outputFiles) != 0:
+            critical_error('Failed to rebuild indices of events in merged files.')
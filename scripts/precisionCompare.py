@@ -0,0 +1,136 @@
+#!/usr/bin/env python
+
+"""Reports precision loss between two validation JSON files.
+
+The files are produced by validationConvert.py from PEC tuples created
+from the same input, e.g. with and without reduced precision of stored
+floating-point members.  validationConvert.py exports every data member
+that is stored with reduced precision.  For each floating-point property
+the script reports the maximal absolute and relative differences found.  Objects in
+lists are matched by their indices, and events and lists of different
+lengths are skipped.
+"""
+
+from __future__ import print_function
+import argparse
+from collections import OrderedDict
+import json
+
+
+class Deviation:
+    """Aggregates differences for a single property."""
+    
+    def __init__(self):
+        self.maxAbs = 0.
+        self.maxRel = 0.
+        self.worstValues = None
+        self.count = 0
+    
+    def update(self, refValue, testValue):
+        diff = abs(testValue - refValue)
+        scale = max(abs(refValue), abs(testValue))
+        rel = diff / scale if scale > 0. else 0.
+        
+        if diff > self.maxAbs:
+            self.maxAbs = diff
+        
+        if rel > self.maxRel:
+            self.maxRel = rel
+            self.worstValues = (refValue, testValue)
+        
+        self.count += 1
+
+
+def compare_objects(refObject, testObject, deviations, prefix):
+    """Update deviations for all floating-point properties of objects."""
+    
+    for key, refValue in refObject.items():
+        if key not in testObject:
+            continue
+        
+        testValue = testObject[key]
+        
+        if isinstance(refValue, float) and isinstance(testValue, float):
+            name = '{}.{}'.format(prefix, key)
+            
+            if name not in deviations:
+                deviations[name] = Deviation()
+            
+            deviations[name].update(refValue, testValue)
+
+
+if __name__ == '__main__':
+    
+    argParser = argparse.ArgumentParser(
+        epilog=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter
+    )
+    argParser.add_argument(
+        'refFile', metavar='reference.json',
+        help='Reference file, normally with full precision.'
+    )
+    argParser.add_argument(
+        'testFile', metavar='test.json',
+        help='File to be compared with the reference.'
+    )
+    args = argParser.parse_args()
+    
+    
+    # Read input files converting data from lists into maps with
+    # event IDs as keys
+    eventsRef = OrderedDict()
+    eventsTest = {}
+    
+    for fileName, events in [(args.refFile, eventsRef), (args.testFile, eventsTest)]:
+        with open(fileName) as f:
+            data = json.load(f, object_pairs_hook=OrderedDict)
+        
+        for entry in data:
+            events[entry['eventID']] = entry
+    
+    
+    # Loop over events present in both files
+    deviations = OrderedDict()
+    numEvents, numSkipped = 0, 0
+    
+    for eventID, refEvent in eventsRef.items():
+        if eventID not in eventsTest:
+            continue
+        
+        testEvent = eventsTest[eventID]
+        numEvents += 1
+        
+        for group, refContent in refEvent.items():
+            if group == 'eventID' or group not in testEvent:
+                continue
+            
+            testContent = testEvent[group]
+            
+            if isinstance(refContent, list) and isinstance(testContent, list):
+                if len(refContent) != len(testContent):
+                    numSkipped += 1
+                    continue
+                
+                for refObject, testObject in zip(refContent, testContent):
+                    compare_objects(refObject, testObject, deviations, group)
+            
+            elif isinstance(refContent, dict) and isinstance(testContent, dict):
+                compare_objects(refContent, testContent, deviations, group)
+    
+    
+    # Print the report
+    print('Events compared: {}'.format(numEvents))
+    
+    if numSkipped > 0:
+        print('Collections skipped because of different lengths: {}'.format(numSkipped))
+    
+    print()
+    print('{:30s} {:>10s} {:>12s} {:>12s}   {}'.format(
+        'Property', 'Values', 'Max abs', 'Max rel', 'Worst (ref, test)'
+    ))
+    
+    for name, deviation in deviations.items():
+        worst = '({:.7g}, {:.7g})'.format(*deviation.worstValues) \
+            if deviation.worstValues else ''
+        print('{:30s} {:>10d} {:>12.3e} {:>12.3e}   {}'.format(
+            name, deviation.count, deviation.maxAbs, deviation.maxRel, worst
+        ))
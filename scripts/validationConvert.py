@@ -2,7 +2,10 @@
 
 """Converts PEC files into JSON format for release validation.
 
-Only a subset of properties are considered.
+Only a subset of properties are considered.  It includes all
+floating-point data members stored with reduced precision, so that the
+output can also be used with precisionCompare.py.  Generator-level
+information is only exported if it is present in the input file.
 """
 
 from __future__ import print_function
@@ -44,15 +47,42 @@ if __name__ == '__main__':
     events = []
     
     inputFile = ROOT.TFile(args.inputFile)
-    tree = inputFile.Get('pecEventID/EventID')
-    tree.AddFriend('pecMuons/Muons')
-    tree.AddFriend('pecElectrons/Electrons')
-    tree.AddFriend('pecJetMET/JetMET')
+    tree = inputFile.Get('pecOutput/Events')
+    
+    if tree:
+        # All PEC plugins have been written into a single tree.  Names
+        # of branches are prefixed with names of the original trees.
+        branchNames = {
+            'eventId': 'EventID_eventId', 'muons': 'Muons_muons',
+            'electrons': 'Electrons_electrons', 'jets': 'JetMET_jets',
+            'METs': 'JetMET_METs', 'uncorrMETs': 'JetMET_uncorrMETs',
+            'puInfo': 'PileUp_puInfo', 'generator': 'Generator_generator'
+        }
+        
+        if not tree.GetBranch(branchNames['generator']):
+            del branchNames['generator']
+    else:
+        tree = inputFile.Get('pecEventID/EventID')
+        tree.AddFriend('pecMuons/Muons')
+        tree.AddFriend('pecElectrons/Electrons')
+        tree.AddFriend('pecJetMET/JetMET')
+        tree.AddFriend('pecPileUp/PileUp')
+        
+        branchNames = {
+            name: name for name in [
+                'eventId', 'muons', 'electrons', 'jets', 'METs', 'uncorrMETs', 'puInfo'
+            ]
+        }
+        
+        if inputFile.Get('pecGenerator/Generator'):
+            tree.AddFriend('pecGenerator/Generator')
+            branchNames['generator'] = 'generator'
     
     for entry in tree:
         event = OrderedDict()
+        read = lambda name: getattr(entry, branchNames[name])
         
-        eventID = entry.eventId
+        eventID = read('eventId')
         event['eventID'] = '{}:{}:{}'.format(
             eventID.RunNumber(), eventID.LumiSectionNumber(), eventID.EventNumber()
         )
@@ -60,7 +90,7 @@ if __name__ == '__main__':
         
         muons = []
         
-        for src in entry.muons:
+        for src in read('muons'):
             conv = OrderedDict()
             conv['pt'] = src.Pt()
             conv['eta'] = src.Eta()
@@ -75,13 +105,14 @@ if __name__ == '__main__':
         
         electrons = []
         
-        for src in entry.electrons:
+        for src in read('electrons'):
             conv = OrderedDict()
             conv['pt'] = src.Pt()
             conv['eta'] = src.Eta()
             conv['etaSC'] = src.EtaSC()
             conv['phi'] = src.Phi()
             conv['relIso'] = src.RelIso()
+            conv['mvaId'] = src.ContinuousID(0)
             conv['passVeto'] = src.BooleanID(0)
             conv['passTight'] = src.BooleanID(3)
             
@@ -92,17 +123,30 @@ if __name__ == '__main__':
         
         jets = []
         
-        for src in entry.jets:
+        for src in read('jets'):
             conv = OrderedDict()
             conv['rawPt'] = src.Pt()
             conv['corrPt'] = src.Pt() * src.CorrFactor()
             conv['eta'] = src.Eta()
             conv['phi'] = src.Phi()
+            conv['mass'] = src.M()
             conv['uncJEC'] = src.JECUncertainty()
             conv['uncJER'] = src.JERUncertainty()
             conv['passPFLoose'] = src.TestBit(1)
             conv['hasGenMatch'] = src.TestBit(0)
             conv['CSV'] = src.BTag(0)
+            conv['CMVA'] = src.BTag(1)
+            conv['CvsB'] = src.CTag(0)
+            conv['CvsL'] = src.CTag(1)
+            conv['bTagDNN_bb'] = src.BTagDNN(0)
+            conv['bTagDNN_b'] = src.BTagDNN(1)
+            conv['bTagDNN_cc'] = src.BTagDNN(2)
+            conv['bTagDNN_c'] = src.BTagDNN(3)
+            conv['pileUpID'] = src.PileUpID()
+            conv['qgTag'] = src.QGTag()
+            conv['area'] = src.Area()
+            conv['charge'] = src.Charge()
+            conv['pullAngle'] = src.PullAngle()
             
             jets.append(conv)
         
@@ -112,14 +156,32 @@ if __name__ == '__main__':
         mets = []
         
         conv = OrderedDict()
-        conv['rawPt'] = entry.uncorrMETs[0].Pt()
-        conv['rawPhi'] = entry.uncorrMETs[0].Phi()
-        conv['corrPt'] = entry.METs[0].Pt()
-        conv['corrPhi'] = entry.METs[0].Phi()
+        conv['rawPt'] = read('uncorrMETs')[0].Pt()
+        conv['rawPhi'] = read('uncorrMETs')[0].Phi()
+        conv['corrPt'] = read('METs')[0].Pt()
+        conv['corrPhi'] = read('METs')[0].Phi()
         
         mets.append(conv)
         event['mets'] = mets
         
+        
+        puInfo = read('puInfo')
+        conv = OrderedDict()
+        conv['rho'] = puInfo.Rho()
+        conv['rhoCentral'] = puInfo.RhoCentral()
+        conv['trueNumPU'] = puInfo.TrueNumPU()
+        conv['maxPtHat'] = puInfo.MaxPtHat()
+        event['puInfo'] = conv
+        
+        
+        if 'generator' in branchNames:
+            generator = read('generator')
+            conv = OrderedDict()
+            conv['pdfX1'] = generator.PdfX(0)
+            conv['pdfX2'] = generator.PdfX(1)
+            conv['pdfQScale'] = generator.PdfQScale()
+            event['generator'] = conv
+        
         events.append(event)
     
     inputFile.Close()
@@ -1,5 +1,11 @@
 #include <Analysis/PECTuples/interface/Candidate.h>
 
+#include <type_traits>
+
+
+static_assert(std::is_trivially_copyable<pec::Candidate>::value,
+  "pec::Candidate must be trivially copyable.");
+
 
 pec::Candidate::Candidate() noexcept:
     pt(0), eta(0), phi(0), mass(0)
@@ -1,6 +1,11 @@
 #include <Analysis/PECTuples/interface/CandidateWithID.h>
 
 #include <stdexcept>
+#include <type_traits>
+
+
+static_assert(std::is_trivially_copyable<pec::CandidateWithID>::value,
+  "pec::CandidateWithID must be trivially copyable.");
 
 
 pec::CandidateWithID::CandidateWithID() noexcept:
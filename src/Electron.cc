@@ -6,6 +6,10 @@
 #include <type_traits>
 
 
+static_assert(std::is_trivially_copyable<pec::Electron>::value,
+  "pec::Electron must be trivially copyable.");
+
+
 unsigned const pec::Electron::contIdSize;
 
 
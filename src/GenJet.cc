@@ -1,5 +1,11 @@
 #include <Analysis/PECTuples/interface/GenJet.h>
 
+#include <type_traits>
+
+
+static_assert(std::is_trivially_copyable<pec::GenJet>::value,
+  "pec::GenJet must be trivially copyable.");
+
 
 pec::GenJet::GenJet() noexcept:
     Candidate(),
@@ -1,6 +1,11 @@
 #include <Analysis/PECTuples/interface/GenParticle.h>
 
 #include <stdexcept>
+#include <type_traits>
+
+
+static_assert(std::is_trivially_copyable<pec::GenParticle>::value,
+  "pec::GenParticle must be trivially copyable.");
 
 
 pec::GenParticle::GenParticle() noexcept:
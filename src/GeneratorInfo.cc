@@ -49,6 +49,18 @@ void pec::GeneratorInfo::AddAltPsWeight(float weight)
 }
 
 
+std::vector<Float_t> &pec::GeneratorInfo::MutableAltLheWeights()
+{
+    return altLheWeights;
+}
+
+
+std::vector<Float_t> &pec::GeneratorInfo::MutableAltPsWeights()
+{
+    return altPsWeights;
+}
+
+
 void pec::GeneratorInfo::SetPdfX(unsigned index, float x)
 {
     // Check the index
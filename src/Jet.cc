@@ -4,6 +4,10 @@
 #include <cstdlib>
 #include <sstream>
 #include <stdexcept>
+#include <type_traits>
+
+
+static_assert(std::is_trivially_copyable<pec::Jet>::value, "pec::Jet must be trivially copyable.");
 
 
 pec::Jet::Jet() noexcept:
@@ -0,0 +1,104 @@
+#include <Analysis/PECTuples/interface/JetColumns.h>
+
+
+unsigned pec::CandidateColumns::size() const
+{
+    return pt.size();
+}
+
+
+float const *pec::CandidateColumns::Pt() const
+{
+    return pt.data();
+}
+
+
+float const *pec::CandidateColumns::Eta() const
+{
+    return eta.data();
+}
+
+
+float const *pec::CandidateColumns::Phi() const
+{
+    return phi.data();
+}
+
+
+float const *pec::CandidateColumns::M() const
+{
+    return mass.data();
+}
+
+
+void pec::CandidateColumns::Resize(unsigned size)
+{
+    // Capacity of the vectors is kept, so reallocations stop after the first few events
+    pt.resize(size);
+    eta.resize(size);
+    phi.resize(size);
+    mass.resize(size);
+}
+
+
+void pec::JetColumns::Fill(std::vector<Jet> const &jets)
+{
+    CandidateColumns::Fill(jets);
+    Resize(jets.size());
+    
+    for (unsigned i = 0; i < jets.size(); ++i)
+    {
+        Jet const &j = jets[i];
+        corrFactor[i] = j.CorrFactor();
+        jecUncertainty[i] = j.JECUncertainty();
+        jerUncertainty[i] = j.JERUncertainty();
+        
+        for (unsigned k = 0; k < 4; ++k)
+            bTagsDNN[i][k] = j.BTagDNN(Jet::BTagDNNType(k));
+        
+        for (unsigned k = 0; k < 3; ++k)
+            flavours[k][i] = j.Flavour(Jet::FlavourType(k));
+    }
+}
+
+
+float const *pec::JetColumns::CorrFactor() const
+{
+    return corrFactor.data();
+}
+
+
+float const *pec::JetColumns::JECUncertainty() const
+{
+    return jecUncertainty.data();
+}
+
+
+float const *pec::JetColumns::JERUncertainty() const
+{
+    return jerUncertainty.data();
+}
+
+
+std::array<float, 4> const *pec::JetColumns::BTagsDNN() const
+{
+    return bTagsDNN.data();
+}
+
+
+int const *pec::JetColumns::Flavour(Jet::FlavourType type /*= Jet::FlavourType::Hadron*/) const
+{
+    return flavours[unsigned(type)].data();
+}
+
+
+void pec::JetColumns::Resize(unsigned size)
+{
+    corrFactor.resize(size);
+    jecUncertainty.resize(size);
+    jerUncertainty.resize(size);
+    bTagsDNN.resize(size);
+    
+    for (auto &v: flavours)
+        v.resize(size);
+}
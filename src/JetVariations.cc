@@ -0,0 +1,118 @@
+#include <Analysis/PECTuples/interface/JetVariations.h>
+
+#include <cmath>
+
+
+unsigned const pec::JetVariations::numVariations;
+
+
+void pec::JetVariations::Compute(JetColumns const &jets)
+{
+    Compute(jets.size(), jets.Pt(), jets.M(), jets.CorrFactor(), jets.JECUncertainty(),
+      jets.JERUncertainty());
+}
+
+
+void pec::JetVariations::Compute(unsigned size, float const *rawPt, float const *rawMass,
+  float const *corrFactor, float const *jecUncertainty, float const *jerUncertainty)
+{
+    for (unsigned v = 0; v < numVariations; ++v)
+    {
+        pt[v].resize(size);
+        mass[v].resize(size);
+    }
+    
+    
+    // Plain pointers to the outputs let the compiler vectorize the loop below
+    float *ptNominal = pt[unsigned(Variation::Nominal)].data();
+    float *ptJECUp = pt[unsigned(Variation::JECUp)].data();
+    float *ptJECDown = pt[unsigned(Variation::JECDown)].data();
+    float *ptJERUp = pt[unsigned(Variation::JERUp)].data();
+    float *ptJERDown = pt[unsigned(Variation::JERDown)].data();
+    
+    float *massNominal = mass[unsigned(Variation::Nominal)].data();
+    float *massJECUp = mass[unsigned(Variation::JECUp)].data();
+    float *massJECDown = mass[unsigned(Variation::JECDown)].data();
+    float *massJERUp = mass[unsigned(Variation::JERUp)].data();
+    float *massJERDown = mass[unsigned(Variation::JERDown)].data();
+    
+    for (unsigned i = 0; i < size; ++i)
+    {
+        float const nominalPt = rawPt[i] * corrFactor[i];
+        float const nominalMass = rawMass[i] * corrFactor[i];
+        
+        // The JER uncertainty is used with its sign, see documentation for the class
+        float const jecUp = 1.f + jecUncertainty[i], jecDown = 1.f - jecUncertainty[i];
+        float const jerUp = 1.f + jerUncertainty[i], jerDown = 1.f - jerUncertainty[i];
+        
+        ptNominal[i] = nominalPt;
+        ptJECUp[i] = nominalPt * jecUp;
+        ptJECDown[i] = nominalPt * jecDown;
+        ptJERUp[i] = nominalPt * jerUp;
+        ptJERDown[i] = nominalPt * jerDown;
+        
+        massNominal[i] = nominalMass;
+        massJECUp[i] = nominalMass * jecUp;
+        massJECDown[i] = nominalMass * jecDown;
+        massJERUp[i] = nominalMass * jerUp;
+        massJERDown[i] = nominalMass * jerDown;
+    }
+}
+
+
+unsigned pec::JetVariations::size() const
+{
+    return pt[0].size();
+}
+
+
+float const *pec::JetVariations::Pt(Variation variation /*= Variation::Nominal*/) const
+{
+    return pt[unsigned(variation)].data();
+}
+
+
+float const *pec::JetVariations::M(Variation variation /*= Variation::Nominal*/) const
+{
+    return mass[unsigned(variation)].data();
+}
+
+
+std::array<pec::Candidate, pec::JetVariations::numVariations>
+pec::JetVariations::PropagateToMET(Candidate const &nominalMET, float const *phi,
+  float minPt /*= 15.f*/) const
+{
+    float const *ptNominal = pt[unsigned(Variation::Nominal)].data();
+    unsigned const numJets = size();
+    
+    // Components of MET for all variations, the nominal one included for simplicity of indexing
+    std::array<double, numVariations> metX, metY;
+    metX.fill(nominalMET.Pt() * std::cos(nominalMET.Phi()));
+    metY.fill(nominalMET.Pt() * std::sin(nominalMET.Phi()));
+    
+    for (unsigned i = 0; i < numJets; ++i)
+    {
+        if (ptNominal[i] <= minPt)
+            continue;
+        
+        double const cosPhi = std::cos(phi[i]), sinPhi = std::sin(phi[i]);
+        
+        for (unsigned v = 1; v < numVariations; ++v)
+        {
+            double const deltaPt = pt[v][i] - ptNominal[i];
+            metX[v] -= deltaPt * cosPhi;
+            metY[v] -= deltaPt * sinPhi;
+        }
+    }
+    
+    std::array<Candidate, numVariations> mets;
+    mets[unsigned(Variation::Nominal)] = nominalMET;
+    
+    for (unsigned v = 1; v < numVariations; ++v)
+    {
+        mets[v].SetPt(std::hypot(metX[v], metY[v]));
+        mets[v].SetPhi(std::atan2(metY[v], metX[v]));
+    }
+    
+    return mets;
+}
@@ -1,6 +1,11 @@
 #include <Analysis/PECTuples/interface/Lepton.h>
 
 #include <stdexcept>
+#include <type_traits>
+
+
+static_assert(std::is_trivially_copyable<pec::Lepton>::value,
+  "pec::Lepton must be trivially copyable.");
 
 
 pec::Lepton::Lepton() noexcept:
@@ -1,5 +1,11 @@
 #include <Analysis/PECTuples/interface/Muon.h>
 
+#include <type_traits>
+
+
+static_assert(std::is_trivially_copyable<pec::Muon>::value,
+  "pec::Muon must be trivially copyable.");
+
 
 pec::Muon::Muon() noexcept:
     Lepton()
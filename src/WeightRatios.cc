@@ -0,0 +1,67 @@
+#include <Analysis/PECTuples/interface/WeightRatios.h>
+
+#include <cmath>
+#include <stdexcept>
+
+
+unsigned const pec::WeightRatios::maxCode;
+
+
+pec::WeightRatios::WeightRatios(float minRatio_, float maxRatio_):
+    minRatio(minRatio_), maxRatio(maxRatio_),
+    step((maxRatio_ - minRatio_) / maxCode)
+{
+    if (not (maxRatio > minRatio))
+        throw std::logic_error("WeightRatios::WeightRatios: Range of ratios is empty.");
+}
+
+
+float pec::WeightRatios::ComputeRatio(float weight, float nominalWeight)
+{
+    return (nominalWeight != 0.f) ? weight / nominalWeight : 0.f;
+}
+
+
+void pec::WeightRatios::Decode(float nominalWeight, unsigned size, Float_t const *ratios,
+  float *weights)
+{
+    for (unsigned i = 0; i < size; ++i)
+        weights[i] = nominalWeight * ratios[i];
+}
+
+
+UShort_t pec::WeightRatios::Encode(float ratio) const
+{
+    if (not (ratio > minRatio))
+        return 0;
+    else if (ratio >= maxRatio)
+        return maxCode;
+    else
+        return UShort_t(std::lround((ratio - minRatio) / step));
+}
+
+
+float pec::WeightRatios::DecodeRatio(UShort_t code) const
+{
+    return minRatio + code * step;
+}
+
+
+void pec::WeightRatios::Decode(float nominalWeight, unsigned size, UShort_t const *codes,
+  float *weights) const
+{
+    for (unsigned i = 0; i < size; ++i)
+        weights[i] = nominalWeight * (minRatio + codes[i] * step);
+}
+
+
+float pec::WeightRatios::MinRatio() const
+{
+    return minRatio;
+}
+
+
+float pec::WeightRatios::MaxRatio() const
+{
+    return maxRatio;
+}
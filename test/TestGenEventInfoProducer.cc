@@ -0,0 +1,45 @@
+#include "TestGenEventInfoProducer.h"
+
+#include <FWCore/Framework/interface/MakerMacros.h>
+#include <FWCore/ParameterSet/interface/ParameterSetDescription.h>
+#include <FWCore/Utilities/interface/Exception.h>
+
+#include <SimDataFormats/GeneratorProducts/interface/GenEventInfoProduct.h>
+
+#include <memory>
+
+
+TestGenEventInfoProducer::TestGenEventInfoProducer(edm::ParameterSet const &cfg):
+    numProcesses(cfg.getParameter<unsigned>("numProcesses"))
+{
+    if (numProcesses == 0)
+    {
+        cms::Exception excp("Configuration");
+        excp << "Parameter \"numProcesses\" must be positive.";
+        excp.raise();
+    }
+    
+    produces<GenEventInfoProduct>();
+}
+
+
+void TestGenEventInfoProducer::fillDescriptions(edm::ConfigurationDescriptions &descriptions)
+{
+    edm::ParameterSetDescription desc;
+    desc.add<unsigned>("numProcesses")->
+      setComment("Number of distinct process IDs. The ID is the event number modulo this value.");
+    
+    descriptions.add("testGenEventInfoProducer", desc);
+}
+
+
+void TestGenEventInfoProducer::produce(edm::StreamID, edm::Event &event,
+  edm::EventSetup const &) const
+{
+    std::unique_ptr<GenEventInfoProduct> generator(new GenEventInfoProduct(1.));
+    generator->setSignalProcessID(event.id().event() % numProcesses);
+    event.put(std::move(generator));
+}
+
+
+DEFINE_FWK_MODULE(TestGenEventInfoProducer);
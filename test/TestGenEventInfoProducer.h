@@ -0,0 +1,34 @@
+#pragma once
+
+#include <FWCore/Framework/interface/global/EDProducer.h>
+#include <FWCore/Framework/interface/Event.h>
+#include <FWCore/ParameterSet/interface/ConfigurationDescriptions.h>
+#include <FWCore/ParameterSet/interface/ParameterSet.h>
+
+
+/**
+ * \class TestGenEventInfoProducer
+ * \brief Puts a GenEventInfoProduct with a made-up process ID into each event
+ * 
+ * Used in tests of ProcessIDFilter with events generated by EmptySource. The process ID is the
+ * event number modulo the value of parameter "numProcesses", so the number of events with a given
+ * ID is known in advance. The weight of each event is set to one.
+ */
+class TestGenEventInfoProducer: public edm::global::EDProducer<>
+{
+public:
+    /// Constructor
+    TestGenEventInfoProducer(edm::ParameterSet const &cfg);
+    
+public:
+    /// Verifies configuration of the plugin
+    static void fillDescriptions(edm::ConfigurationDescriptions &descriptions);
+    
+    /// Puts a new GenEventInfoProduct into the event
+    virtual void produce(edm::StreamID, edm::Event &event, edm::EventSetup const &) const
+      override;
+    
+private:
+    /// Number of distinct process IDs
+    unsigned numProcesses;
+};
@@ -0,0 +1,64 @@
+#!/bin/bash
+
+# Runs global filters in one and in several threads, checks numbers of accepted events, and reports
+#the throughput in both cases. Directory with the test files is given by LOCAL_TEST_DIR, which is
+#set by scram.
+
+testDir="${LOCAL_TEST_DIR:-$(dirname "$0")}"
+numEvents=100000
+numListed=1000
+numThreads=4
+numProcesses=7
+
+
+# Lines of the path summary read
+#"TrigReport <bit> <bit#> <executed> <passed> <failed> <error> <name>"
+check_path () {
+    local passed=$(awk -v path="$2" \
+      '$1 == "TrigReport" && NF == 8 && $8 == path {print $5; exit}' $1)
+
+    if [ "$passed" != "$3" ]; then
+        echo "Path $2 accepted ${passed:-no} events while $3 expected in $1" >&2
+        return 1
+    fi
+}
+
+
+# Events are numbered from 1, and those whose numbers are multiples of numProcesses get process ID 0
+numKeptProcess=$((numEvents / numProcesses))
+
+
+# Run the job with one and with several threads and check the results of both. The throughput is
+#recorded in a separate file. The wall time includes the start-up of cmsRun, which is the same for
+#both jobs
+throughputFile=threadedFilters_throughput.txt
+> $throughputFile
+status=0
+
+for threads in 1 $numThreads; do
+    log=threadedFilters_${threads}.log
+    start=$(date +%s.%N)
+    cmsRun "$testDir/threadedFilters_cfg.py" maxEvents=$numEvents numThreads=$threads > $log 2>&1
+
+    if [ $? -ne 0 ]; then
+        cat $log
+        echo "cmsRun with $threads threads failed" >&2
+        exit 1
+    fi
+
+    end=$(date +%s.%N)
+    awk -v n=$numEvents -v t=$threads -v start=$start -v end=$end \
+      'BEGIN {printf "%d threads: %.1f s, %.0f events/s\n", t, end - start, n / (end - start)}' |
+      tee -a $throughputFile
+
+    check_path $log pKeep $numListed || status=1
+    check_path $log pReject $((numEvents - numListed)) || status=1
+    check_path $log pKeepProcess $numKeptProcess || status=1
+    check_path $log pRejectProcess $((numEvents - numKeptProcess)) || status=1
+done
+
+if [ $status -eq 0 ]; then
+    echo "Numbers of accepted events are correct"
+fi
+
+exit $status
@@ -0,0 +1,90 @@
+"""Configuration for cmsRun to test global filters with several threads.
+
+Generates events with EmptySource and runs EventIDFilter and
+ProcessIDFilter on them in several concurrent streams.  The list of
+events for EventIDFilter contains every seventh event among the first
+7000 ones, i.e. 1000 events.  Path pKeep should accept exactly these
+events and path pReject all other ones.
+
+Module TestGenEventInfoProducer puts into each event a
+GenEventInfoProduct whose process ID is the event number modulo 7.
+Path pKeepProcess selects process ID 0 and path pRejectProcess all other
+IDs.  Numbers of accepted events are checked by script
+runThreadedFilters.sh, which parses the trigger report printed at the
+end of the job.
+"""
+
+
+# Create a process
+import FWCore.ParameterSet.Config as cms
+process = cms.Process('ThreadedFilters')
+
+
+# Enable MessageLogger and reduce its verbosity
+process.load('FWCore.MessageLogger.MessageLogger_cfi')
+process.MessageLogger.cerr.FwkReport.reportEvery = 10000
+
+
+# Parse command-line options
+from FWCore.ParameterSet.VarParsing import VarParsing
+options = VarParsing('python')
+
+options.register(
+    'numThreads', 4, VarParsing.multiplicity.singleton, VarParsing.varType.int,
+    'Number of threads and streams'
+)
+
+options.setDefault('maxEvents', 100000)
+options.parseArguments()
+
+process.options = cms.untracked.PSet(
+    numberOfThreads = cms.untracked.uint32(options.numThreads),
+    numberOfStreams = cms.untracked.uint32(options.numThreads),
+    wantSummary = cms.untracked.bool(True)
+)
+
+
+# Generate events.  Event numbers are not reset at a new luminosity
+# block, and the list of events follows this numbering.
+process.source = cms.Source('EmptySource',
+    firstRun = cms.untracked.uint32(1),
+    numberEventsInLuminosityBlock = cms.untracked.uint32(100)
+)
+
+process.maxEvents = cms.untracked.PSet(input = cms.untracked.int32(options.maxEvents))
+
+
+# Filters under test
+eventListFile = cms.FileInPath('Analysis/PECTuples/test/threadedFilterEvents.txt')
+
+process.keepListedEvents = cms.EDFilter('EventIDFilter',
+    eventListFile = eventListFile,
+    rejectKnownEvents = cms.bool(False)
+)
+
+process.rejectListedEvents = cms.EDFilter('EventIDFilter',
+    eventListFile = eventListFile,
+    rejectKnownEvents = cms.bool(True)
+)
+
+process.pKeep = cms.Path(process.keepListedEvents)
+process.pReject = cms.Path(process.rejectListedEvents)
+
+
+# Process IDs are read from a made-up GenEventInfoProduct
+process.generator = cms.EDProducer('TestGenEventInfoProducer',
+    numProcesses = cms.uint32(7)
+)
+
+process.keepProcess = cms.EDFilter('ProcessIDFilter',
+    generator = cms.InputTag('generator'),
+    processIDs = cms.vint32(0)
+)
+
+process.rejectProcess = cms.EDFilter('ProcessIDFilter',
+    generator = cms.InputTag('generator'),
+    processIDs = cms.vint32(1, 2, 3, 4, 5, 6)
+)
+
+process.pKeepProcess = cms.Path(process.generator + process.keepProcess)
+process.pRejectProcess = cms.Path(process.generator + process.rejectProcess)